@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* accept4 */
+#endif
+
+/*
+ * CPU cost per request: POLL (curl_multi_perform) vs EPOLL (socket_action).
+ *
+ * A forked local server accepts every connection and answers each request
+ * after a fixed delay, so all N transfers are in flight at the same time.
+ * We then measure user+sys CPU of the client process only.
+ *
+ *   ./bench_event_loop_backend [delay_ms] [concurrency ...]
+ *   default: 200 ms, 1000 10000
+ */
+
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------------ */
+/* Delayed-response server                                             */
+
+static const char RESPONSE[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 2\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "ok";
+
+typedef struct conn_s {
+    int    fd;
+    size_t hdr_match;      /* progress through "\r\n\r\n" */
+    uint64_t due;          /* 0 = nothing to send */
+    struct conn_s *next_due;
+} conn_t;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static void server_main(int lfd, int delay_ms) {
+    int ep = epoll_create1(0);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+
+    /* Responses are due in arrival order, so a FIFO is enough */
+    conn_t *due_head = NULL, *due_tail = NULL;
+    struct epoll_event events[512];
+
+    for (;;) {
+        int timeout = -1;
+        if (due_head) {
+            uint64_t t = now_ms();
+            timeout = due_head->due > t ? (int)(due_head->due - t) : 0;
+        }
+        int n = epoll_wait(ep, events, 512, timeout);
+        for (int i = 0; i < n; i++) {
+            conn_t *c = (conn_t *)events[i].data.ptr;
+            if (!c) {
+                int fd;
+                while ((fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+                    int one = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    c = (conn_t *)calloc(1, sizeof(*c));
+                    c->fd = fd;
+                    struct epoll_event cev = { .events = EPOLLIN, .data.ptr = c };
+                    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &cev);
+                }
+                continue;
+            }
+            char buf[4096];
+            ssize_t r = read(c->fd, buf, sizeof(buf));
+            if (r <= 0) {
+                if (r < 0 && errno == EAGAIN) continue;
+                epoll_ctl(ep, EPOLL_CTL_DEL, c->fd, NULL);
+                close(c->fd);
+                c->fd = -1;        /* freed lazily if still on the due list */
+                if (!c->due) free(c);
+                continue;
+            }
+            for (ssize_t k = 0; k < r; k++) {
+                static const char END[] = "\r\n\r\n";
+                c->hdr_match = (buf[k] == END[c->hdr_match]) ? c->hdr_match + 1
+                             : (buf[k] == '\r' ? 1 : 0);
+                if (c->hdr_match == 4 && !c->due) {
+                    c->hdr_match = 0;
+                    c->due = now_ms() + (uint64_t)delay_ms;
+                    c->next_due = NULL;
+                    if (due_tail) due_tail->next_due = c; else due_head = c;
+                    due_tail = c;
+                }
+            }
+        }
+        uint64_t t = now_ms();
+        while (due_head && due_head->due <= t) {
+            conn_t *c = due_head;
+            due_head = c->next_due;
+            if (!due_head) due_tail = NULL;
+            c->due = 0;
+            if (c->fd < 0) { free(c); continue; }
+            ssize_t w = write(c->fd, RESPONSE, sizeof(RESPONSE) - 1);
+            (void)w;
+        }
+    }
+}
+
+static pid_t start_server(int *port_out, int delay_ms) {
+    int lfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(lfd, 65535) != 0) {
+        perror("bind/listen");
+        exit(1);
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(lfd, (struct sockaddr *)&addr, &len);
+    *port_out = ntohs(addr.sin_port);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        server_main(lfd, delay_ms);
+        _exit(0);
+    }
+    close(lfd);
+    return pid;
+}
+
+/* ------------------------------------------------------------------ */
+/* Client                                                              */
+
+static int completed, failed;
+
+static size_t on_write(void *ptr, size_t size, size_t nmemb, curl_event_request_t *req) {
+    (void)ptr; (void)req;
+    return size * nmemb;
+}
+
+static int on_complete(CURL *easy, curl_event_request_t *req) {
+    (void)easy; (void)req;
+    completed++;
+    return 0;
+}
+
+static int on_failure(CURL *easy, CURLcode res, long http, curl_event_request_t *req) {
+    (void)easy; (void)res; (void)http; (void)req;
+    failed++;
+    return 0;
+}
+
+static double cpu_seconds(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+         + (double)ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void run_one(const char *url, curl_event_backend_t backend, int concurrency) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    if (!curl_event_loop_set_backend(loop, backend)) {
+        printf("%-6s %7d  (backend unavailable)\n",
+               backend == CURL_EVENT_BACKEND_EPOLL ? "epoll" : "poll", concurrency);
+        curl_event_loop_destroy(loop);
+        return;
+    }
+    curl_event_loop_set_max_concurrent(loop, (size_t)concurrency);
+
+    completed = failed = 0;
+    for (int i = 0; i < concurrency; i++) {
+        curl_event_request_t *r = curl_event_request_build_get(url, on_write, on_complete);
+        curl_event_request_on_failure(r, on_failure);
+        curl_event_request_connect_timeout(r, 30);
+        curl_event_request_transfer_timeout(r, 60);
+        curl_event_request_http3(r, false);
+        curl_event_request_submit(loop, r, 0);
+    }
+
+    double cpu0 = cpu_seconds(), wall0 = wall_seconds();
+    curl_event_loop_run(loop);
+    double cpu = cpu_seconds() - cpu0, wall = wall_seconds() - wall0;
+
+    printf("%-6s %7d %9d %7d %9.3f %9.3f %12.2f\n",
+           backend == CURL_EVENT_BACKEND_EPOLL ? "epoll" : "poll",
+           concurrency, completed, failed, wall, cpu,
+           completed ? cpu * 1e6 / completed : 0.0);
+    fflush(stdout);
+    curl_event_loop_destroy(loop);
+}
+
+int main(int argc, char **argv) {
+    int delay_ms = argc > 1 ? atoi(argv[1]) : 200;
+    int levels[16] = { 1000, 10000 };
+    int nlevels = 2;
+    if (argc > 2) {
+        nlevels = 0;
+        for (int i = 2; i < argc && nlevels < 16; i++) levels[nlevels++] = atoi(argv[i]);
+    }
+
+    /* Each transfer holds a client and a server socket */
+    struct rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+
+    signal(SIGPIPE, SIG_IGN);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    int port = 0;
+    pid_t server = start_server(&port, delay_ms);
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", port);
+
+    printf("server delay %d ms, fd limit %llu\n", delay_ms, (unsigned long long)rl.rlim_cur);
+    printf("%-6s %7s %9s %7s %9s %9s %12s\n",
+           "mode", "conc", "completed", "failed", "wall_s", "cpu_s", "cpu_us/req");
+    for (int i = 0; i < nlevels; i++) {
+        run_one(url, CURL_EVENT_BACKEND_POLL, levels[i]);
+        run_one(url, CURL_EVENT_BACKEND_EPOLL, levels[i]);
+    }
+
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    curl_global_cleanup();
+    return 0;
+}
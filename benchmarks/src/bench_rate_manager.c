@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Rate manager contention: T threads, each standing in for an event loop,
+ * run acquire + request_done pairs against 1000 configured keys.
+ *
+ *   shared  every thread uses the same key
+ *   own     each thread uses its own key
+ *
+ * each by name (rate_manager_acquire / _request_done, one lookup per call)
+ * and by interned handle (rate_key_acquire / _request_done).  Reports ns
+ * per pair and total pairs per second.
+ *
+ *   ./bench_rate_manager [threads ...]
+ *   default: 1 2 4 8
+ */
+
+#include "a-curl-library/rate_manager.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_KEYS   1000
+#define OPS        1000000
+
+typedef struct {
+    char name[32];
+    rate_key_t *key;
+    bool by_name;
+    double secs;
+} worker_t;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *work(void *arg) {
+    worker_t *w = (worker_t *)arg;
+    double t0 = now_s();
+    if (w->by_name) {
+        for (int i = 0; i < OPS; i++) {
+            rate_manager_acquire(w->name, false, NULL);
+            rate_manager_request_done(w->name);
+        }
+    } else {
+        for (int i = 0; i < OPS; i++) {
+            rate_key_acquire(w->key, false, NULL);
+            rate_key_request_done(w->key);
+        }
+    }
+    w->secs = now_s() - t0;
+    return NULL;
+}
+
+static void run(const char *mode, int threads, bool shared, bool by_name) {
+    worker_t *w = (worker_t *)calloc((size_t)threads, sizeof(worker_t));
+    pthread_t *t = (pthread_t *)calloc((size_t)threads, sizeof(pthread_t));
+    for (int i = 0; i < threads; i++) {
+        snprintf(w[i].name, sizeof(w[i].name), "key-%d", shared ? 0 : i * 7 % NUM_KEYS);
+        w[i].key = rate_manager_key(w[i].name);
+        w[i].by_name = by_name;
+    }
+    double t0 = now_s();
+    for (int i = 0; i < threads; i++)
+        pthread_create(&t[i], NULL, work, &w[i]);
+    double per = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(t[i], NULL);
+        per += w[i].secs;
+    }
+    double wall = now_s() - t0;
+    printf("%-7s %-6s %7d %11.1f %11.2f\n", shared ? "shared" : "own", mode, threads,
+           per * 1e9 / ((double)threads * OPS),
+           (double)threads * OPS / wall / 1e6);
+    free(t);
+    free(w);
+}
+
+int main(int argc, char **argv) {
+    int levels[16] = { 1, 2, 4, 8 };
+    int nlevels = 4;
+    if (argc > 1) {
+        nlevels = 0;
+        for (int i = 1; i < argc && nlevels < 16; i++)
+            levels[nlevels++] = atoi(argv[i]);
+    }
+
+    /* no concurrency or rps cap, so every acquire succeeds */
+    rate_manager_init();
+    for (int i = 0; i < NUM_KEYS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "key-%d", i);
+        rate_manager_set_limit(name, 0, 0);
+    }
+
+    printf("%-7s %-6s %7s %11s %11s\n", "keys", "lookup", "threads", "ns_per_op", "Mops_total");
+    for (int l = 0; l < nlevels; l++) {
+        for (int shared = 1; shared >= 0; shared--) {
+            run("name", levels[l], shared, true);
+            run("handle", levels[l], shared, false);
+        }
+        fflush(stdout);
+    }
+    rate_manager_destroy();
+    return 0;
+}
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Cross-thread submit latency.
+ *
+ * One loop runs on its own thread (a single-shard runtime); P producer
+ * threads submit N requests each as fast as they can.  For every request
+ * we record the time from curl_event_request_submit() to the loop picking
+ * it up (on_prepare, which then declines the transfer so only scheduling
+ * is measured), plus the cost of the submit call itself.  With a batch
+ * size > 1 producers use curl_event_loop_submit_batch instead.
+ *
+ *   ./bench_submit_latency [producers] [requests_per_producer] [batch]
+ *   default: 16 20000 1
+ */
+
+#include "a-curl-library/curl_event_runtime.h"
+#include "a-curl-library/curl_event_request.h"
+#include "the-macro-library/macro_time.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static curl_event_runtime_t *rt;
+static int per_producer = 20000;
+static int batch = 1;
+
+static uint64_t *latencies;        /* written by the loop thread only */
+static size_t num_latencies;
+static _Atomic uint64_t submit_ns;
+
+static bool on_prepare(curl_event_request_t *req) {
+    latencies[num_latencies++] = macro_now() - req->start_time;
+    return false;                  /* skip the transfer */
+}
+
+static int on_complete(CURL *easy, curl_event_request_t *req) {
+    (void)easy; (void)req;
+    return 0;
+}
+
+static void *producer_main(void *arg) {
+    (void)arg;
+    uint64_t spent = 0;
+    curl_event_request_t **reqs = (curl_event_request_t **)calloc((size_t)batch, sizeof(*reqs));
+    for (int i = 0; i < per_producer; i += batch) {
+        int n = per_producer - i < batch ? per_producer - i : batch;
+        for (int j = 0; j < n; j++) {
+            reqs[j] = curl_event_request_build_get("file:///dev/null", NULL, on_complete);
+            curl_event_request_on_prepare(reqs[j], on_prepare);
+        }
+        uint64_t t0 = macro_now();
+        if (batch == 1) {
+            curl_event_runtime_submit(rt, reqs[0], 0);
+        } else {
+            curl_event_loop_submit_batch(curl_event_runtime_loop(rt, 0), reqs, (size_t)n);
+        }
+        spent += macro_now() - t0;
+    }
+    free(reqs);
+    atomic_fetch_add(&submit_ns, spent);
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double pct_us(const uint64_t *v, size_t n, double p) {
+    size_t i = (size_t)(p * (double)(n - 1));
+    return (double)v[i] / 1e3;
+}
+
+int main(int argc, char **argv) {
+    int producers = argc > 1 ? atoi(argv[1]) : 16;
+    if (argc > 2) per_producer = atoi(argv[2]);
+    if (argc > 3) batch = atoi(argv[3]) > 0 ? atoi(argv[3]) : 1;
+    size_t total = (size_t)producers * (size_t)per_producer;
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    latencies = (uint64_t *)calloc(total, sizeof(uint64_t));
+    rt = curl_event_runtime_init(1, false);
+    curl_event_runtime_start(rt);
+
+    pthread_t *threads = (pthread_t *)calloc((size_t)producers, sizeof(pthread_t));
+    uint64_t start = macro_now();
+    for (int i = 0; i < producers; i++)
+        pthread_create(&threads[i], NULL, producer_main, NULL);
+    for (int i = 0; i < producers; i++)
+        pthread_join(threads[i], NULL);
+    curl_event_runtime_stop(rt, true);
+    double wall = macro_time_diff(macro_now(), start);
+
+    qsort(latencies, num_latencies, sizeof(uint64_t), cmp_u64);
+    printf("producers %d, batch %d, requests %zu, picked up %zu, wall %.3f s\n",
+           producers, batch, total, num_latencies, wall);
+    printf("submit per req   %8.1f ns avg\n",
+           (double)atomic_load(&submit_ns) / (double)total);
+    if (num_latencies) {
+        printf("submit → loop    p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+               pct_us(latencies, num_latencies, 0.50),
+               pct_us(latencies, num_latencies, 0.99),
+               pct_us(latencies, num_latencies, 1.0));
+    }
+
+    curl_event_runtime_destroy(rt);
+    free(threads);
+    free(latencies);
+    curl_global_cleanup();
+    return 0;
+}
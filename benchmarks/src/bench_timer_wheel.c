@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Scheduler cost: timer wheel vs the macro_map multimap it replaced.
+ *
+ * N timers get random expiries over a 60 s horizon, 10% are cancelled, and
+ * the rest are expired by stepping a clock in 1 ms ticks (what the loop
+ * does).  Reports ns per insert, cancel and expiry.
+ *
+ *   ./bench_timer_wheel [n ...]
+ *   default: 10000 100000 1000000 10000000
+ */
+
+#include "a-curl-library/impl/timer_wheel.h"
+#include "the-macro-library/macro_map.h"
+#include "a-memory-library/aml_alloc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define HORIZON_MS 60000u
+
+typedef struct bench_timer_s {
+    macro_map_t  node;
+    uint64_t     at;
+} bench_timer_t;
+
+static inline int bench_timer_compare(const bench_timer_t *a, const bench_timer_t *b) {
+    if (a->at < b->at) return -1;
+    return a->at > b->at;
+}
+static inline macro_multimap_insert(bench_timer_insert, bench_timer_t, bench_timer_compare)
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* xorshift64: deterministic and cheap */
+static uint64_t rng_state = 88172645463325252ull;
+static uint64_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void report(const char *name, size_t n, size_t cancelled, size_t fired,
+                   double t_insert, double t_cancel, double t_expire) {
+    printf("%-6s %9zu %11.1f %11.1f %11.1f %9zu\n", name, n,
+           t_insert * 1e9 / (double)n,
+           cancelled ? t_cancel * 1e9 / (double)cancelled : 0.0,
+           fired ? t_expire * 1e9 / (double)fired : 0.0, fired);
+}
+
+static void bench_wheel(size_t n, const uint64_t *at) {
+    timer_node_t *nodes = (timer_node_t *)aml_calloc(n, sizeof(timer_node_t));
+    timer_wheel_t *w = (timer_wheel_t *)aml_calloc(1, sizeof(timer_wheel_t));
+    timer_wheel_init(w, 0);
+
+    double t0 = now_s();
+    for (size_t i = 0; i < n; i++)
+        timer_wheel_insert(w, &nodes[i], at[i]);
+    double t1 = now_s();
+    size_t cancelled = 0;
+    for (size_t i = 0; i < n; i += 10, cancelled++)
+        timer_wheel_remove(w, &nodes[i]);
+    double t2 = now_s();
+    size_t fired = 0;
+    timer_node_t expired;
+    timer_list_init(&expired);
+    for (uint64_t tick = 0; tick <= HORIZON_MS; tick++) {
+        fired += timer_wheel_advance(w, tick, &expired);
+        while (!timer_list_empty(&expired))
+            timer_list_unlink(expired.next);
+    }
+    double t3 = now_s();
+
+    report("wheel", n, cancelled, fired, t1 - t0, t2 - t1, t3 - t2);
+    aml_free(w);
+    aml_free(nodes);
+}
+
+static void bench_map(size_t n, const uint64_t *at) {
+    bench_timer_t *nodes = (bench_timer_t *)aml_calloc(n, sizeof(bench_timer_t));
+    macro_map_t *root = NULL;
+
+    double t0 = now_s();
+    for (size_t i = 0; i < n; i++) {
+        nodes[i].at = at[i];
+        bench_timer_insert(&root, &nodes[i]);
+    }
+    double t1 = now_s();
+    size_t cancelled = 0;
+    for (size_t i = 0; i < n; i += 10, cancelled++)
+        macro_map_erase(&root, &nodes[i].node);
+    double t2 = now_s();
+    size_t fired = 0;
+    for (uint64_t tick = 0; tick <= HORIZON_MS; tick++) {
+        macro_map_t *m;
+        while ((m = macro_map_first(root)) && ((bench_timer_t *)m)->at <= tick) {
+            macro_map_erase(&root, m);
+            fired++;
+        }
+    }
+    double t3 = now_s();
+
+    report("map", n, cancelled, fired, t1 - t0, t2 - t1, t3 - t2);
+    aml_free(nodes);
+}
+
+int main(int argc, char **argv) {
+    size_t levels[16] = { 10000, 100000, 1000000, 10000000 };
+    int nlevels = 4;
+    if (argc > 1) {
+        nlevels = 0;
+        for (int i = 1; i < argc && nlevels < 16; i++)
+            levels[nlevels++] = (size_t)strtoull(argv[i], NULL, 10);
+    }
+
+    printf("%-6s %9s %11s %11s %11s %9s\n",
+           "sched", "timers", "insert_ns", "cancel_ns", "expire_ns", "fired");
+    for (int l = 0; l < nlevels; l++) {
+        size_t n = levels[l];
+        uint64_t *at = (uint64_t *)aml_calloc(n, sizeof(uint64_t));
+        for (size_t i = 0; i < n; i++)
+            at[i] = 1 + rng() % HORIZON_MS;
+        bench_wheel(n, at);
+        bench_map(n, at);
+        aml_free(at);
+        fflush(stdout);
+    }
+    return 0;
+}
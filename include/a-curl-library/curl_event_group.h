@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CURL_EVENT_GROUP_H
+#define CURL_EVENT_GROUP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "a-curl-library/curl_event_request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------
+   Request group: a tag shared by related requests (e.g. one job's
+   fan-out) so they can be cancelled together.  A group belongs to one
+   loop.  Cancelling it removes every member from wherever it waits
+   (in flight, ready, timer, rate-limited or blocked on a resource) in
+   O(group size) on the loop thread.  Cancellation is sticky: requests
+   of a cancelled group that are submitted later are dropped too.
+   --------------------------------------------------------------------- */
+struct curl_event_group_s;
+typedef struct curl_event_group_s curl_event_group_t;
+
+curl_event_group_t *curl_event_group_init(curl_event_loop_t *loop);
+
+/* Drops the caller's reference; member requests keep theirs. */
+void   curl_event_group_release(curl_event_group_t *group);
+
+/* Attach req before it is submitted (at most one group per request). */
+bool   curl_event_request_group(curl_event_request_t *req, curl_event_group_t *group);
+
+/* Any thread.  Returns false if the group was already cancelled. */
+bool   curl_event_group_cancel(curl_event_group_t *group);
+bool   curl_event_group_cancelled(const curl_event_group_t *group);
+
+/* Loop thread: members the loop has admitted and not yet finished. */
+size_t curl_event_group_size(const curl_event_group_t *group);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CURL_EVENT_GROUP_H */
@@ -9,6 +9,8 @@
 #include <stdint.h>
 #include "a-curl-library/curl_event_request.h"  /* brings in callbacks etc. */
 #include "a-curl-library/curl_resource.h"
+#include "a-curl-library/curl_event_share.h"
+#include "a-curl-library/curl_event_group.h"
 
 #ifndef A_CURL_EVENT_LOOP_T_DECL
 #define A_CURL_EVENT_LOOP_T_DECL
@@ -19,6 +21,26 @@ typedef struct curl_event_loop_s curl_event_loop_t;
 /* Per‑iteration callback: return false to stop the loop */
 typedef bool (*curl_event_on_loop_t)(curl_event_loop_t *loop, void *arg);
 
+/* --------------------------------------------------------------------- */
+/* Priority lanes                                                        */
+/* A request's priority picks its lane: values are clamped to
+ * [0, CURL_EVENT_PRIORITY_LANES - 1] and higher lanes are served first.
+ * Within a lane requests start in the order they became ready.          */
+#define CURL_EVENT_PRIORITY_LANES 4
+
+typedef enum {
+    CURL_EVENT_DISPATCH_STRICT   = 0,  /* always the highest non-empty lane  */
+    CURL_EVENT_DISPATCH_WEIGHTED = 1   /* deficit round robin by lane weight */
+} curl_event_dispatch_t;
+
+typedef struct {
+    uint64_t depth;                   /* ready and waiting for a slot (now) */
+    uint64_t dispatched;              /* requests started from this lane    */
+    uint64_t promoted;                /* aged up into the next lane         */
+    uint64_t wait_ns_total;           /* ready → started, summed            */
+    uint64_t wait_ns_max;
+} curl_event_lane_metrics_t;
+
 /* --------------------------------------------------------------------- */
 /* Metrics                                                               */
 typedef struct {
@@ -26,8 +48,145 @@ typedef struct {
     uint64_t completed_requests;
     uint64_t failed_requests;
     uint64_t retried_requests;
+    uint64_t retries_denied;          /* retries refused by the retry budget */
+    uint64_t expired_requests;        /* dropped at their deadline          */
+    uint64_t hedges_fired;            /* duplicate attempts launched        */
+    uint64_t hedges_won;              /* ...whose response was delivered    */
+    uint64_t coalesced_requests;      /* served by another request's transfer */
+    uint64_t host_parked;             /* times a request waited at max_host_requests */
+
+    /* response cache (curl_event_loop_set_cache) */
+    uint64_t cache_hits;              /* answered from the cache (fresh or 304) */
+    uint64_t cache_misses;            /* fetched with no stored response    */
+    uint64_t cache_revalidations;     /* conditional requests for stale entries */
+    uint64_t cache_evictions;         /* entries dropped to fit the budget  */
+    uint64_t cache_disk_hits;         /* ...cache_hits read from the disk tier */
+
+    /* easy-handle pool */
+    uint64_t easy_handle_hits;        /* attempts served from the pool      */
+    uint64_t easy_handle_misses;      /* attempts that needed curl_easy_init */
+    uint64_t easy_handle_high_water;  /* most idle handles held at once     */
+
+    /* connection / TLS reuse (per finished attempt) */
+    uint64_t connections_new;         /* attempt opened a connection        */
+    uint64_t connections_reused;      /* attempt reused a cached connection */
+    uint64_t tls_handshakes;          /* new TLS connections (full+resumed) */
+    uint64_t tls_resumed;             /* ...of which resumed a session (OpenSSL
+                                         backends; others count as full)    */
+
+    /* circuit breakers (curl_event_loop_set_breaker) */
+    uint64_t breakers_open;           /* keys open or half-open (now)       */
+    uint64_t breaker_trips;           /* closed or half-open → open         */
+    uint64_t breaker_half_opens;      /* open → half-open                   */
+    uint64_t breaker_recoveries;      /* half-open → closed                 */
+    uint64_t breaker_probes;          /* requests let through while half-open */
+    uint64_t breaker_rejected;        /* failed fast while open             */
+    uint64_t breaker_parked;          /* times a request waited on a breaker */
+
+    /* priority lanes, lowest first */
+    curl_event_lane_metrics_t lanes[CURL_EVENT_PRIORITY_LANES];
 } curl_event_metrics_t;
 
+/* --------------------------------------------------------------------- */
+/* Per-key statistics                                                    */
+/* Every attempt that reached the network is counted under its rate-limit
+ * key (if it has one) and under its URL authority, with a log-linear
+ * histogram per phase.  Connection phases come from libcurl's
+ * CURLINFO_*_TIME_T and are only recorded when they happened (a reused
+ * connection has no DNS, connect or TLS time).                          */
+typedef enum {
+    CURL_EVENT_PHASE_TOTAL    = 0,    /* whole attempt (CURLINFO_TOTAL_TIME_T) */
+    CURL_EVENT_PHASE_QUEUE    = 1,    /* ready → started, waiting for a slot */
+    CURL_EVENT_PHASE_DNS      = 2,    /* name lookup                       */
+    CURL_EVENT_PHASE_CONNECT  = 3,    /* TCP (or QUIC) connect             */
+    CURL_EVENT_PHASE_TLS      = 4,    /* TLS handshake                     */
+    CURL_EVENT_PHASE_TTFB     = 5,    /* request sent → first response byte */
+    CURL_EVENT_PHASE_TRANSFER = 6,    /* first byte → done                 */
+    CURL_EVENT_PHASES         = 7
+} curl_event_phase_t;
+
+typedef enum {
+    CURL_EVENT_STATS_RATE_KEY = 0,
+    CURL_EVENT_STATS_HOST     = 1
+} curl_event_stats_kind_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t mean_us;
+    uint64_t p50_us;
+    uint64_t p90_us;
+    uint64_t p99_us;
+    uint64_t p999_us;
+    uint64_t max_us;
+} curl_event_latency_t;
+
+typedef struct {
+    uint64_t attempts;                /* finished attempts                  */
+    uint64_t bytes_sent;              /* request bodies                     */
+    uint64_t bytes_received;          /* response bodies (as transferred)   */
+    uint64_t status[6];               /* [1]..[5]: 1xx..5xx; [0]: no response */
+    curl_event_latency_t phases[CURL_EVENT_PHASES];
+} curl_event_key_stats_t;
+
+typedef void (*curl_event_on_key_stats_t)(const char *key,
+                                          const curl_event_key_stats_t *stats,
+                                          void *arg);
+
+/* --------------------------------------------------------------------- */
+/* Circuit breaker                                                       */
+/* Attempts are counted per rate-limit key, or per URL authority for
+ * requests without one.  An attempt fails if it got no response (other
+ * than a write error) or a 5xx; a 429 is left to the rate manager.      */
+typedef enum {
+    CURL_EVENT_BREAKER_CLOSED    = 0,  /* requests flow                      */
+    CURL_EVENT_BREAKER_OPEN      = 1,  /* requests fail fast or are parked   */
+    CURL_EVENT_BREAKER_HALF_OPEN = 2   /* a few probes decide                */
+} curl_event_breaker_state_t;
+
+typedef void (*curl_event_on_breaker_t)(const char *key,
+                                        curl_event_breaker_state_t from,
+                                        curl_event_breaker_state_t to,
+                                        void *arg);
+
+typedef struct {
+    unsigned consecutive_failures;    /* trip after this many in a row (0 = off) */
+    double   failure_rate;            /* ...or at this share of failures (0 = off) */
+    unsigned min_requests;            /* attempts the window needs first (10) */
+    uint64_t window_ms;               /* failure-rate window (10000)        */
+    uint64_t open_ms;                 /* open before probing (5000)         */
+    unsigned probes;                  /* probes at once, and successes that
+                                         close the breaker (1)              */
+    bool     park;                    /* hold requests while open instead of
+                                         failing them                       */
+    curl_event_on_breaker_t on_change;   /* optional, on every transition   */
+    void    *on_change_arg;
+} curl_event_breaker_config_t;
+
+/* --------------------------------------------------------------------- */
+/* Retry budget                                                          */
+/* Retries (on_retry, or on_failure returning a delay) spend tokens from
+ * a bucket that each first attempt tops up by `ratio`, and time by
+ * min_per_sec, up to `burst`.  A request that would retry with the bucket
+ * empty ends as it is, so retries stay a bounded share of the load.     */
+typedef struct {
+    double ratio;                     /* retries earned per first attempt (0.1) */
+    double min_per_sec;               /* retries earned per second regardless */
+    double burst;                     /* most retries banked; starts full (10) */
+    bool   per_key;                   /* a budget per rate-limit key or host,
+                                         instead of one for the loop        */
+} curl_event_retry_budget_t;
+
+/* --------------------------------------------------------------------- */
+/* I/O backend                                                           */
+/* POLL  – curl_multi_perform + curl_multi_poll every tick (default).     */
+/* EPOLL – CURLMOPT_SOCKETFUNCTION/TIMERFUNCTION + curl_multi_socket_action
+ *         driven by a loop-owned epoll set; work per wakeup is proportional
+ *         to the number of ready sockets.  Linux only.                   */
+typedef enum {
+    CURL_EVENT_BACKEND_POLL  = 0,
+    CURL_EVENT_BACKEND_EPOLL = 1
+} curl_event_backend_t;
+
 /* --------------------------------------------------------------------- */
 /* Core loop control API                                                 */
 curl_event_loop_t *curl_event_loop_init(curl_event_on_loop_t on_loop, void *arg);
@@ -38,12 +197,166 @@ bool  curl_event_loop_submit(curl_event_loop_t *loop,
                              struct curl_event_request_s *req,
                              int priority);
 
+/* Submit n requests (each at its own req->priority) with one queue splice
+   and at most one wakeup; the loop admits them in array order.  Requests
+   that fail validation (no URL, already submitted) are skipped and stay
+   owned by the caller.  Returns the number submitted. */
+size_t curl_event_loop_submit_batch(curl_event_loop_t *loop,
+                                    struct curl_event_request_s **reqs,
+                                    size_t n);
+
 /* Cancel an in-flight or queued request (req is the same pointer you submitted) */
 bool  curl_event_loop_cancel(curl_event_loop_t *loop, struct curl_event_request_s *req);
 
+/* Max idle CURL* handles kept for reuse (default 64; 0 disables pooling).
+   Handles are recycled with curl_easy_reset, which keeps libcurl's
+   per-handle caches and allocations.  Shrinking frees the excess. */
+void  curl_event_loop_set_easy_pool_size(curl_event_loop_t *loop, size_t max_idle);
+
+/* Most requests in flight at once.  The default leaves a quarter of
+   RLIMIT_NOFILE (at least 32 descriptors) to the rest of the process and
+   is at most 1000; open connections are held to the same descriptor
+   budget (CURLMOPT_MAX_TOTAL_CONNECTIONS).  0 holds every request in
+   its lane. */
+void  curl_event_loop_set_max_concurrent(curl_event_loop_t *loop, size_t max);
+
+/* Most requests in flight per URL authority (host[:port]); 0, the
+   default, means no cap.  A request for a host at the cap waits on that
+   host without holding up requests for other hosts, and takes the next
+   slot the host frees.  Loop thread (or before the loop runs). */
+void  curl_event_loop_set_max_host_requests(curl_event_loop_t *loop, size_t max);
+
+/* libcurl's connection limits: CURLMOPT_MAX_HOST_CONNECTIONS (per_host),
+   CURLMOPT_MAX_TOTAL_CONNECTIONS (total) and CURLMOPT_MAXCONNECTS (idle
+   connections kept in the cache).  0 means no limit for per_host and
+   total; a negative value leaves that setting unchanged.  Transfers over
+   a connection limit wait inside libcurl while holding their request
+   slot, so pair per_host with curl_event_loop_set_max_host_requests. */
+bool  curl_event_loop_set_connection_limits(curl_event_loop_t *loop, long per_host,
+                                            long total, long cache_size);
+
+/* HTTP/2 multiplexing (CURLPIPE_MULTIPLEX; on by default).  While on,
+   transfers wait for a connection that may multiplex (CURLOPT_PIPEWAIT)
+   instead of opening another one. */
+bool  curl_event_loop_set_multiplex(curl_event_loop_t *loop, bool enable);
+
+/* Replace the loop's CURLSH with a fresh one using the given
+   CURL_EVENT_SHARE_* bits (default CURL_EVENT_SHARE_DEFAULT). */
+bool  curl_event_loop_set_share_profile(curl_event_loop_t *loop, unsigned flags);
+
+/* Attach a share that other loops may use too (the loop takes a reference).
+   Both calls fail while transfers are in flight. */
+bool  curl_event_loop_set_share(curl_event_loop_t *loop, curl_event_share_t *share);
+
+/* Choose how ready requests are taken from the priority lanes (default
+   STRICT).  weights (lowest lane first) apply to WEIGHTED; NULL keeps
+   the default 1, 2, 4, 8.  A zero weight is treated as 1. */
+void  curl_event_loop_set_dispatch(curl_event_loop_t *loop,
+                                   curl_event_dispatch_t mode,
+                                   const unsigned *weights);
+
+/* A request that has waited aging_ms in its lane moves up one lane, and
+   again after each further aging_ms, so low lanes cannot starve (default
+   10000; 0 disables aging). */
+void  curl_event_loop_set_priority_aging(curl_event_loop_t *loop, uint64_t aging_ms);
+
+/* Hedged attempts may add at most max_ratio extra transfers per hedge-
+   enabled request started (default 0.1; 0 disables hedging). */
+void  curl_event_loop_set_hedge_ratio(curl_event_loop_t *loop, double max_ratio);
+
+/* Circuit breaker per rate-limit key or host (see
+   curl_event_breaker_config_t; zero fields take the defaults shown
+   there).  It opens after consecutive_failures failed attempts in a row,
+   or when failure_rate of at least min_requests attempts in the last
+   window_ms failed.  While open, requests for the key end with on_failure
+   (CURL_EVENT_E_CIRCUIT_OPEN, easy == NULL), or wait on the breaker if
+   park is set; cache hits and coalesced followers are still served.
+   After open_ms it lets `probes` requests through: that many successes
+   close it, a failure opens it again.  NULL turns breakers off and closes
+   them.  Loop thread (or before the loop runs). */
+bool  curl_event_loop_set_breaker(curl_event_loop_t *loop,
+                                  const curl_event_breaker_config_t *config);
+
+/* Bound retries to a share of first attempts (see
+   curl_event_retry_budget_t; zero ratio and burst take the defaults shown
+   there).  Retries a budget refuses are counted in retries_denied.  NULL
+   (the default) lets every request retry as its on_retry decides.  Loop
+   thread (or before the loop runs). */
+bool  curl_event_loop_set_retry_budget(curl_event_loop_t *loop,
+                                       const curl_event_retry_budget_t *budget);
+
+/* Current state of the breaker for key (a rate-limit key or host[:port]);
+   CLOSED if it has seen no attempts.  Loop thread. */
+curl_event_breaker_state_t curl_event_loop_breaker_state(const curl_event_loop_t *loop,
+                                                         const char *key);
+
+/* Memory tier of the GET response cache, bounded to max_bytes (bodies, keys
+   and validators; least recently used entries go first).  A response is
+   stored when Cache-Control max-age or Expires makes it fresh, or when it
+   carries an ETag or Last-Modified.  A fresh entry is replayed through
+   write_cb and on_complete (easy == NULL), so sinks see init, write and
+   complete without a transfer; a stale one is revalidated with
+   If-None-Match / If-Modified-Since and replayed on 304.  Entries are
+   keyed like coalescing (method, URL, Accept*, Authorization, Cookie,
+   Range); responses that Vary on other headers or say no-store are not
+   stored.  Requests with their own validators or Cache-Control: no-store
+   bypass the cache, and no-cache forces a revalidation.  0 turns the
+   memory tier off and drops its entries. */
+bool  curl_event_loop_set_cache(curl_event_loop_t *loop, size_t max_bytes);
+
+/* Persistent tier under the response cache, in directory `dir` (created
+   if needed; one loop per directory).  Stored responses are appended to
+   segment files and found through a memory-mapped hash index, so they
+   survive restarts without a rebuild.  Hits are replayed to the sink
+   straight from the mapped segment.  max_bytes bounds the segments: the
+   oldest segment is dropped first, and entries read from it are written
+   again, so eviction approximates LRU.  Works with or without the
+   memory tier; NULL or 0 closes it (the files stay). */
+bool  curl_event_loop_set_disk_cache(curl_event_loop_t *loop, const char *dir,
+                                     size_t max_bytes);
+
+/* Select the I/O backend. Must be called before the first run; returns
+   false if the backend is unavailable on this platform. */
+bool  curl_event_loop_set_backend(curl_event_loop_t *loop,
+                                  curl_event_backend_t backend);
+
 void  curl_event_loop_run(curl_event_loop_t *loop);
-void  curl_event_loop_stop(curl_event_loop_t *loop);
+void  curl_event_loop_stop(curl_event_loop_t *loop);   /* wakes the loop */
 
+/* --------------------------------------------------------------------- */
+/* Embedding in a foreign reactor (epoll, libuv, ...)                    */
+/* Instead of curl_event_loop_run, watch curl_event_loop_fd() for
+ * readability and call curl_event_loop_step() when it fires or when
+ * curl_event_loop_next_timeout_ms() elapses.  All three must be called from
+ * the same thread.                                                       */
+
+/* Switches the loop to the EPOLL backend and returns its fd (-1 if
+   unavailable).  The fd is also signalled by curl_event_loop_wake(), so
+   submits and cancels from other threads are noticed. */
+int   curl_event_loop_fd(curl_event_loop_t *loop);
+
+/* Milliseconds until the next timed event, 0 if work is ready now, or −1
+   if nothing is scheduled (wait on the fd only). */
+long  curl_event_loop_next_timeout_ms(curl_event_loop_t *loop);
+
+/* Runs each scheduling phase once without blocking.  Returns false when the
+   loop is idle (nothing queued, in flight or scheduled) or was stopped;
+   calling it again after a new submit is fine. */
+bool  curl_event_loop_step(curl_event_loop_t *loop);
+
+/* Counters of the loop.  From the loop's own thread the live values;
+   from any other thread a copy published at the end of each iteration. */
 curl_event_metrics_t curl_event_loop_get_metrics(const curl_event_loop_t *loop);
 
+/* Statistics of one rate-limit key or host[:port]; false if it has no
+   finished attempts yet.  Any thread. */
+bool  curl_event_loop_get_key_stats(curl_event_loop_t *loop, curl_event_stats_kind_t kind,
+                                    const char *key, curl_event_key_stats_t *out);
+
+/* Calls each(key, stats, arg) for every key of the kind, with statistics
+   taken in one consistent pass; the callback runs without the loop's
+   statistics lock held.  Returns the number of keys.  Any thread. */
+size_t curl_event_loop_foreach_key_stats(curl_event_loop_t *loop, curl_event_stats_kind_t kind,
+                                         curl_event_on_key_stats_t each, void *arg);
+
 #endif /* CURL_EVENT_LOOP_H */
@@ -32,6 +32,13 @@ typedef int    (*curl_event_on_failure_t)(CURL *easy, CURLcode res, long http,
 typedef size_t (*curl_event_write_callback_t)(void *ptr, size_t size,
                                               size_t nmemb,
                                               struct curl_event_request_s *req);
+/* Failure codes the loop passes to on_failure (with easy == NULL) beyond
+   libcurl's own CURLcode range; curl_event_strerror() names both. */
+#define CURL_EVENT_E_DEADLINE ((CURLcode)1000)   /* deadline passed before start */
+#define CURL_EVENT_E_CIRCUIT_OPEN ((CURLcode)1001) /* the key's breaker is open  */
+
+const char *curl_event_strerror(CURLcode code);
+
 /* on_retry: return true to reschedule (req->next_retry_at will be set) */
 typedef bool   (*curl_event_on_retry_t)  (struct curl_event_request_s *req);
 /* on_prepare: last chance to mutate the request on the loop thread */
@@ -54,14 +61,17 @@ typedef struct curl_event_request_s {
 
     /*— dependency / throttling —*/
     struct curl_res_dep_s *dep_head; /* built via curl_event_request_depend() */
-    char   *rate_limit;            /* token bucket key (dup into pool)      */
+    char   *rate_limit;            /* token bucket key (interned name)      */
+    struct rate_key_s *rate_key;   /* resolved by curl_event_request_rate_limit */
     bool    rate_limit_high_priority;
+    const char *rate_limited_by;   /* key, or ancestor, that last made it wait */
 
     /*— timeouts / speed (seconds) —*/
     long connect_timeout;
     long transfer_timeout;
     long low_speed_limit;
     long low_speed_time;
+    uint64_t deadline;             /* absolute macro_now() ns; 0 = none     */
 
     /*— retry behaviour —*/
     int    max_retries;            /* −1 = unlimited                        */
@@ -70,6 +80,14 @@ typedef struct curl_event_request_s {
     uint64_t max_backoff_delay_ms; /* default 0 (no cap)                    */
     bool     full_jitter;          /* default true                          */
 
+    /*— hedging (idempotent GETs; see curl_event_request_hedge) —*/
+    uint64_t hedge_delay_ms;       /* 0 = off unless hedge_percentile > 0   */
+    double   hedge_percentile;     /* 0 = fixed delay; else per-key quantile */
+
+    /*— coalescing (see curl_event_request_coalesce) —*/
+    bool     coalesce;
+    char    *coalesce_key;         /* NULL = method, URL and key headers    */
+
     /*— callbacks —*/
     curl_event_on_complete_t    on_complete;   /* required */
     curl_event_on_failure_t     on_failure;    /* optional */
@@ -100,7 +118,7 @@ typedef struct curl_event_request_s {
     uint64_t  request_start_time;
 
     /*— new ergonomics —*/
-    int       priority;            /* default 0 (higher = sooner)           */
+    int       priority;            /* lane, 0..CURL_EVENT_PRIORITY_LANES-1 (higher = sooner) */
     int       http3_override;      /* -1 use loop default; 0 off; 1 on      */
     uint64_t  refresh_interval_ms; /* 0 = disabled; loop resubmits if set   */
     bool      refresh_backoff_on_errors;
@@ -220,6 +238,31 @@ void curl_event_request_transfer_timeout(curl_event_request_t *req, long secs);
 void curl_event_request_low_speed(curl_event_request_t *req,
                                   long bytes_per_sec, long time_secs);
 
+/* Deadline: past it the request is dropped before it takes a connection
+   (on_failure gets CURL_EVENT_E_DEADLINE), an attempt in flight is cut
+   short, and retries back off within the remaining budget.  Ready
+   requests run earliest-deadline-first within a priority lane. */
+void curl_event_request_deadline(curl_event_request_t *req, uint64_t deadline_ns);
+void curl_event_request_deadline_in(curl_event_request_t *req, uint64_t budget_ms);
+
+/* Hedging: if a GET has not started delivering its body after delay_ms
+   (or, once enough samples exist, the observed `percentile` latency of
+   its rate-limit key or host), the loop races a duplicate attempt.  The
+   first attempt to deliver the body of a 200 (or a 304 revalidating a
+   cached response) feeds the sink, and its headers are the ones used;
+   the other is cancelled.  Capped by curl_event_loop_set_hedge_ratio. */
+void curl_event_request_hedge(curl_event_request_t *req,
+                              uint64_t delay_ms, double percentile);
+
+/* Coalescing: a GET whose key matches a transfer already in flight, and
+   not yet streaming its body, rides along instead of opening its own.
+   It gets the same body bytes through its own write_cb and then its own
+   on_complete / on_failure; cancelling it does not touch the leader.
+   The default key (key == NULL) is the method, URL and the Accept*,
+   Authorization, Cookie and Range headers.  Requests with dependencies
+   are never coalesced, and on_prepare only runs for the leader. */
+void curl_event_request_coalesce(curl_event_request_t *req, const char *key);
+
 /* Retry policy (simple) */
 void curl_event_request_max_retries(curl_event_request_t *req, int max_retries);
 void curl_event_request_backoff_factor(curl_event_request_t *req, double factor);
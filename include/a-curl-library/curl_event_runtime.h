@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CURL_EVENT_RUNTIME_H
+#define CURL_EVENT_RUNTIME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "a-curl-library/curl_event_loop.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------
+   Sharded runtime: N curl_event_loop_t instances, one thread each.
+
+   Requests are routed to a shard by hashing their rate-limit key (or the
+   URL host when no key is set), so connection reuse, the rate-limit bucket
+   and submission order for a key all stay on one loop.  Shards keep
+   running while idle until the runtime is stopped.
+   --------------------------------------------------------------------- */
+struct curl_event_runtime_s;
+typedef struct curl_event_runtime_s curl_event_runtime_t;
+
+/* num_loops == 0 uses one loop per online CPU.  When pin_threads is true
+   shard i is pinned to CPU (i % ncpu) (Linux only; ignored elsewhere). */
+curl_event_runtime_t *curl_event_runtime_init(size_t num_loops, bool pin_threads);
+
+/* Stops (without draining) if still running, then destroys every loop. */
+void   curl_event_runtime_destroy(curl_event_runtime_t *rt);
+
+/* Spawn one thread per loop. Loops may be configured before this. */
+bool   curl_event_runtime_start(curl_event_runtime_t *rt);
+
+/* Coordinated shutdown. drain=true lets every shard finish its queued and
+   in-flight work first; drain=false stops at the next iteration.  Joins
+   all shard threads before returning. */
+void   curl_event_runtime_stop(curl_event_runtime_t *rt, bool drain);
+
+/* Route req to its shard and submit it there (see curl_event_request_submit). */
+curl_event_request_t *
+curl_event_runtime_submit(curl_event_runtime_t *rt,
+                          curl_event_request_t *req,
+                          int priority);
+
+/* Shard that req would be routed to.  A request in a group goes to the
+   shard whose loop the group was made for (curl_event_runtime_loop); a
+   group from a loop outside the runtime is rejected at submit. */
+size_t curl_event_runtime_shard_for(const curl_event_runtime_t *rt,
+                                    const curl_event_request_t *req);
+
+size_t             curl_event_runtime_num_loops(const curl_event_runtime_t *rt);
+curl_event_loop_t *curl_event_runtime_loop(curl_event_runtime_t *rt, size_t idx);
+
+/* Sum of curl_event_loop_get_metrics() over every shard. */
+curl_event_metrics_t curl_event_runtime_get_metrics(const curl_event_runtime_t *rt);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CURL_EVENT_RUNTIME_H */
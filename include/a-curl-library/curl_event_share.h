@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CURL_EVENT_SHARE_H
+#define CURL_EVENT_SHARE_H
+
+#include <stdbool.h>
+#include <curl/curl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------
+   Share profile: which libcurl caches a CURLSH holds for its easy handles.
+   --------------------------------------------------------------------- */
+enum {
+    CURL_EVENT_SHARE_DNS         = 1u << 0,  /* resolver cache                  */
+    CURL_EVENT_SHARE_SSL_SESSION = 1u << 1,  /* TLS session tickets (resumption) */
+    CURL_EVENT_SHARE_CONNECT     = 1u << 2,  /* connection cache (one loop only) */
+    CURL_EVENT_SHARE_PSL         = 1u << 3   /* public suffix list               */
+};
+
+/* Loop default */
+#define CURL_EVENT_SHARE_DEFAULT \
+    (CURL_EVENT_SHARE_DNS | CURL_EVENT_SHARE_SSL_SESSION | CURL_EVENT_SHARE_PSL)
+
+/* A refcounted CURLSH with one mutex per lock_data, so several loops (each
+   on its own thread) can use it at once.  CONNECT cannot be shared across
+   threads by libcurl, so a share with that bit attaches to one loop only. */
+struct curl_event_share_s;
+typedef struct curl_event_share_s curl_event_share_t;
+
+/* Returns NULL if a requested bit is unsupported by the linked libcurl. */
+curl_event_share_t *curl_event_share_init(unsigned flags);
+unsigned            curl_event_share_flags(const curl_event_share_t *share);
+
+/* Drops the caller's reference; loops using the share keep theirs. */
+void                curl_event_share_release(curl_event_share_t *share);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CURL_EVENT_SHARE_H */
@@ -30,7 +30,7 @@ typedef uint64_t curl_event_res_id;
    other threads; they post an op into the loop’s inbox and wake the loop.
    ────────────────────────────────────────────────────────────────────── */
 
-/* One‑time setup called by the loop when it starts (records owner thread). */
+/* Called by the loop thread before it touches resources (records owner thread). */
 void curl_resource_set_owner_thread(struct curl_event_loop_s *loop);
 
 /* Drain the cross‑thread inbox. The loop should call this at safe points
@@ -134,6 +134,10 @@ bool curl_resource_check_and_block_list(struct curl_event_loop_s         *loop,
                                         struct curl_event_loop_request_s *req,
                                         struct curl_res_dep_s            *head);
 
+/* Remove a blocked request from its resource's waiter list (O(1)). */
+void curl_resource_unblock(struct curl_event_loop_s         *loop,
+                           struct curl_event_loop_request_s *req);
+
 /* Readiness only: true iff every dep has a published payload or failed flag. */
 bool curl_resource_all_ready_list(struct curl_event_loop_s       *loop,
                                   const struct curl_res_dep_s    *head);
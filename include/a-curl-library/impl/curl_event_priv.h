@@ -8,10 +8,15 @@
 /* Public facade (brings in request struct & callbacks) */
 #include "a-curl-library/curl_event_loop.h"
 #include "a-curl-library/curl_resource.h"   /* curl_event_res_id */
+#include "a-curl-library/rate_manager.h"
+#include "a-curl-library/impl/mpsc_queue.h"
+#include "a-curl-library/impl/timer_wheel.h"
+#include "a-curl-library/impl/latency_histogram.h"
 
 /* Third‑party / support */
 #include <pthread.h>
 #include <string.h>
+#include <time.h>
 #include <stdatomic.h>
 #include <stddef.h>                   /* offsetof */
 #include <curl/curl.h>
@@ -20,6 +25,7 @@
 #include "the-macro-library/macro_time.h"
 #include "a-memory-library/aml_alloc.h"
 #include "a-memory-library/aml_pool.h"
+#include "a-memory-library/aml_buffer.h"
 
 /* ------------------------------------------------------------------ */
 /* Forward decl for per‑request wrapper ------------------------------ */
@@ -35,11 +41,66 @@ typedef struct res_op_s {
 
 typedef struct res_inbox_s { _Atomic(res_op_t*) head; } res_inbox_t;
 
+/* Cross-thread message to the loop (curl_event_loop_s::inbox) */
+enum { LOOP_MSG_SUBMIT = 0, LOOP_MSG_CANCEL = 1, LOOP_MSG_INJECT = 2,
+       LOOP_MSG_CANCEL_GROUP = 3, LOOP_MSG_RATE_WAKE = 4 };
+
+typedef struct loop_msg_s {
+    mpsc_node_t node;
+    int         kind;               /* LOOP_MSG_*                          */
+} loop_msg_t;
+
+/* Which loop container currently holds a request (loop thread only) */
+enum {
+    REQ_WHERE_NONE   = 0,   /* in the inbox, requeued to pending, or in transit */
+    REQ_WHERE_TIMER  = 1,   /* loop->timers: waiting on retry/refresh/rate limit */
+    REQ_WHERE_READY  = 2,   /* loop->lanes[lane]: due, waiting for a slot */
+    REQ_WHERE_ACTIVE = 3,   /* loop->queued_requests: added to the multi */
+    REQ_WHERE_BLOCKED = 4,  /* a resource's blocked list (blocked_on) */
+    REQ_WHERE_FOLLOWER = 5, /* flight->followers: rides another transfer */
+    REQ_WHERE_CACHED = 6,   /* loop->cache_ready: fresh hit awaiting delivery */
+    REQ_WHERE_HOST   = 7,   /* host_slot->waiting: its host is at the cap */
+    REQ_WHERE_RATE   = 8,   /* loop->rate_waiting: queued on its rate-limit key */
+    REQ_WHERE_BREAKER = 9   /* breaker->parked: its circuit breaker is open */
+};
+
+/* Hedge progress of the current attempt (loop thread only) */
+enum {
+    HEDGE_IDLE     = 0,   /* not hedged (yet)                             */
+    HEDGE_ARMED    = 1,   /* hedge_timer on loop->hedge_timers            */
+    HEDGE_RACING   = 2,   /* hedge_easy running next to easy_handle       */
+    HEDGE_SETTLING = 3,   /* winner picked; hedge_timer on hedge_losers   */
+    HEDGE_DONE     = 4    /* one attempt left, no further hedge           */
+};
+
+/* Caching directives and validators of the attempt's response, parsed
+   from its headers (curl_event_cache.c) */
+typedef struct cache_meta_s {
+    long   max_age;                 /* -1 if absent                        */
+    long   age;                     /* Age header, seconds                 */
+    time_t date;                    /* -1 if absent                        */
+    time_t expires;                 /* -1 if absent, 0 if invalid (past)   */
+    bool   no_store;
+    bool   no_cache;
+    bool   vary_unkeyed;            /* Vary: * or a header not in the key  */
+    char  *etag;                    /* request pool; NULL if absent        */
+    char  *last_modified;
+} cache_meta_t;
+
+/* What header_callback parsed from one attempt's response */
+typedef struct attempt_response_s {
+    long  content_length;
+    bool  content_length_found;
+    rate_manager_hints_t rate_hints; /* quota headers                      */
+    cache_meta_t cache_meta;
+} attempt_response_t;
+
 /* ------------------------------------------------------------------ */
 /* Per‑request wrapper that lives in the loop’s containers ----------- */
 /* Note: This wrapper is typically allocated from req->pool now. */
 struct curl_event_loop_request_s {
     macro_map_t node;               /* multimap key = next_retry_at        */
+    timer_node_t timer;             /* wheel or lane link (TIMER/READY)    */
     curl_event_request_t request;   /* public view                         */
 
     /* libcurl plumbing */
@@ -47,16 +108,68 @@ struct curl_event_loop_request_s {
     CURL  *easy_handle;
 
     /* book‑keeping / links */
-    struct curl_event_loop_request_s *next_cancelled;
+    loop_msg_t submit_msg;          /* SUBMIT or INJECT                    */
+    loop_msg_t cancel_msg;
+    _Atomic bool cancel_requested;  /* set once by curl_event_loop_cancel  */
     struct curl_event_loop_request_s *next_pending;
+    struct curl_event_loop_request_s *prev_pending; /* resource blocked list */
+    void *blocked_on;               /* curl_event_res_t while BLOCKED      */
 
-    long  content_length;
-    bool  content_length_found;
+    /* rate-limit key: a counted slot, or a place in the key's queue (RATE) */
+    rate_manager_waiter_t rate_waiter;
+    loop_msg_t rate_msg;            /* RATE_WAKE, posted by on_wake        */
+    bool  rate_slot;
+    bool  rate_granted;             /* on_wake handed over a slot          */
+
+    /* request group (curl_event_group.h); members linked on the loop thread */
+    curl_event_group_t *group;
+    struct curl_event_loop_request_s *group_prev;
+    struct curl_event_loop_request_s *group_next;
+    bool  group_linked;
+
+    attempt_response_t response;    /* headers of the attempt delivering   */
     bool  is_injected;
-    bool  is_cancelled;
-    bool  is_pending;
+    bool  is_cancelled;             /* loop thread: cancel was processed   */
+    _Atomic bool is_pending;        /* submitted, not yet seen by the loop */
     bool  deps_retained;
+    unsigned char where;            /* REQ_WHERE_*                         */
+    unsigned char lane;             /* current lane (may be aged up)       */
+    uint64_t ready_at;              /* became ready (wait-time metric)     */
+    uint64_t lane_at;               /* entered the current lane (aging)    */
+    timer_node_t lane_node;         /* lane_arrivals: arrival order (aging) */
     long  bytes_downloaded;
+    int   tls_session_reused;       /* set by the pre-request callback */
+
+    /* hedged attempt (curl_event_request_hedge) */
+    CURL        *hedge_easy;        /* duplicate attempt while racing      */
+    CURL        *hedge_winner;      /* first successful attempt to write   */
+    attempt_response_t hedge_response; /* adopted if the hedge wins        */
+    timer_node_t hedge_timer;       /* hedge_timers, then hedge_losers     */
+    unsigned char hedge_state;      /* HEDGE_*                             */
+    uint64_t     hedge_start_time;
+    const char  *hedge_key;         /* latency key: rate_limit or host     */
+
+    /* per-host cap: a slot reserved on (or, while HOST, a place in the
+       queue of) the host's entry in loop->hosts */
+    struct host_slot_s *host_slot;
+    const char  *host_key;          /* URL authority                       */
+
+    /* circuit breaker: the one this request probes (breaker_probe), or is
+       parked on (BREAKER) */
+    struct breaker_s *breaker;
+    bool         breaker_probe;
+    bool         budget_retry;      /* next attempt was paid for by the budget */
+
+    /* coalescing: the flight this request leads, or follows (FOLLOWER) */
+    struct coalesce_flight_s *flight;
+    const char  *variant_key;       /* method, URL and key headers         */
+
+    /* HTTP cache: the entry being served or revalidated, and whether this
+       attempt's response may replace it */
+    struct cache_entry_s *cache_entry;
+    struct curl_slist    *cache_headers;  /* headers + conditionals       */
+    aml_buffer_t *cache_body;       /* captured body (cache_capture)       */
+    bool          cache_capture;
 };
 
 typedef struct curl_res_dep_s {
@@ -90,6 +203,168 @@ static inline macro_multimap_insert(
     curl_event_loop_request_t,
     curl_event_request_compare)
 
+static inline curl_event_loop_request_t *curl_wrap_from_timer(timer_node_t *n) {
+    return (curl_event_loop_request_t *)((char *)n
+        - offsetof(curl_event_loop_request_t, timer));
+}
+static inline curl_event_loop_request_t *curl_wrap_from_lane_node(timer_node_t *n) {
+    return (curl_event_loop_request_t *)((char *)n
+        - offsetof(curl_event_loop_request_t, lane_node));
+}
+static inline curl_event_loop_request_t *curl_wrap_from_hedge_timer(timer_node_t *n) {
+    return (curl_event_loop_request_t *)((char *)n
+        - offsetof(curl_event_loop_request_t, hedge_timer));
+}
+/* A response that answers the request: 200, or 304 for a pinned cache
+   entry.  Only such an attempt can win a hedge race. */
+static inline bool curl_event_request_answered(const curl_event_loop_request_t *req,
+                                               long http_code) {
+    return http_code == 200 || (http_code == 304 && req->cache_entry);
+}
+static inline curl_event_loop_request_t *curl_wrap_from_msg(mpsc_node_t *n) {
+    loop_msg_t *m = (loop_msg_t *)n;
+    size_t off = m->kind == LOOP_MSG_CANCEL
+               ? offsetof(curl_event_loop_request_t, cancel_msg)
+               : m->kind == LOOP_MSG_RATE_WAKE
+               ? offsetof(curl_event_loop_request_t, rate_msg)
+               : offsetof(curl_event_loop_request_t, submit_msg);
+    return (curl_event_loop_request_t *)((char *)m - off);
+}
+
+/* ------------------------------------------------------------------ */
+/* Share object (curl_event_share.c) --------------------------------- */
+struct curl_event_share_s {
+    CURLSH         *sh;
+    unsigned        flags;
+    _Atomic int     refcnt;
+    _Atomic int     num_loops;      /* loops currently attached */
+    pthread_mutex_t locks[CURL_LOCK_DATA_LAST];
+};
+
+void  curl_event_share_retain(curl_event_share_t *share);
+/* 1 = resumed TLS session, 0 = full handshake, -1 = unknown/not TLS */
+int   curl_event_tls_session_reused(CURL *easy);
+
+/* ------------------------------------------------------------------ */
+/* In-flight coalescing (curl_event_coalesce.c) ---------------------- */
+typedef struct coalesce_flight_s {
+    macro_map_t  node;              /* loop->inflight, keyed by key        */
+    const char  *key;
+    curl_event_loop_request_t *leader;
+    timer_node_t followers;         /* followers' timer links              */
+    size_t       num_followers;
+    bool         in_map;
+} coalesce_flight_t;
+
+/* Attach req to an in-flight leader with its key (if not yet streaming) */
+bool  curl_event_coalesce_follow(curl_event_loop_t *loop, curl_event_loop_request_t *req);
+/* A coalescable request started: make it the leader for its key */
+void  curl_event_coalesce_lead  (curl_event_loop_t *loop, curl_event_loop_request_t *req);
+/* The leader's attempt ended: later requests no longer attach to it */
+void  curl_event_coalesce_forget(curl_event_loop_t *loop, curl_event_loop_request_t *req);
+curl_event_loop_request_t *
+      curl_event_coalesce_pop_follower(curl_event_loop_request_t *leader);
+void  curl_event_coalesce_unfollow(curl_event_loop_request_t *req);
+/* Default coalescing / cache key: method, URL and the request headers
+   that select a representation (cached in req->variant_key) */
+const char *curl_event_request_variant_key(curl_event_loop_request_t *req);
+/* true if a response header name (Vary) is covered by the variant key */
+bool  curl_event_is_variant_header(const char *name, size_t len);
+
+/* ------------------------------------------------------------------ */
+/* HTTP response cache (curl_event_cache.c) -------------------------- */
+typedef struct curl_event_disk_cache_s curl_event_disk_cache_t;
+
+/* A memory entry (in_map) or a disk hit handed to one request, whose
+   key and body point into the mapped segment it pins */
+typedef struct cache_entry_s {
+    macro_map_t  node;              /* cache->entries, keyed by key        */
+    timer_node_t lru;               /* cache->lru, most recent at the tail */
+    const char  *key;               /* stored after the struct, then body  */
+    const char  *body;
+    struct disk_segment_s *segment; /* disk hit: keeps the mapping alive   */
+    size_t       len;
+    char        *etag;              /* validators; NULL if absent          */
+    char        *last_modified;
+    uint64_t     fresh_until;       /* macro_now() ns; stale at or after   */
+    size_t       charge;            /* bytes counted against the budget    */
+    int          refcnt;            /* the cache + requests pinning it     */
+    bool         in_map;
+} cache_entry_t;
+
+typedef struct curl_event_cache_s {
+    macro_map_t *entries;
+    timer_node_t lru;
+    size_t       bytes;
+    size_t       max_bytes;         /* memory tier; 0 = disk only          */
+    curl_event_disk_cache_t *disk;  /* NULL = no disk tier                 */
+} curl_event_cache_t;
+
+/* Dispatch: true if req was answered by a fresh entry and queued on
+   loop->cache_ready; otherwise pins a stale entry for revalidation */
+bool  curl_event_cache_lookup  (curl_event_loop_t *loop, curl_event_loop_request_t *req);
+/* Attempt setup: conditional headers and response capture */
+void  curl_event_cache_prepare (curl_event_loop_t *loop, curl_event_loop_request_t *req);
+void  curl_event_cache_header  (curl_event_loop_request_t *req, cache_meta_t *m,
+                                const char *line);
+void  curl_event_cache_capture (curl_event_loop_request_t *req, const void *data, size_t len);
+/* A transfer finished: store a 200 or answer a 304 from the pinned
+   entry.  Returns the status the request should see (*result becomes a
+   write error if the replay was refused). */
+long  curl_event_cache_complete(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                                CURLcode *result, long http_code);
+/* Deliver the pinned entry's body through write_cb */
+CURLcode curl_event_cache_deliver(curl_event_loop_request_t *req);
+/* Unpin the entry and drop capture state (end of every attempt) */
+void  curl_event_cache_release (curl_event_loop_request_t *req);
+void  curl_event_cache_destroy (curl_event_loop_t *loop);
+
+/* Disk tier (curl_event_disk_cache.c); expiry in wall-clock seconds */
+curl_event_disk_cache_t *curl_event_disk_cache_open(const char *dir, size_t max_bytes);
+void  curl_event_disk_cache_close(curl_event_disk_cache_t *d);
+/* A new entry (refcnt 1, not in the memory map) or NULL */
+cache_entry_t *curl_event_disk_cache_get(curl_event_disk_cache_t *d, const char *key);
+bool  curl_event_disk_cache_put(curl_event_disk_cache_t *d, const char *key,
+                                const char *etag, const char *last_modified,
+                                time_t expires, const void *body, size_t len);
+void  curl_event_disk_cache_refresh(curl_event_disk_cache_t *d, const char *key,
+                                    const char *etag, const char *last_modified,
+                                    time_t expires);
+void  curl_event_disk_cache_remove(curl_event_disk_cache_t *d, const char *key);
+size_t curl_event_disk_cache_max_entry(const curl_event_disk_cache_t *d);
+void  curl_event_disk_segment_release(struct disk_segment_s *seg);
+
+/* ------------------------------------------------------------------ */
+/* Per-key statistics (curl_event_stats.c) --------------------------- */
+/* A network attempt of req (on easy) finished: count it under its
+   rate-limit key and host_key */
+void  curl_event_stats_record (curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                               const char *host_key, CURL *easy, long http_code);
+/* Copy loop->metrics for readers on other threads (end of an iteration) */
+void  curl_event_stats_publish(curl_event_loop_t *loop);
+void  curl_event_stats_destroy(curl_event_loop_t *loop);
+
+/* ------------------------------------------------------------------ */
+/* Request group (curl_event_group.c) -------------------------------- */
+struct curl_event_group_s {
+    curl_event_loop_t *loop;
+    _Atomic int        refcnt;      /* caller + each attached request      */
+    _Atomic bool       cancelled;   /* sticky: later members are dropped   */
+    loop_msg_t         cancel_msg;
+    curl_event_loop_request_t *members;   /* loop thread only */
+    size_t             num_members;
+};
+
+static inline curl_event_group_t *curl_group_from_msg(mpsc_node_t *n) {
+    return (curl_event_group_t *)((char *)n
+        - offsetof(curl_event_group_t, cancel_msg));
+}
+
+void  curl_event_group_retain(curl_event_group_t *group);
+/* Loop thread: link an admitted request / unlink it when destroyed */
+void  curl_event_group_link  (curl_event_loop_request_t *req);
+void  curl_event_group_unlink(curl_event_loop_request_t *req);
+
 /* ------------------------------------------------------------------ */
 /* Full loop object (opaque to users) -------------------------------- */
 struct curl_event_loop_s {
@@ -99,34 +374,96 @@ struct curl_event_loop_s {
 
     /* libcurl handles */
     CURLM  *multi_handle;
-    CURLSH *shared_handle;
+    CURLSH *shared_handle;          /* == share->sh */
+    curl_event_share_t *share;
 
     /* flags, limits */
     bool    enable_http3;
     size_t  max_concurrent_requests;
+    size_t  max_host_requests;      /* 0 = no per-host cap */
+    bool    multiplex;              /* CURLPIPE_MULTIPLEX + CURLOPT_PIPEWAIT */
     bool    keep_running;
+    bool    persistent;             /* keep running while idle (runtime shards) */
 
     pthread_t             owner_thread;
 
+    /* I/O backend (see curl_event_epoll.c) */
+    curl_event_backend_t backend;
+    int       epoll_fd;                  /* -1 unless backend == EPOLL */
+    int       wake_fd;                   /* eventfd used by curl_event_loop_wake */
+    uint64_t  curl_timer_at;             /* libcurl timer deadline (ns) */
+    bool      curl_timer_armed;
+
     /* request containers */
     macro_map_t *queued_requests;        /* active in multi */
-    macro_map_t *inactive_requests;      /* waiting on retry time */
-    macro_map_t *refresh_requests;       /* periodic re-run */
-    macro_map_t *rate_limited_requests;  /* delayed by token bucket */
+    timer_wheel_t timers;                /* retry, refresh and rate-limit waits */
     macro_map_t *resources;              /* resource DAG nodes (internal) */
     res_inbox_t res_inbox;
 
     int  num_queued_requests;
     int  num_multi_requests;
-    int  num_inactive_requests;
-    int  num_refresh_requests;
+    int  num_ready_requests;
+
+    /* priority lanes: due requests waiting for a slot (EDF, then FIFO) */
+    timer_node_t          lanes[CURL_EVENT_PRIORITY_LANES];
+    timer_node_t          lane_arrivals[CURL_EVENT_PRIORITY_LANES]; /* by lane_at */
+    unsigned              lane_weight[CURL_EVENT_PRIORITY_LANES];
+    unsigned              lane_credit[CURL_EVENT_PRIORITY_LANES];
+    curl_event_dispatch_t dispatch_mode;
+    uint64_t              aging_ns;            /* 0 = no aging */
+
+    /* hedging: armed hedges, settled races awaiting loser removal, and
+       per-key attempt latency (us) for percentile delays */
+    timer_wheel_t hedge_timers;
+    timer_node_t  hedge_losers;
+    double        hedge_ratio;
+    double        hedge_credit;
+    macro_map_t  *latency_keys;
+
+    /* per-host in-flight counts and parked requests, by URL authority */
+    macro_map_t  *hosts;
+
+    /* circuit breakers by rate-limit key or host, and the ones holding
+       parked requests (breaker_s::link) */
+    curl_event_breaker_config_t breaker;
+    bool          breaker_on;
+    macro_map_t  *breakers;
+    timer_node_t  breakers_parked;
+    int           num_breaker_parked;
 
-    /* statistics */
+    /* retry budget: the loop's bucket, or one per rate-limit key or host */
+    curl_event_retry_budget_t retry_budget;
+    bool          retry_budget_on;
+    struct retry_budget_s *loop_budget;
+    macro_map_t  *retry_budgets;
+
+    /* requests queued for a slot on their rate-limit key */
+    timer_node_t  rate_waiting;
+
+    /* coalescing leaders by key (curl_event_coalesce.c) */
+    macro_map_t  *inflight;
+
+    /* response cache (NULL = off) and fresh hits awaiting delivery */
+    curl_event_cache_t *cache;
+    timer_node_t  cache_ready;
+
+    /* idle easy handles recycled with curl_easy_reset (LIFO) */
+    CURL  **easy_pool;
+    size_t  easy_pool_len;
+    size_t  easy_pool_cap;
+
+    /* statistics; per-key statistics and the published copy of the
+       metrics are read from other threads under stats_lock */
     curl_event_metrics_t metrics;
+    pthread_mutex_t      stats_lock;
+    curl_event_metrics_t published;
+    macro_map_t         *key_stats[2];   /* by curl_event_stats_kind_t */
+
+    /* submit / cancel / inject from any thread (lock-free FIFO) */
+    mpsc_queue_t               inbox;
+    _Atomic uint64_t           total_requests;   /* metrics.total_requests */
 
-    /* cross‑thread lists (protected by mutex) */
-    pthread_mutex_t            mutex;
-    curl_event_loop_request_t *cancelled_requests;
+    /* loop thread only: drained from the inbox or requeued by resources */
     curl_event_loop_request_t *pending_requests;
     curl_event_loop_request_t *injected_requests;
 };
@@ -136,5 +473,58 @@ struct curl_event_loop_s {
 void  curl_event_loop_request_cleanup(struct curl_event_loop_request_s *req);
 void  curl_event_request_destroy      (struct curl_event_loop_request_s *req);
 bool  curl_event_loop_request_start   (struct curl_event_loop_request_s *req);
+/* Start a duplicate attempt next to the running one */
+bool  curl_event_loop_request_hedge   (struct curl_event_loop_request_s *req);
+/* Feed body bytes to req (and its coalesced followers) as if received */
+size_t curl_event_loop_request_deliver(struct curl_event_loop_request_s *req,
+                                       const void *data, size_t len);
+/* Keep `winner` as the request's easy handle and remove the other attempt */
+void  curl_event_loop_request_settle_hedge(struct curl_event_loop_request_s *req,
+                                           CURL *winner);
+/* Queue req for dispatch at request.next_retry_at (ready now or on the wheel) */
+void  curl_event_loop_schedule        (curl_event_loop_t *loop,
+                                       struct curl_event_loop_request_s *req);
+
+/* Give back req's counted slot on its rate-limit key, if it holds one */
+void  curl_event_rate_release(struct curl_event_loop_request_s *req);
+
+/* A probe that ends without a result frees its place for another */
+void  curl_event_breaker_release(curl_event_loop_t *loop,
+                                 struct curl_event_loop_request_s *req);
+
+/* Transfers RLIMIT_NOFILE leaves room for (one socket each) */
+size_t curl_event_fd_budget(void);
+
+/* Give up req's per-host slot (if it holds one) to the host's next
+   parked request. */
+void  curl_event_host_release(curl_event_loop_t *loop,
+                              struct curl_event_loop_request_s *req);
+
+/* Queue a message for the loop; wakes it on the first message since the
+   last drain. */
+void  curl_event_loop_post(curl_event_loop_t *loop, loop_msg_t *msg, int kind);
+
+/* Loop thread: drop a request from whatever container holds it and
+   destroy it (or flag it, if it is only reachable through pending). */
+void  curl_event_loop_cancel_request(curl_event_loop_t *loop,
+                                     curl_event_loop_request_t *req);
+
+/* Validate req, fill inferred defaults and mark it pending; the caller
+   then posts wrap->submit_msg (shared by single and batch submit). */
+bool  curl_event_request_prepare_submit(curl_event_loop_t *loop,
+                                        curl_event_request_t *req,
+                                        int priority);
+
+/* Easy-handle pool (loop thread only) */
+CURL *curl_event_loop_easy_acquire(curl_event_loop_t *loop);
+void  curl_event_loop_easy_release(curl_event_loop_t *loop, CURL *easy);
+
+/* ------------------------------------------------------------------ */
+/* Socket-action backend (curl_event_epoll.c) ------------------------ */
+bool  curl_event_epoll_open (curl_event_loop_t *loop);
+void  curl_event_epoll_close(curl_event_loop_t *loop);
+void  curl_event_epoll_wake (curl_event_loop_t *loop);
+/* Wait up to timeout_ms for socket readiness and dispatch it to libcurl */
+int   curl_event_epoll_wait (curl_event_loop_t *loop, long timeout_ms);
 
 #endif /* A_CURL_LIBRARY_IMPL_CURL_EVENT_PRIV_H */
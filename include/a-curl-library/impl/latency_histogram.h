@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef A_CURL_LIBRARY_IMPL_LATENCY_HISTOGRAM_H
+#define A_CURL_LIBRARY_IMPL_LATENCY_HISTOGRAM_H
+
+/* Log-linear latency histogram (HDR style).
+
+   Values below 16 get a bucket each; above that every power of two is
+   split into 16 linear sub-buckets, so a reported percentile is within
+   1/16 (6.25%) of the true value.  Values are unitless (the loop records
+   microseconds) and anything at or past 2^40 lands in the last bucket.
+   Recording is a few shifts and one increment; no allocation.  Not
+   thread-safe. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LATENCY_HIST_SUB_BITS  4
+#define LATENCY_HIST_SUB       (1u << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_EXP   40
+#define LATENCY_HIST_BUCKETS   (LATENCY_HIST_SUB + \
+    (LATENCY_HIST_MAX_EXP - LATENCY_HIST_SUB_BITS) * LATENCY_HIST_SUB)
+
+typedef struct latency_hist_s {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+void     latency_hist_reset (latency_hist_t *h);
+void     latency_hist_record(latency_hist_t *h, uint64_t value);
+void     latency_hist_merge (latency_hist_t *dst, const latency_hist_t *src);
+
+/* Highest value equivalent to the p-quantile (p in [0,1]); 0 when empty. */
+uint64_t latency_hist_percentile(const latency_hist_t *h, double p);
+
+/* Bucket index for value / value range of a bucket (exposed for tests) */
+size_t   latency_hist_index(uint64_t value);
+uint64_t latency_hist_bucket_low (size_t index);
+uint64_t latency_hist_bucket_high(size_t index);
+
+#endif /* A_CURL_LIBRARY_IMPL_LATENCY_HISTOGRAM_H */
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef A_CURL_LIBRARY_IMPL_MPSC_QUEUE_H
+#define A_CURL_LIBRARY_IMPL_MPSC_QUEUE_H
+
+/* Intrusive multi-producer / single-consumer FIFO (Vyukov).
+
+   Producers push with one atomic exchange and never block each other; the
+   consumer pops without atomics read-modify-write except when the queue
+   runs dry.  A pop can briefly see the queue as empty while a producer is
+   between its two stores; that producer's push then reports that a wakeup
+   is due, so nothing is stranded.
+
+   `signalled` collapses wakeups: only the first push after the consumer
+   called mpsc_queue_begin_drain() asks the caller to wake the consumer. */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct mpsc_node_s {
+    _Atomic(struct mpsc_node_s *) next;
+} mpsc_node_t;
+
+typedef struct mpsc_queue_s {
+    _Atomic(mpsc_node_t *) head;   /* producers: last pushed node */
+    mpsc_node_t           *tail;   /* consumer: next node to pop  */
+    mpsc_node_t            stub;
+    _Atomic int            signalled;
+} mpsc_queue_t;
+
+static inline void mpsc_queue_init(mpsc_queue_t *q) {
+    atomic_init(&q->stub.next, NULL);
+    atomic_init(&q->head, &q->stub);
+    q->tail = &q->stub;
+    atomic_init(&q->signalled, 0);
+}
+
+static inline void mpsc_queue_link(mpsc_queue_t *q, mpsc_node_t *n) {
+    atomic_store_explicit(&n->next, NULL, memory_order_relaxed);
+    mpsc_node_t *prev = atomic_exchange_explicit(&q->head, n, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, n, memory_order_release);
+}
+
+/* Any thread.  Returns true when the consumer should be woken. */
+static inline bool mpsc_queue_push(mpsc_queue_t *q, mpsc_node_t *n) {
+    mpsc_queue_link(q, n);
+    return atomic_exchange_explicit(&q->signalled, 1, memory_order_acq_rel) == 0;
+}
+
+/* Any thread.  Splices first..last, already linked through `next`, with a
+   single exchange; the consumer sees them in chain order. */
+static inline bool mpsc_queue_push_chain(mpsc_queue_t *q, mpsc_node_t *first,
+                                         mpsc_node_t *last) {
+    atomic_store_explicit(&last->next, NULL, memory_order_relaxed);
+    mpsc_node_t *prev = atomic_exchange_explicit(&q->head, last, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, first, memory_order_release);
+    return atomic_exchange_explicit(&q->signalled, 1, memory_order_acq_rel) == 0;
+}
+
+/* Consumer: call before popping so later pushes wake us again */
+static inline void mpsc_queue_begin_drain(mpsc_queue_t *q) {
+    atomic_exchange_explicit(&q->signalled, 0, memory_order_acq_rel);
+}
+
+/* Consumer only.  NULL when empty (or a push is still in progress). */
+static inline mpsc_node_t *mpsc_queue_pop(mpsc_queue_t *q) {
+    mpsc_node_t *tail = q->tail;
+    mpsc_node_t *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &q->stub) {
+        if (!next) return NULL;
+        q->tail = tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    if (tail != atomic_load_explicit(&q->head, memory_order_acquire))
+        return NULL;                       /* producer mid-push */
+    mpsc_queue_link(q, &q->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/* Consumer only */
+static inline bool mpsc_queue_empty(mpsc_queue_t *q) {
+    return q->tail == &q->stub &&
+           atomic_load_explicit(&q->stub.next, memory_order_acquire) == NULL;
+}
+
+#endif /* A_CURL_LIBRARY_IMPL_MPSC_QUEUE_H */
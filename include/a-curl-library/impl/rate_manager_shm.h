@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef A_CURL_LIBRARY_IMPL_RATE_MANAGER_SHM_H
+#define A_CURL_LIBRARY_IMPL_RATE_MANAGER_SHM_H
+
+/* Shared-memory backend of the rate manager (rate_manager_use_shared).
+
+   A named POSIX shared-memory segment holds one slot per key: the key's
+   quota state (rate_bucket_t) behind a robust, process-shared mutex, and
+   a table of which processes hold how many concurrency slots, so the
+   slots of a process that died are reclaimed.  Slots are claimed by name
+   and never released; the segment lives until it is unlinked. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Quota state of a key: in the key itself, or in a shared slot */
+typedef struct {
+    bool     configured;            /* set_limit / set_adaptive was called */
+    int      max_concurrent;
+    double   max_rps;
+    int      current_requests;
+    uint64_t hp_waiting_until;      /* normal requests yield the bucket until then */
+    double   tokens;
+    uint64_t last_refill;
+    uint64_t last_success;
+    int      backoff_seconds;
+    uint64_t paused_until;          /* set by a 429 or the server's hints */
+
+    /* what the server advertised (rate_key_apply_hints): a policy rate, and
+       the rate that spreads the remaining quota over the current window */
+    double   policy_rps;
+    double   quota_rps;
+    uint64_t quota_until;
+} rate_bucket_t;
+
+typedef struct rate_shm_s rate_shm_t;
+typedef struct rate_shm_slot_s rate_shm_slot_t;
+
+/* Longest key (including the NUL) a shared slot can hold */
+#define RATE_SHM_NAME_MAX 64
+
+/* Opens the segment, creating it with room for max_keys keys if it does
+   not exist yet.  An existing segment keeps its own size. */
+rate_shm_t *rate_shm_open(const char *name, size_t max_keys);
+void rate_shm_close(rate_shm_t *shm);
+bool rate_shm_unlink(const char *name);
+
+/* The slot for key, claimed if it is new; NULL if the key is too long or
+   the segment is full */
+rate_shm_slot_t *rate_shm_slot(rate_shm_t *shm, const char *key);
+rate_bucket_t *rate_shm_bucket(rate_shm_slot_t *slot);
+
+/* The slot's lock.  A lock left behind by a dead process is recovered. */
+void rate_shm_lock(rate_shm_slot_t *slot);
+void rate_shm_unlock(rate_shm_slot_t *slot);
+
+/* With the lock held: this process took (delta > 0) or gave back
+   (delta < 0) concurrency slots */
+void rate_shm_hold(rate_shm_slot_t *slot, int delta);
+
+/* With the lock held: gives back the slots of processes that no longer
+   exist.  Checks at most once a second, or right after a lock was
+   recovered.  Returns true if any slot was freed. */
+bool rate_shm_reap(rate_shm_slot_t *slot, uint64_t now);
+
+#endif
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef A_CURL_LIBRARY_IMPL_TIMER_WHEEL_H
+#define A_CURL_LIBRARY_IMPL_TIMER_WHEEL_H
+
+/* Hashed hierarchical timer wheel (millisecond ticks).
+
+   Four levels of 256 slots cover 2^8, 2^16, 2^24 and 2^32 ms ahead; later
+   timers sit on an overflow list.  Insert and remove are O(1); advancing
+   cascades one slot per level boundary and skips empty level-0 ranges via
+   a bitmap, so idle time costs nothing.  Nodes are intrusive, so the wheel
+   never allocates.  Not thread-safe: owned by one loop. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_BITS   8
+#define TIMER_WHEEL_SLOTS  (1u << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 4
+
+typedef struct timer_node_s {
+    struct timer_node_s *next;
+    struct timer_node_s *prev;
+    uint64_t expires;              /* absolute tick (ms) */
+} timer_node_t;
+
+typedef struct timer_wheel_s {
+    uint64_t now;                  /* next tick to process */
+    size_t   count;
+    timer_node_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t bitmap[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS / 64];
+    timer_node_t overflow;
+} timer_wheel_t;
+
+/* Circular doubly-linked list helpers (a head is a node linked to itself) */
+static inline void timer_list_init(timer_node_t *head) {
+    head->next = head->prev = head;
+}
+static inline bool timer_list_empty(const timer_node_t *head) {
+    return head->next == head;
+}
+static inline void timer_list_append(timer_node_t *head, timer_node_t *n) {
+    n->prev = head->prev;
+    n->next = head;
+    head->prev->next = n;
+    head->prev = n;
+}
+static inline void timer_list_unlink(timer_node_t *n) {
+    n->prev->next = n->next;
+    n->next->prev = n->prev;
+    n->next = n->prev = NULL;
+}
+static inline bool timer_node_linked(const timer_node_t *n) {
+    return n->next != NULL;
+}
+
+void     timer_wheel_init(timer_wheel_t *w, uint64_t now_ms);
+
+/* expires_ms in the past fires on the next advance. n must not be linked. */
+void     timer_wheel_insert(timer_wheel_t *w, timer_node_t *n, uint64_t expires_ms);
+void     timer_wheel_remove(timer_wheel_t *w, timer_node_t *n);
+
+/* Move every timer with expires <= now_ms onto the tail of `expired`
+   (a list head), in expiry order.  Returns the number moved. */
+size_t   timer_wheel_advance(timer_wheel_t *w, uint64_t now_ms, timer_node_t *expired);
+
+/* Lower bound on the earliest expiry (exact within 256 ms), or UINT64_MAX
+   when empty.  Sleeping until then is always safe. */
+uint64_t timer_wheel_next_expiry(const timer_wheel_t *w);
+
+/* Move every timer onto `out` regardless of expiry (teardown). */
+size_t   timer_wheel_drain(timer_wheel_t *w, timer_node_t *out);
+
+static inline size_t timer_wheel_count(const timer_wheel_t *w) { return w->count; }
+
+#endif /* A_CURL_LIBRARY_IMPL_TIMER_WHEEL_H */
@@ -6,6 +6,7 @@
 #define RATE_MANAGER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* TODO: Consider adding a cost function which is based upon request/response data */
@@ -16,17 +17,124 @@
  */
 void rate_manager_init(void);
 
+/* Keys a shared segment holds unless rate_manager_use_shared says otherwise */
+#define RATE_MANAGER_SHARED_KEYS 1024
+
+/**
+ * Keeps every key's token bucket, concurrency count and 429 pause in the
+ * named POSIX shared-memory segment `name` (created if needed, with room for
+ * `max_keys` keys; 0 means RATE_MANAGER_SHARED_KEYS), so all processes on
+ * the host that use the same name draw from one quota.  Call it once per
+ * process, before any key is used.  Keys longer than 63 bytes, or beyond
+ * max_keys, keep a per-process limit.
+ *
+ * Concurrency slots held by a process that died are reclaimed when a key
+ * runs out of them.  Requests waiting on a shared key poll instead of
+ * queueing, since a slot freed in another process cannot wake them.
+ * The adaptive limit of rate_manager_set_adaptive stays per process.
+ */
+bool rate_manager_use_shared(const char *name, size_t max_keys);
+
+/* Removes the segment; processes that have it open keep using it.  Also
+   clears a segment whose creator died before initializing it, which
+   rate_manager_use_shared otherwise times out on. */
+bool rate_manager_unlink_shared(const char *name);
+
+/**
+ * An interned key.  Resolve a key once with rate_manager_key and use the
+ * rate_key_* calls on the hot path: they lock only that key, never the
+ * table, and do no string hashing or comparison.
+ */
+typedef struct rate_key_s rate_key_t;
+
+/**
+ * Returns the handle for `key`, creating it (without a limit) if needed.
+ * The handle stays valid until rate_manager_destroy.  A key with no limit
+ * set lets every request through until rate_manager_set_limit is called.
+ */
+rate_key_t *rate_manager_key(const char *key);
+
+/* The interned name; valid as long as the handle */
+const char *rate_key_name(const rate_key_t *key);
+
+/* Deepest nesting of keys (rate_manager_set_parent), counting the key itself */
+#define RATE_MANAGER_MAX_DEPTH 8
+
+/**
+ * Nests `key` under `parent` (NULL detaches it), so quotas can be layered:
+ * an account key, a per-model key below it, a per-endpoint key below that.
+ * A request on a key is admitted only when the key and every ancestor
+ * have a free slot and a token, and then takes one of each, all at once.
+ * The request waits on whichever level would hold it back longest.
+ *
+ * A 429 pauses the key the request named; its ancestors only get their
+ * slots back.  Build the tree before requests use its keys.  Returns false
+ * if `parent` is below `key` or the tree would be too deep.
+ */
+bool rate_manager_set_parent(const char *key, const char *parent);
+
+typedef struct {
+    int      in_flight;      /* slots taken, across all of its children   */
+    int      max_concurrent; /* current limit (adaptive or fixed); 0 none */
+    double   rps;            /* effective rate, after server hints; 0 none */
+    double   tokens;
+    uint64_t paused_ns;      /* left of a 429 or Retry-After pause         */
+    uint64_t limiting;       /* times this key was what made a request wait */
+} rate_manager_stats_t;
+
+/**
+ * Copies a key's state.  `limiting` shows which level of a tree is the
+ * bottleneck.  Returns false if the key has no limit.
+ */
+bool rate_manager_get_stats(const char *key, rate_manager_stats_t *out);
+
 /**
  * Sets the rate limit for a given key (like a URL or API key).
  * If the key doesn’t exist, it will be created.
  *
- * - `max_concurrent` is the maximum number of requests allowed to run at the same time.
+ * - `max_concurrent` is the maximum number of requests allowed to run at the same time
+ *   (0 means no limit).
  * - `max_rps` is the maximum number of requests per second.  Fractional values are allowed.
  */
 void rate_manager_set_limit(const char *key, int max_concurrent, double max_rps);
 
 /**
- * Checks if a request **could** proceed under the rate limit.
+ * Lets the concurrency limit for a key follow the upstream instead of a
+ * hand-tuned `max_concurrent`.  The limit starts at `min_concurrent` and
+ * grows by about one per round trip while latency stays near the lowest
+ * RTT seen in the last 30 seconds.  It is halved on an overloaded response
+ * and cut by 10% when the RTT is more than double that baseline, but never
+ * below `min_concurrent` or above `max_concurrent`.  `max_rps` works as in
+ * rate_manager_set_limit; 0 means no rate limit.  rate_manager_set_limit
+ * turns adaptation off again.
+ */
+void rate_manager_set_adaptive(const char *key, int min_concurrent,
+                               int max_concurrent, double max_rps);
+
+/**
+ * Feeds one finished request to an adaptive key: its latency, and whether
+ * the upstream pushed back (429, 5xx or a timeout).  The event loop calls
+ * this for every attempt that held a slot; it is a no-op for other keys.
+ */
+void rate_manager_request_sample(const char *key, uint64_t latency_ns, bool overloaded);
+
+typedef struct {
+    int      limit;          /* current concurrency limit                 */
+    int      in_flight;      /* requests started and not yet done         */
+    uint64_t rtt_min_ns;     /* baseline RTT                              */
+    uint64_t rtt_ns;         /* smoothed recent RTT                       */
+    double   gradient;       /* rtt_min / rtt: 1.0 means no queueing      */
+} rate_manager_adaptive_t;
+
+/**
+ * Copies the adaptive state of a key.  Returns false if the key is not
+ * adaptive.
+ */
+bool rate_manager_get_adaptive(const char *key, rate_manager_adaptive_t *out);
+
+/**
+ * Checks if a request **could** proceed under the rate limit (and, for an
+ * adaptive key, its concurrency limit).
  * This does not actually count the request, it just checks.
  *
  * Returns 0 if the request can proceed, otherwise it returns the number of **nanoseconds** to wait.
@@ -37,23 +145,130 @@ uint64_t rate_manager_can_proceed(const char *key, bool high_priority);
  * Starts a request, assuming it will proceed.
  * This actually **counts** the request against the rate limit.
  *
- * Returns `true` if the request is allowed, `false` if it should be delayed.
+ * Returns 0 if the request was counted, otherwise the number of **nanoseconds**
+ * to wait before trying again.  At the concurrency limit this is only a
+ * polling hint; rate_manager_acquire queues instead.
  */
 uint64_t rate_manager_start_request(const char *key, bool high_priority);
 
 /**
- * Marks a request as complete, freeing up space in the concurrent limit.
+ * A request waiting for a concurrency slot.  The caller owns it (typically
+ * embedded in the request); the links belong to the rate manager.
+ *
+ * `on_wake` runs once, with the rate manager's lock held, when the waiter
+ * leaves the queue.  `granted == true` hands over a slot that is already
+ * counted: release it with rate_manager_request_done or _handle_429.
+ * `granted == false` means the caller should acquire again: the key backed
+ * off after a 429, or (for a nested key) a slot freed up on the level it
+ * waited on.  In the nested case that slot stays reserved for the waiter
+ * (reserved_on) until its next acquire with the same waiter; a caller
+ * that will not acquire again must call rate_manager_release_reservation.
+ * on_wake must not call back into the rate manager.
+ */
+typedef struct rate_manager_waiter_s rate_manager_waiter_t;
+struct rate_manager_waiter_s {
+    rate_manager_waiter_t *prev;
+    rate_manager_waiter_t *next;
+    bool high_priority;
+    bool queued;
+    bool chain;                 /* needs ancestors too: woken to retry   */
+    rate_key_t *queued_on;      /* the level it waits on                 */
+    rate_key_t *limited_by;     /* level that made the last acquire wait */
+    rate_key_t *reserved_on;    /* woken chain waiter: slot held for it  */
+    void (*on_wake)(rate_manager_waiter_t *waiter, bool granted);
+};
+
+/* rate_manager_acquire queued the waiter */
+#define RATE_MANAGER_QUEUED UINT64_MAX
+
+/**
+ * Like rate_manager_start_request, but at the concurrency limit `waiter` is
+ * queued (FIFO, high priority first) and RATE_MANAGER_QUEUED is returned.
+ * Each freed slot goes straight to the head of the queue, so waiters do
+ * not poll.  A NULL waiter behaves like rate_manager_start_request.
+ */
+uint64_t rate_manager_acquire(const char *key, bool high_priority,
+                              rate_manager_waiter_t *waiter);
+
+/**
+ * Removes a queued waiter.  Returns false if it already left the queue:
+ * its on_wake has run, and any slot it was granted is the caller's.
+ */
+bool rate_manager_cancel_wait(const char *key, rate_manager_waiter_t *waiter);
+
+/**
+ * Gives back the slot reserved for a woken nested-key waiter that will not
+ * acquire again (cancelled, expired, or giving up), and hands it to the
+ * next waiter on that level.  A no-op if the waiter holds no reservation.
+ */
+void rate_manager_release_reservation(rate_manager_waiter_t *waiter);
+
+/**
+ * Marks a request as complete, freeing up space in the concurrent limit,
+ * and hands the slot to the next waiter.
  * This also resets the backoff timer since the request was successful.
  */
 void rate_manager_request_done(const char *key);
 
+/**
+ * What a response said about a key's quota.  Fill it with
+ * rate_manager_parse_header, one header line at a time.
+ */
+typedef struct {
+    int64_t retry_after_ns;  /* Retry-After (seconds or HTTP-date); -1 if absent    */
+    long    remaining;       /* requests left in the window; -1 if absent          */
+    int64_t reset_ns;        /* until the window resets; -1 if absent              */
+    long    quota;           /* requests per window; -1 if absent                  */
+    int64_t window_ns;       /* window of the quota; -1 if absent                  */
+} rate_manager_hints_t;
+
+/* Marks every hint absent; call again for each new response */
+void rate_manager_hints_init(rate_manager_hints_t *hints);
+
+/**
+ * Picks up Retry-After, X-RateLimit-Remaining / -Reset / -Limit, and the
+ * RateLimit-Remaining / -Reset / -Limit / -Policy and RateLimit fields of
+ * the IETF drafts from one "Name: value" line.  A reset that is too large
+ * to be a delay is read as a Unix time.  Returns false for other headers.
+ */
+bool rate_manager_parse_header(rate_manager_hints_t *hints, const char *line);
+
 /**
  * Handles a `429 Too Many Requests` response by increasing the backoff time.
  * This function returns how many **seconds** to wait before retrying.
  * The backoff will increase exponentially but will reset if enough time has passed.
+ * The request's slot is freed, but the key is paused for the backoff: new
+ * requests are told to wait it out, and queued waiters are woken to do the same.
  */
 int rate_manager_handle_429(const char *key);
 
+/*
+ * The same calls on an interned key.  The string versions above look the
+ * key up on every call and are kept for configuration and existing callers.
+ * A NULL key behaves like a key with no limit.
+ */
+uint64_t rate_key_can_proceed(rate_key_t *key, bool high_priority);
+uint64_t rate_key_acquire(rate_key_t *key, bool high_priority,
+                          rate_manager_waiter_t *waiter);
+bool rate_key_cancel_wait(rate_key_t *key, rate_manager_waiter_t *waiter);
+void rate_key_request_done(rate_key_t *key);
+void rate_key_request_sample(rate_key_t *key, uint64_t latency_ns, bool overloaded);
+
+/**
+ * Like rate_manager_handle_429, but when the response said when to come
+ * back (Retry-After, or no quota left until the reset) the key pauses for
+ * exactly that long instead of its own doubling backoff.  `hints` may be NULL.
+ */
+int rate_key_handle_429(rate_key_t *key, const rate_manager_hints_t *hints);
+
+/**
+ * Feeds any other response's hints to the key.  A quota policy caps the
+ * key's rate at quota / window; the remaining quota is spread over the
+ * time to the reset; and Retry-After, or a quota of zero, pauses the key.
+ * All of these only ever lower the rate set by rate_manager_set_limit.
+ */
+void rate_key_apply_hints(rate_key_t *key, const rate_manager_hints_t *hints);
+
 /**
  * Frees all memory associated with the rate manager.
  */
@@ -0,0 +1,487 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/* HTTP response cache (a private, single-client cache in RFC
+   9111 terms).  Entries are keyed like coalescing flights: method, URL
+   and the request headers that select a representation.  A request pins
+   the entry it is served or revalidated from, so eviction only unlinks
+   an entry and the last unpin frees it.  With a disk tier
+   (curl_event_disk_cache.c) responses are written to both; a memory
+   miss falls through to disk.  Everything here runs on the loop
+   thread. */
+
+static inline int compare_entry(const cache_entry_t *a, const cache_entry_t *b) {
+    return strcmp(a->key, b->key);
+}
+static inline int compare_entry_string(const char *a, const cache_entry_t *b) {
+    return strcmp(a, b->key);
+}
+static inline
+macro_map_insert(entry_insert, cache_entry_t, compare_entry);
+static inline
+macro_map_find_kv(entry_find, char, cache_entry_t, compare_entry_string);
+
+static inline cache_entry_t *entry_from_lru(timer_node_t *n) {
+    return (cache_entry_t *)((char *)n - offsetof(cache_entry_t, lru));
+}
+
+static size_t entry_charge(const cache_entry_t *e) {
+    return sizeof(*e) + strlen(e->key) + 1 + e->len +
+           (e->etag ? strlen(e->etag) + 1 : 0) +
+           (e->last_modified ? strlen(e->last_modified) + 1 : 0);
+}
+
+static void entry_unref(cache_entry_t *e) {
+    if (--e->refcnt > 0) return;
+    curl_event_disk_segment_release(e->segment);
+    aml_free(e->etag);
+    aml_free(e->last_modified);
+    aml_free(e);
+}
+
+static void entry_remove(curl_event_cache_t *c, cache_entry_t *e) {
+    macro_map_erase(&c->entries, &e->node);
+    timer_list_unlink(&e->lru);
+    c->bytes -= e->charge;
+    e->in_map = false;
+    entry_unref(e);
+}
+
+/* Evict least recently used entries until `room` more bytes fit */
+static void cache_trim(curl_event_loop_t *loop, size_t room) {
+    curl_event_cache_t *c = loop->cache;
+    while (c->bytes + room > c->max_bytes && !timer_list_empty(&c->lru)) {
+        entry_remove(c, entry_from_lru(c->lru.next));
+        loop->metrics.cache_evictions++;
+    }
+}
+
+static curl_event_cache_t *cache_get(curl_event_loop_t *loop) {
+    if (!loop->cache) {
+        curl_event_cache_t *c = (curl_event_cache_t *)aml_calloc(1, sizeof(*c));
+        if (!c) {
+            fprintf(stderr, "[curl_event_cache] Memory allocation failed.\n");
+            return NULL;
+        }
+        c->entries = NULL;
+        c->max_bytes = 0;
+        c->disk = NULL;
+        timer_list_init(&c->lru);
+        loop->cache = c;
+    }
+    return loop->cache;
+}
+
+/* Neither tier left: requests stop consulting the cache */
+static void cache_put_back(curl_event_loop_t *loop) {
+    curl_event_cache_t *c = loop->cache;
+    if (c && !c->max_bytes && !c->disk) {
+        aml_free(c);
+        loop->cache = NULL;
+    }
+}
+
+bool curl_event_loop_set_cache(curl_event_loop_t *loop, size_t max_bytes) {
+    if (!loop) return false;
+    curl_event_cache_t *c = max_bytes ? cache_get(loop) : loop->cache;
+    if (!c) return max_bytes == 0;
+    c->max_bytes = max_bytes;
+    cache_trim(loop, 0);
+    cache_put_back(loop);
+    return true;
+}
+
+bool curl_event_loop_set_disk_cache(curl_event_loop_t *loop, const char *dir,
+                                    size_t max_bytes) {
+    if (!loop) return false;
+    if (loop->cache && loop->cache->disk) {
+        curl_event_disk_cache_close(loop->cache->disk);
+        loop->cache->disk = NULL;
+    }
+    if (!dir || !max_bytes) {
+        cache_put_back(loop);
+        return true;
+    }
+    curl_event_disk_cache_t *d = curl_event_disk_cache_open(dir, max_bytes);
+    curl_event_cache_t *c = d ? cache_get(loop) : NULL;
+    if (!c) {
+        curl_event_disk_cache_close(d);
+        cache_put_back(loop);
+        return false;
+    }
+    c->disk = d;
+    return true;
+}
+
+void curl_event_cache_destroy(curl_event_loop_t *loop) {
+    curl_event_cache_t *c = loop->cache;
+    if (!c) return;
+    while (!timer_list_empty(&c->lru))
+        entry_remove(c, entry_from_lru(c->lru.next));
+    curl_event_disk_cache_close(c->disk);
+    aml_free(c);
+    loop->cache = NULL;
+}
+
+/* ────────────────────────────────────────────────────────────────────
+   Header parsing
+   ──────────────────────────────────────────────────────────────────── */
+
+/* Value of request header `name`, or NULL */
+static const char *request_header(const curl_event_request_t *r, const char *name) {
+    size_t n = strlen(name);
+    for (struct curl_slist *h = r->headers; h; h = h->next)
+        if (strncasecmp(h->data, name, n) == 0 && h->data[n] == ':')
+            return h->data + n + 1;
+    return NULL;
+}
+
+/* Looks for directive `name` in a Cache-Control value; a numeric
+   argument goes to *arg (-1 if missing or not a number). */
+static bool directive(const char *v, const char *name, long *arg) {
+    size_t n = strlen(name);
+    while (*v) {
+        while (*v == ',' || isspace((unsigned char)*v)) v++;
+        const char *tok = v;
+        while (*v && *v != ',' && *v != '=') v++;
+        size_t len = (size_t)(v - tok);
+        while (len && isspace((unsigned char)tok[len - 1])) len--;
+
+        const char *val = NULL;
+        if (*v == '=') {
+            val = ++v;
+            if (*v == '"') {
+                for (v++; *v && *v != '"'; v++) ;
+                if (*v) v++;
+            }
+            while (*v && *v != ',') v++;
+        }
+        if (len == n && strncasecmp(tok, name, n) == 0) {
+            if (arg) {
+                if (val && *val == '"') val++;
+                *arg = (val && isdigit((unsigned char)*val)) ? strtol(val, NULL, 10) : -1;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void meta_reset(cache_meta_t *m) {
+    memset(m, 0, sizeof(*m));
+    m->max_age = -1;
+    m->date    = -1;
+    m->expires = -1;
+}
+
+static bool header_is(const char *line, size_t n, const char *name) {
+    return strlen(name) == n && strncasecmp(line, name, n) == 0;
+}
+
+void curl_event_cache_header(curl_event_loop_request_t *req, cache_meta_t *m,
+                             const char *line) {
+    if (strncmp(line, "HTTP/", 5) == 0) {
+        meta_reset(m);                  /* a new response (redirect, 100) */
+        return;
+    }
+    const char *colon = strchr(line, ':');
+    if (!colon) return;
+    size_t n = (size_t)(colon - line);
+    const char *v = colon + 1;
+    while (isspace((unsigned char)*v)) v++;
+
+    if (header_is(line, n, "Cache-Control")) {
+        long arg;
+        if (directive(v, "no-store", NULL)) m->no_store = true;
+        if (directive(v, "no-cache", NULL)) m->no_cache = true;
+        if (directive(v, "max-age", &arg))  m->max_age  = arg < 0 ? 0 : arg;
+    } else if (header_is(line, n, "Expires")) {
+        time_t t = curl_getdate(v, NULL);
+        m->expires = t == -1 ? 0 : t;   /* invalid means already expired */
+    } else if (header_is(line, n, "Date")) {
+        m->date = curl_getdate(v, NULL);
+    } else if (header_is(line, n, "Age")) {
+        long age = strtol(v, NULL, 10);
+        m->age = age > 0 ? age : 0;
+    } else if (header_is(line, n, "ETag")) {
+        m->etag = aml_pool_strdup(req->request.pool, v);
+    } else if (header_is(line, n, "Last-Modified")) {
+        m->last_modified = aml_pool_strdup(req->request.pool, v);
+    } else if (header_is(line, n, "Vary")) {
+        while (*v) {
+            while (*v == ',' || isspace((unsigned char)*v)) v++;
+            const char *tok = v;
+            while (*v && *v != ',' && !isspace((unsigned char)*v)) v++;
+            size_t len = (size_t)(v - tok);
+            if (len && !curl_event_is_variant_header(tok, len))
+                m->vary_unkeyed = true;   /* includes "*" */
+        }
+    }
+}
+
+/* Wall-clock expiry for the disk tier; 0 if stale */
+static time_t to_expires(uint64_t fresh_until, uint64_t now) {
+    if (fresh_until <= now) return 0;
+    return time(NULL) + (time_t)((fresh_until - now) / 1000000000ull);
+}
+
+/* Largest body either tier would keep */
+static size_t max_entry(const curl_event_cache_t *c) {
+    size_t n = c->max_bytes;
+    if (c->disk && curl_event_disk_cache_max_entry(c->disk) > n)
+        n = curl_event_disk_cache_max_entry(c->disk);
+    return n;
+}
+
+/* Freshness deadline in macro_now() ns; 0 if stale on arrival */
+static uint64_t fresh_until(const cache_meta_t *m, uint64_t now) {
+    if (m->no_cache) return 0;
+    long lifetime = -1;
+    if (m->max_age >= 0) {
+        lifetime = m->max_age;
+    } else if (m->expires != -1) {
+        time_t base = m->date != -1 ? m->date : time(NULL);
+        lifetime = m->expires > base ? (long)(m->expires - base) : 0;
+    }
+    if (lifetime <= m->age) return 0;
+    return now + (uint64_t)(lifetime - m->age) * 1000000000ull;
+}
+
+/* ────────────────────────────────────────────────────────────────────
+   Lookup and revalidation
+   ──────────────────────────────────────────────────────────────────── */
+
+static bool cacheable(const curl_event_request_t *r) {
+    if (r->method ? strcasecmp(r->method, "GET") != 0 : (r->post_data || r->json_root))
+        return false;
+    /* the caller validates on its own and expects to see the 304 */
+    if (request_header(r, "If-None-Match") || request_header(r, "If-Modified-Since"))
+        return false;
+    const char *cc = request_header(r, "Cache-Control");
+    return !(cc && directive(cc, "no-store", NULL));
+}
+
+static bool must_revalidate(const curl_event_request_t *r) {
+    const char *cc = request_header(r, "Cache-Control");
+    long arg = -1;
+    return cc && (directive(cc, "no-cache", NULL) ||
+                  (directive(cc, "max-age", &arg) && arg == 0));
+}
+
+bool curl_event_cache_lookup(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    curl_event_cache_release(req);
+    if (!loop->cache || !cacheable(&req->request)) return false;
+    req->cache_capture = true;
+
+    curl_event_cache_t *c = loop->cache;
+    const char *key = curl_event_request_variant_key(req);
+    cache_entry_t *e = entry_find(c->entries, key);
+    if (e) {
+        e->refcnt++;
+        timer_list_unlink(&e->lru);
+        timer_list_append(&c->lru, &e->lru);
+    } else if (!c->disk || !(e = curl_event_disk_cache_get(c->disk, key))) {
+        return false;
+    }
+    bool fresh = e->fresh_until > macro_now() && !must_revalidate(&req->request);
+    if (!fresh && !e->etag && !e->last_modified) {
+        /* stale and cannot be revalidated */
+        if (c->disk) curl_event_disk_cache_remove(c->disk, key);
+        if (e->in_map) entry_remove(c, e);
+        entry_unref(e);
+        return false;
+    }
+    req->cache_entry = e;
+    if (!fresh) return false;
+
+    loop->metrics.cache_hits++;
+    if (e->segment) loop->metrics.cache_disk_hits++;
+    req->cache_capture = false;
+    timer_list_append(&loop->cache_ready, &req->timer);
+    req->where = REQ_WHERE_CACHED;
+    return true;
+}
+
+void curl_event_cache_prepare(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    if (!req->cache_capture) return;
+    meta_reset(&req->response.cache_meta);
+    cache_entry_t *e = req->cache_entry;
+    if (!e) {
+        loop->metrics.cache_misses++;
+        return;
+    }
+    loop->metrics.cache_revalidations++;
+
+    /* the caller's headers plus validators, for this attempt only */
+    struct curl_slist *list = NULL, *next;
+    for (struct curl_slist *h = req->request.headers; h; h = h->next) {
+        if (!(next = curl_slist_append(list, h->data))) goto fail;
+        list = next;
+    }
+    if (e->etag) {
+        char *line = aml_pool_strdupf(req->request.pool, "If-None-Match: %s", e->etag);
+        if (!(next = curl_slist_append(list, line))) goto fail;
+        list = next;
+    }
+    if (e->last_modified) {
+        char *line = aml_pool_strdupf(req->request.pool, "If-Modified-Since: %s",
+                                      e->last_modified);
+        if (!(next = curl_slist_append(list, line))) goto fail;
+        list = next;
+    }
+    req->cache_headers = list;
+    return;
+
+fail:
+    /* send it unconditionally; a 200 replaces the entry */
+    curl_slist_free_all(list);
+    entry_unref(e);
+    req->cache_entry = NULL;
+}
+
+void curl_event_cache_capture(curl_event_loop_request_t *req, const void *data, size_t len) {
+    if (!req->cache_capture) return;
+    curl_event_cache_t *c = req->request.loop->cache;
+    size_t have = req->cache_body ? aml_buffer_length(req->cache_body) : 0;
+    if (!c || req->response.cache_meta.no_store || have + len > max_entry(c)) {
+        /* cannot be stored; stop copying */
+        req->cache_capture = false;
+        if (req->cache_body) {
+            aml_buffer_destroy(req->cache_body);
+            req->cache_body = NULL;
+        }
+        return;
+    }
+    if (!req->cache_body) {
+        size_t hint = (req->response.content_length_found && req->response.content_length > 0)
+                    ? (size_t)req->response.content_length : 1024;
+        req->cache_body = aml_buffer_init(hint);
+    }
+    aml_buffer_append(req->cache_body, data, len);
+}
+
+/* ────────────────────────────────────────────────────────────────────
+   Storing responses
+   ──────────────────────────────────────────────────────────────────── */
+
+static char *replace_string(char *old, const char *value) {
+    if (!value) return old;
+    aml_free(old);
+    return aml_strdup(value);
+}
+
+static void store(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    curl_event_cache_t *c = loop->cache;
+    const cache_meta_t *m = &req->response.cache_meta;
+    if (m->no_store || m->vary_unkeyed) return;
+    uint64_t now = macro_now();
+    uint64_t fresh = fresh_until(m, now);
+    if (!fresh && !m->etag && !m->last_modified)
+        return;                         /* nothing to reuse it with */
+
+    const char *key = curl_event_request_variant_key(req);
+    size_t klen = strlen(key) + 1;
+    size_t len = req->cache_body ? aml_buffer_length(req->cache_body) : 0;
+    if (c->disk)
+        curl_event_disk_cache_put(c->disk, key, m->etag, m->last_modified,
+                                  to_expires(fresh, now),
+                                  len ? aml_buffer_data(req->cache_body) : NULL, len);
+    cache_entry_t *old = entry_find(c->entries, key);
+    if (old) entry_remove(c, old);
+    if (!c->max_bytes) return;
+
+    cache_entry_t *e = (cache_entry_t *)aml_malloc(sizeof(*e) + klen + len);
+    if (!e) return;
+    char *p = (char *)(e + 1);
+    memcpy(p, key, klen);
+    if (len) memcpy(p + klen, aml_buffer_data(req->cache_body), len);
+    e->key = p;
+    e->body = p + klen;
+    e->segment = NULL;
+    e->len = len;
+    e->etag = m->etag ? aml_strdup(m->etag) : NULL;
+    e->last_modified = m->last_modified ? aml_strdup(m->last_modified) : NULL;
+    e->fresh_until = fresh;
+    e->charge = entry_charge(e);
+    e->refcnt = 1;
+    if (e->charge > c->max_bytes) {
+        entry_unref(e);
+        return;
+    }
+    cache_trim(loop, e->charge);
+    e->in_map = true;
+    entry_insert(&c->entries, e);
+    timer_list_append(&c->lru, &e->lru);
+    c->bytes += e->charge;
+}
+
+/* A 304 carries the entry's new freshness and, possibly, validators */
+static void refresh(curl_event_loop_t *loop, cache_entry_t *e, const cache_meta_t *m) {
+    curl_event_cache_t *c = loop->cache;
+    if (m->no_store) {
+        if (c && c->disk) curl_event_disk_cache_remove(c->disk, e->key);
+        if (e->in_map) entry_remove(c, e);
+        return;
+    }
+    uint64_t now = macro_now();
+    e->fresh_until = fresh_until(m, now);
+    e->etag = replace_string(e->etag, m->etag);
+    e->last_modified = replace_string(e->last_modified, m->last_modified);
+    if (c && c->disk)
+        curl_event_disk_cache_refresh(c->disk, e->key, e->etag, e->last_modified,
+                                      to_expires(e->fresh_until, now));
+    if (e->in_map) {
+        loop->cache->bytes -= e->charge;
+        e->charge = entry_charge(e);
+        loop->cache->bytes += e->charge;
+    }
+}
+
+CURLcode curl_event_cache_deliver(curl_event_loop_request_t *req) {
+    cache_entry_t *e = req->cache_entry;
+    req->response.content_length       = (long)e->len;
+    req->response.content_length_found = true;
+    if (e->len && curl_event_loop_request_deliver(req, e->body, e->len) != e->len)
+        return CURLE_WRITE_ERROR;
+    return CURLE_OK;
+}
+
+long curl_event_cache_complete(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                               CURLcode *result, long http_code) {
+    if (*result != CURLE_OK) return http_code;
+    if (http_code == 304 && req->cache_entry) {
+        if (req->cache_capture) refresh(loop, req->cache_entry, &req->response.cache_meta);
+        req->cache_capture = false;
+        loop->metrics.cache_hits++;
+        *result = curl_event_cache_deliver(req);
+        return *result == CURLE_OK ? 200 : http_code;
+    }
+    if (http_code == 200 && req->cache_capture && loop->cache)
+        store(loop, req);
+    return http_code;
+}
+
+void curl_event_cache_release(curl_event_loop_request_t *req) {
+    if (req->cache_entry) {
+        entry_unref(req->cache_entry);
+        req->cache_entry = NULL;
+    }
+    if (req->cache_headers) {
+        curl_slist_free_all(req->cache_headers);
+        req->cache_headers = NULL;
+    }
+    if (req->cache_body) {
+        aml_buffer_destroy(req->cache_body);
+        req->cache_body = NULL;
+    }
+    req->cache_capture = false;
+}
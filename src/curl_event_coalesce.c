@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+/* In-flight coalescing (singleflight).  A started GET with a coalescing
+   key becomes the leader for that key; requests with the same key that
+   come due before the leader delivers its first body byte attach to it
+   as followers instead of opening their own transfer.  Everything here
+   runs on the loop thread. */
+
+static inline int compare_flight(const coalesce_flight_t *a, const coalesce_flight_t *b) {
+    return strcmp(a->key, b->key);
+}
+static inline int compare_flight_string(const char *a, const coalesce_flight_t *b) {
+    return strcmp(a, b->key);
+}
+static inline
+macro_map_insert(flight_insert, coalesce_flight_t, compare_flight);
+static inline
+macro_map_find_kv(flight_find, char, coalesce_flight_t, compare_flight_string);
+
+/* Request headers that select a different representation */
+static const char *const key_headers[] = {
+    "Accept", "Accept-Encoding", "Accept-Language", "Authorization", "Cookie", "Range"
+};
+
+static bool is_key_header(const char *line) {
+    for (size_t i = 0; i < sizeof(key_headers) / sizeof(key_headers[0]); i++) {
+        size_t n = strlen(key_headers[i]);
+        if (strncasecmp(line, key_headers[i], n) == 0 && line[n] == ':')
+            return true;
+    }
+    return false;
+}
+
+bool curl_event_is_variant_header(const char *name, size_t len) {
+    for (size_t i = 0; i < sizeof(key_headers) / sizeof(key_headers[0]); i++)
+        if (strlen(key_headers[i]) == len && strncasecmp(name, key_headers[i], len) == 0)
+            return true;
+    return false;
+}
+
+const char *curl_event_request_variant_key(curl_event_loop_request_t *req) {
+    if (req->variant_key) return req->variant_key;
+    curl_event_request_t *r = &req->request;
+    char *key = aml_pool_strdupf(r->pool, "%s %s", r->method ? r->method : "GET", r->url);
+    for (struct curl_slist *h = r->headers; h; h = h->next)
+        if (is_key_header(h->data))
+            key = aml_pool_strdupf(r->pool, "%s\n%s", key, h->data);
+    return req->variant_key = key;
+}
+
+static const char *coalesce_key(curl_event_loop_request_t *req) {
+    if (req->request.coalesce_key) return req->request.coalesce_key;
+    return curl_event_request_variant_key(req);
+}
+
+static bool coalescable(const curl_event_request_t *r) {
+    if (!r->coalesce || r->dep_head) return false;
+    if (r->method) return strcasecmp(r->method, "GET") == 0;
+    return !r->post_data && !r->json_root;
+}
+
+bool curl_event_coalesce_follow(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    if (!loop->inflight || !coalescable(&req->request)) return false;
+    coalesce_flight_t *f = flight_find(loop->inflight, coalesce_key(req));
+    if (!f) return false;
+    curl_event_loop_request_t *leader = f->leader;
+    if (leader->bytes_downloaded || leader->hedge_winner)
+        return false;                   /* already streaming: too late */
+
+    timer_list_append(&f->followers, &req->timer);
+    req->flight = f;
+    req->where = REQ_WHERE_FOLLOWER;
+    f->num_followers++;
+    loop->metrics.coalesced_requests++;
+    return true;
+}
+
+void curl_event_coalesce_lead(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    if (!coalescable(&req->request)) return;
+    const char *key = coalesce_key(req);
+    if (flight_find(loop->inflight, key)) return;   /* a streaming leader exists */
+
+    coalesce_flight_t *f = req->flight;
+    if (!f) {
+        f = (coalesce_flight_t *)aml_pool_zalloc(req->request.pool, sizeof(*f));
+        timer_list_init(&f->followers);
+        req->flight = f;
+    }
+    f->key = key;
+    f->leader = req;
+    f->in_map = true;
+    flight_insert(&loop->inflight, f);
+}
+
+void curl_event_coalesce_forget(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    coalesce_flight_t *f = req->flight;
+    if (!f || f->leader != req || !f->in_map) return;
+    macro_map_erase(&loop->inflight, &f->node);
+    f->in_map = false;
+}
+
+curl_event_loop_request_t *curl_event_coalesce_pop_follower(curl_event_loop_request_t *leader) {
+    coalesce_flight_t *f = leader->flight;
+    if (!f || f->leader != leader || timer_list_empty(&f->followers)) return NULL;
+    curl_event_loop_request_t *req = curl_wrap_from_timer(f->followers.next);
+    curl_event_coalesce_unfollow(req);
+    return req;
+}
+
+void curl_event_coalesce_unfollow(curl_event_loop_request_t *req) {
+    timer_list_unlink(&req->timer);
+    req->flight->num_followers--;
+    req->flight = NULL;
+    req->where = REQ_WHERE_NONE;
+}
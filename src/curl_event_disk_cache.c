@@ -0,0 +1,499 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* Disk tier of the response cache.
+
+   <dir>/index          header + open-addressing hash table, mmapped
+   <dir>/seg-NNNNNNNN   append-only segment files of records
+
+   A slot holds a key hash, where its record lives and the record's
+   expiry; the record holds the key (checked on every hit), validators
+   and body.  Segments are mapped once at a fixed size so records can be
+   handed to sinks in place while later appends land behind them.  When
+   the segments outgrow the budget the oldest one is deleted with every
+   slot pointing into it; an entry read from the oldest segment is first
+   copied to the active one, so recently used entries survive (LRU by
+   re-insertion).  The index is only ever looked up, never rebuilt: a
+   slot whose record is missing or does not match is treated as a miss.
+   Loop thread only; one loop per directory (flock). */
+
+#define DISK_MAGIC    0x31434445u   /* "EDC1" */
+#define DISK_VERSION  1u
+#define RECORD_MAGIC  0x52434445u   /* "EDCR" */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t nslots;                /* power of two                        */
+    uint64_t count;                 /* occupied slots                      */
+    uint32_t first_segment;         /* oldest live segment                 */
+    uint32_t active_segment;        /* appended to                         */
+} disk_header_t;
+
+typedef struct {
+    uint64_t hash;                  /* 0 = empty                           */
+    uint64_t offset;                /* record offset in its segment        */
+    uint32_t segment;
+    uint32_t length;                /* whole record, padded                */
+    int64_t  expires;               /* wall-clock seconds; 0 = stale       */
+} disk_slot_t;
+
+/* followed by key, etag and last_modified (each NUL-terminated, length
+   0 if absent) and the body */
+typedef struct {
+    uint32_t magic;
+    uint32_t key_len;
+    uint32_t etag_len;
+    uint32_t lm_len;
+    uint64_t body_len;
+} disk_record_t;
+
+struct disk_segment_s {
+    uint32_t id;
+    int      fd;                    /* open while active                   */
+    char    *map;                   /* map_len bytes, size of them written */
+    size_t   map_len;
+    size_t   size;
+    int      refcnt;                /* the disk cache + pinned entries     */
+};
+
+struct curl_event_disk_cache_s {
+    char          *dir;
+    int            index_fd;
+    disk_header_t *header;
+    disk_slot_t   *slots;
+    size_t         index_len;
+    size_t         max_bytes;
+    size_t         segment_cap;
+    size_t         bytes;           /* sum of live segment sizes           */
+    struct disk_segment_s **segs;   /* oldest first                        */
+    size_t         num_segs;
+    size_t         segs_cap;
+};
+
+static uint64_t key_hash(const char *key) {
+    uint64_t h = 1469598103934665603ull;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+static char *segment_path(const curl_event_disk_cache_t *d, uint32_t id) {
+    size_t n = strlen(d->dir) + 24;
+    char *path = (char *)aml_malloc(n);
+    if (path) snprintf(path, n, "%s/seg-%08u", d->dir, id);
+    return path;
+}
+
+void curl_event_disk_segment_release(struct disk_segment_s *seg) {
+    if (!seg || --seg->refcnt > 0) return;
+    if (seg->map) munmap(seg->map, seg->map_len);
+    if (seg->fd >= 0) close(seg->fd);
+    aml_free(seg);
+}
+
+/* Maps segment `id`; create starts an empty file */
+static struct disk_segment_s *segment_open(curl_event_disk_cache_t *d, uint32_t id,
+                                           bool create) {
+    char *path = segment_path(d, id);
+    if (!path) return NULL;
+    int fd = open(path, create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+    aml_free(path);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    struct disk_segment_s *seg = NULL;
+    if (fstat(fd, &st) == 0 &&
+        (seg = (struct disk_segment_s *)aml_calloc(1, sizeof(*seg))) != NULL) {
+        seg->id = id;
+        seg->fd = fd;
+        seg->size = (size_t)st.st_size;
+        /* reads stay below size; appends fill the rest of the mapping */
+        seg->map_len = seg->size > d->segment_cap ? seg->size : d->segment_cap;
+        seg->map = (char *)mmap(NULL, seg->map_len, PROT_READ, MAP_SHARED, fd, 0);
+        seg->refcnt = 1;
+        if (seg->map == MAP_FAILED) {
+            aml_free(seg);
+            seg = NULL;
+        }
+    }
+    if (!seg) close(fd);
+    return seg;
+}
+
+static bool segment_push(curl_event_disk_cache_t *d, struct disk_segment_s *seg) {
+    if (d->num_segs == d->segs_cap) {
+        size_t cap = d->segs_cap ? d->segs_cap * 2 : 8;
+        struct disk_segment_s **segs = (struct disk_segment_s **)
+            aml_realloc(d->segs, cap * sizeof(*segs));
+        if (!segs) return false;
+        d->segs = segs;
+        d->segs_cap = cap;
+    }
+    d->segs[d->num_segs++] = seg;
+    d->bytes += seg->size;
+    return true;
+}
+
+static struct disk_segment_s *segment_for(curl_event_disk_cache_t *d, uint32_t id) {
+    for (size_t i = 0; i < d->num_segs; i++)
+        if (d->segs[i]->id == id) return d->segs[i];
+    return NULL;
+}
+
+static struct disk_segment_s *active_segment(curl_event_disk_cache_t *d) {
+    return d->segs[d->num_segs - 1];
+}
+
+/* Record behind a slot if it is intact and belongs to `key` */
+static bool slot_record(curl_event_disk_cache_t *d, const disk_slot_t *s, const char *key,
+                        struct disk_segment_s **seg_out, disk_record_t *rec,
+                        const char **data) {
+    struct disk_segment_s *seg = segment_for(d, s->segment);
+    if (!seg || s->offset + sizeof(*rec) > seg->size || s->length > seg->size - s->offset)
+        return false;
+    memcpy(rec, seg->map + s->offset, sizeof(*rec));
+    uint64_t need = sizeof(*rec) + (uint64_t)rec->key_len + rec->etag_len +
+                    rec->lm_len + rec->body_len;
+    if (rec->magic != RECORD_MAGIC || need > s->length)
+        return false;
+    const char *p = seg->map + s->offset + sizeof(*rec);
+    size_t klen = strlen(key) + 1;
+    if (rec->key_len != klen || memcmp(p, key, klen) != 0)
+        return false;
+    *seg_out = seg;
+    *data = p;
+    return true;
+}
+
+static long slot_find(curl_event_disk_cache_t *d, const char *key, uint64_t h) {
+    uint64_t mask = d->header->nslots - 1;
+    struct disk_segment_s *seg;
+    disk_record_t rec;
+    const char *data;
+    for (uint64_t i = h & mask; d->slots[i].hash; i = (i + 1) & mask)
+        if (d->slots[i].hash == h && slot_record(d, &d->slots[i], key, &seg, &rec, &data))
+            return (long)i;
+    return -1;
+}
+
+/* Backward-shift deletion keeps probe chains intact without tombstones */
+static void slot_delete(curl_event_disk_cache_t *d, uint64_t i) {
+    uint64_t mask = d->header->nslots - 1;
+    uint64_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!d->slots[j].hash) break;
+        uint64_t home = d->slots[j].hash & mask;
+        bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            d->slots[i] = d->slots[j];
+            i = j;
+        }
+    }
+    memset(&d->slots[i], 0, sizeof(d->slots[i]));
+    d->header->count--;
+}
+
+/* Drop the oldest segment and every slot pointing at it (or older) */
+static void evict_oldest(curl_event_disk_cache_t *d) {
+    struct disk_segment_s *seg = d->segs[0];
+    for (uint64_t i = 0; i < d->header->nslots; ) {
+        if (d->slots[i].hash && d->slots[i].segment <= seg->id)
+            slot_delete(d, i);      /* re-check i: an entry may shift in */
+        else
+            i++;
+    }
+    d->bytes -= seg->size;
+    memmove(d->segs, d->segs + 1, (d->num_segs - 1) * sizeof(*d->segs));
+    d->num_segs--;
+    d->header->first_segment = d->segs[0]->id;
+
+    char *path = segment_path(d, seg->id);
+    if (path) {
+        unlink(path);
+        aml_free(path);
+    }
+    curl_event_disk_segment_release(seg);   /* pinned entries keep the map */
+}
+
+static bool roll_segment(curl_event_disk_cache_t *d) {
+    struct disk_segment_s *old = active_segment(d);
+    struct disk_segment_s *seg = segment_open(d, old->id + 1, true);
+    if (!seg) return false;
+    if (!segment_push(d, seg)) {
+        curl_event_disk_segment_release(seg);
+        return false;
+    }
+    d->header->active_segment = seg->id;
+    close(old->fd);                 /* no more appends */
+    old->fd = -1;
+    return true;
+}
+
+size_t curl_event_disk_cache_max_entry(const curl_event_disk_cache_t *d) {
+    return d->segment_cap - sizeof(disk_record_t);
+}
+
+bool curl_event_disk_cache_put(curl_event_disk_cache_t *d, const char *key,
+                               const char *etag, const char *last_modified,
+                               time_t expires, const void *body, size_t len) {
+    disk_record_t rec;
+    rec.magic    = RECORD_MAGIC;
+    rec.key_len  = (uint32_t)strlen(key) + 1;
+    rec.etag_len = etag ? (uint32_t)strlen(etag) + 1 : 0;
+    rec.lm_len   = last_modified ? (uint32_t)strlen(last_modified) + 1 : 0;
+    rec.body_len = len;
+    size_t total = sizeof(rec) + rec.key_len + rec.etag_len + rec.lm_len + len;
+    size_t padded = (total + 7) & ~(size_t)7;
+    if (padded > d->segment_cap) return false;
+
+    uint64_t h = key_hash(key);
+    long i = slot_find(d, key, h);
+    if (i < 0) {
+        uint64_t limit = d->header->nslots - d->header->nslots / 4;
+        while (d->header->count + 1 > limit && d->num_segs > 1)
+            evict_oldest(d);
+        if (d->header->count + 1 > limit) return false;
+    }
+
+    struct disk_segment_s *seg = active_segment(d);
+    if (seg->size && seg->size + padded > d->segment_cap) {
+        if (!roll_segment(d)) return false;
+        seg = active_segment(d);
+    }
+
+    static const char zeros[8];
+    struct iovec iov[6] = {
+        { &rec, sizeof(rec) },
+        { (void *)key, rec.key_len },
+        { (void *)etag, rec.etag_len },
+        { (void *)last_modified, rec.lm_len },
+        { (void *)body, len },
+        { (void *)zeros, padded - total }
+    };
+    if (pwritev(seg->fd, iov, 6, (off_t)seg->size) != (ssize_t)padded) {
+        fprintf(stderr, "[curl_event_disk_cache] write failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    /* the record is written; eviction may have moved our slot */
+    if (i >= 0) i = slot_find(d, key, h);
+    if (i < 0) {
+        uint64_t mask = d->header->nslots - 1;
+        for (i = (long)(h & mask); d->slots[i].hash; i = (long)(((uint64_t)i + 1) & mask)) ;
+        d->header->count++;
+    }
+    disk_slot_t *s = &d->slots[i];
+    s->hash    = h;
+    s->offset  = seg->size;
+    s->segment = seg->id;
+    s->length  = (uint32_t)padded;
+    s->expires = (int64_t)expires;
+    seg->size += padded;
+    d->bytes  += padded;
+
+    while (d->bytes > d->max_bytes && d->num_segs > 1)
+        evict_oldest(d);
+    return true;
+}
+
+cache_entry_t *curl_event_disk_cache_get(curl_event_disk_cache_t *d, const char *key) {
+    long i = slot_find(d, key, key_hash(key));
+    if (i < 0) return NULL;
+    struct disk_segment_s *seg;
+    disk_record_t rec;
+    const char *p;
+    slot_record(d, &d->slots[i], key, &seg, &rec, &p);
+
+    cache_entry_t *e = (cache_entry_t *)aml_calloc(1, sizeof(*e));
+    if (!e) return NULL;
+    e->key  = p;
+    p += rec.key_len;
+    e->etag = rec.etag_len ? aml_strdup(p) : NULL;
+    p += rec.etag_len;
+    e->last_modified = rec.lm_len ? aml_strdup(p) : NULL;
+    p += rec.lm_len;
+    e->body = p;
+    e->len  = (size_t)rec.body_len;
+    e->segment = seg;
+    e->refcnt  = 1;
+    seg->refcnt++;
+
+    time_t expires = (time_t)d->slots[i].expires, now = time(NULL);
+    e->fresh_until = expires > now
+                   ? macro_now() + (uint64_t)(expires - now) * 1000000000ull : 0;
+
+    /* about to be evicted: keep it by writing it again */
+    if (seg == d->segs[0] && d->num_segs > 1)
+        curl_event_disk_cache_put(d, key, e->etag, e->last_modified, expires,
+                                  e->body, e->len);
+    return e;
+}
+
+void curl_event_disk_cache_remove(curl_event_disk_cache_t *d, const char *key) {
+    long i = slot_find(d, key, key_hash(key));
+    if (i >= 0) slot_delete(d, (uint64_t)i);
+}
+
+static bool same_string(const char *a, const char *b) {
+    return a == b || (a && b && strcmp(a, b) == 0);
+}
+
+void curl_event_disk_cache_refresh(curl_event_disk_cache_t *d, const char *key,
+                                   const char *etag, const char *last_modified,
+                                   time_t expires) {
+    long i = slot_find(d, key, key_hash(key));
+    if (i < 0) return;
+    struct disk_segment_s *seg;
+    disk_record_t rec;
+    const char *p;
+    slot_record(d, &d->slots[i], key, &seg, &rec, &p);
+    const char *old_etag = rec.etag_len ? p + rec.key_len : NULL;
+    const char *old_lm = rec.lm_len ? p + rec.key_len + rec.etag_len : NULL;
+    if (same_string(etag, old_etag) && same_string(last_modified, old_lm)) {
+        d->slots[i].expires = (int64_t)expires;
+        return;
+    }
+    /* new validators: write the record again (the body is unchanged) */
+    seg->refcnt++;
+    curl_event_disk_cache_put(d, key, etag, last_modified, expires,
+                              p + rec.key_len + rec.etag_len + rec.lm_len,
+                              (size_t)rec.body_len);
+    curl_event_disk_segment_release(seg);
+}
+
+/* ────────────────────────────────────────────────────────────────────
+   Open / close
+   ──────────────────────────────────────────────────────────────────── */
+
+/* A new index makes old segments unreachable: remove them */
+static void remove_segments(const char *dir) {
+    DIR *dp = opendir(dir);
+    if (!dp) return;
+    struct dirent *de;
+    while ((de = readdir(dp)) != NULL) {
+        if (strncmp(de->d_name, "seg-", 4) != 0) continue;
+        size_t n = strlen(dir) + strlen(de->d_name) + 2;
+        char *path = (char *)aml_malloc(n);
+        if (!path) continue;
+        snprintf(path, n, "%s/%s", dir, de->d_name);
+        unlink(path);
+        aml_free(path);
+    }
+    closedir(dp);
+}
+
+static bool index_open(curl_event_disk_cache_t *d) {
+    size_t n = strlen(d->dir) + 8;
+    char *path = (char *)aml_malloc(n);
+    if (!path) return false;
+    snprintf(path, n, "%s/index", d->dir);
+    d->index_fd = open(path, O_RDWR | O_CREAT, 0644);
+    aml_free(path);
+    if (d->index_fd < 0) return false;
+    if (flock(d->index_fd, LOCK_EX | LOCK_NB) != 0) {
+        fprintf(stderr, "[curl_event_disk_cache] %s is used by another loop.\n", d->dir);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(d->index_fd, &st) != 0) return false;
+    disk_header_t h;
+    bool valid = (size_t)st.st_size > sizeof(h) &&
+                 pread(d->index_fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+                 h.magic == DISK_MAGIC && h.version == DISK_VERSION &&
+                 h.nslots && (h.nslots & (h.nslots - 1)) == 0 &&
+                 (uint64_t)st.st_size == sizeof(h) + h.nslots * sizeof(disk_slot_t) &&
+                 h.first_segment && h.first_segment <= h.active_segment;
+    if (!valid) {
+        /* about one slot per 2 KiB of budget, at least 1024 */
+        memset(&h, 0, sizeof(h));
+        h.magic = DISK_MAGIC;
+        h.version = DISK_VERSION;
+        h.nslots = 1024;
+        while (h.nslots < d->max_bytes / 2048) h.nslots <<= 1;
+        h.first_segment = h.active_segment = 1;
+        remove_segments(d->dir);
+        if (ftruncate(d->index_fd, 0) != 0 ||
+            ftruncate(d->index_fd, (off_t)(sizeof(h) + h.nslots * sizeof(disk_slot_t))) != 0 ||
+            pwrite(d->index_fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h))
+            return false;
+    }
+
+    d->index_len = sizeof(h) + h.nslots * sizeof(disk_slot_t);
+    void *map = mmap(NULL, d->index_len, PROT_READ | PROT_WRITE, MAP_SHARED, d->index_fd, 0);
+    if (map == MAP_FAILED) return false;
+    d->header = (disk_header_t *)map;
+    d->slots  = (disk_slot_t *)(d->header + 1);
+    return true;
+}
+
+curl_event_disk_cache_t *curl_event_disk_cache_open(const char *dir, size_t max_bytes) {
+    curl_event_disk_cache_t *d = (curl_event_disk_cache_t *)aml_calloc(1, sizeof(*d));
+    if (!d) return NULL;
+    d->dir = aml_strdup(dir);
+    d->index_fd = -1;
+    d->max_bytes = max_bytes;
+    /* eight segments per budget, at least 64 KiB each */
+    d->segment_cap = max_bytes / 8;
+    if (d->segment_cap < 65536) d->segment_cap = 65536;
+
+    if (!d->dir || (mkdir(dir, 0755) != 0 && errno != EEXIST) || !index_open(d)) {
+        fprintf(stderr, "[curl_event_disk_cache] Cannot open %s.\n", dir);
+        curl_event_disk_cache_close(d);
+        return NULL;
+    }
+
+    /* segments that went missing just turn their slots into misses */
+    for (uint32_t id = d->header->first_segment; id <= d->header->active_segment; id++) {
+        struct disk_segment_s *seg = segment_open(d, id, false);
+        if (!seg && id == d->header->active_segment)
+            seg = segment_open(d, id, true);
+        if (seg && !segment_push(d, seg))
+            curl_event_disk_segment_release(seg);
+    }
+    if (!d->num_segs || active_segment(d)->id != d->header->active_segment) {
+        fprintf(stderr, "[curl_event_disk_cache] Cannot open segments in %s.\n", dir);
+        curl_event_disk_cache_close(d);
+        return NULL;
+    }
+    d->header->first_segment = d->segs[0]->id;
+    for (size_t i = 0; i + 1 < d->num_segs; i++) {
+        close(d->segs[i]->fd);      /* only the active one is appended to */
+        d->segs[i]->fd = -1;
+    }
+    while (d->bytes > d->max_bytes && d->num_segs > 1)
+        evict_oldest(d);
+    return d;
+}
+
+void curl_event_disk_cache_close(curl_event_disk_cache_t *d) {
+    if (!d) return;
+    for (size_t i = 0; i < d->num_segs; i++)
+        curl_event_disk_segment_release(d->segs[i]);
+    aml_free(d->segs);
+    if (d->header) {
+        msync(d->header, d->index_len, MS_SYNC);
+        munmap(d->header, d->index_len);
+    }
+    if (d->index_fd >= 0) close(d->index_fd);   /* drops the flock */
+    aml_free(d->dir);
+    aml_free(d);
+}
@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+/* ────────────────────────────────────────────────────────────────────
+   Socket-action backend
+
+   libcurl tells us which sockets it cares about (CURLMOPT_SOCKETFUNCTION)
+   and when it next needs a timeout tick (CURLMOPT_TIMERFUNCTION).  We
+   mirror that into an epoll set owned by the loop, so a wakeup only calls
+   curl_multi_socket_action() for the sockets that are actually ready
+   instead of curl_multi_perform() walking every easy handle.
+   ──────────────────────────────────────────────────────────────────── */
+
+#ifdef __linux__
+
+#define EPOLL_MAX_EVENTS 256
+
+/* Non-NULL marker stored via curl_multi_assign() once a socket is in the set */
+static char socket_registered;
+
+static int socket_cb(CURL *easy, curl_socket_t s, int what,
+                     void *userp, void *socketp)
+{
+    (void)easy;
+    curl_event_loop_t *loop = (curl_event_loop_t *)userp;
+
+    if (what == CURL_POLL_REMOVE) {
+        /* The fd may already be closed; EBADF/ENOENT are expected here */
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, s, NULL);
+        curl_multi_assign(loop->multi_handle, s, NULL);
+        return 0;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.data.fd = s;
+    if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) ev.events |= EPOLLIN;
+    if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) ev.events |= EPOLLOUT;
+
+    if (!socketp) {
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, s, &ev) != 0 && errno == EEXIST)
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, s, &ev);
+        curl_multi_assign(loop->multi_handle, s, &socket_registered);
+    } else {
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, s, &ev) != 0 && errno == ENOENT)
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, s, &ev);
+    }
+    return 0;
+}
+
+static int timer_cb(CURLM *multi, long timeout_ms, void *userp)
+{
+    (void)multi;
+    curl_event_loop_t *loop = (curl_event_loop_t *)userp;
+    if (timeout_ms < 0) {
+        loop->curl_timer_armed = false;
+    } else {
+        loop->curl_timer_armed = true;
+        loop->curl_timer_at = macro_now() + (uint64_t)timeout_ms * 1000000ull;
+    }
+    return 0;
+}
+
+bool curl_event_epoll_open(curl_event_loop_t *loop)
+{
+    if (loop->epoll_fd >= 0) return true;
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        fprintf(stderr, "[curl_event_epoll_open] epoll_create1 failed: %s\n", strerror(errno));
+        return false;
+    }
+    int wfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wfd < 0) {
+        fprintf(stderr, "[curl_event_epoll_open] eventfd failed: %s\n", strerror(errno));
+        close(epfd);
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events  = EPOLLIN;
+    ev.data.fd = wfd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, wfd, &ev);
+
+    loop->epoll_fd = epfd;
+    loop->wake_fd  = wfd;
+    loop->curl_timer_armed = false;
+
+    curl_multi_setopt(loop->multi_handle, CURLMOPT_SOCKETFUNCTION, socket_cb);
+    curl_multi_setopt(loop->multi_handle, CURLMOPT_SOCKETDATA, loop);
+    curl_multi_setopt(loop->multi_handle, CURLMOPT_TIMERFUNCTION, timer_cb);
+    curl_multi_setopt(loop->multi_handle, CURLMOPT_TIMERDATA, loop);
+    return true;
+}
+
+void curl_event_epoll_close(curl_event_loop_t *loop)
+{
+    if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+    if (loop->wake_fd >= 0)  close(loop->wake_fd);
+    loop->epoll_fd = -1;
+    loop->wake_fd  = -1;
+}
+
+void curl_event_epoll_wake(curl_event_loop_t *loop)
+{
+    if (loop->wake_fd < 0) return;
+    uint64_t one = 1;
+    ssize_t n = write(loop->wake_fd, &one, sizeof(one));
+    (void)n; /* EAGAIN means a wakeup is already pending */
+}
+
+/* Kick libcurl if its timer is due.  Newly added easy handles arm a 0 ms
+   timer, so this is what actually starts them in socket-action mode. */
+static void run_due_timer(curl_event_loop_t *loop)
+{
+    if (!loop->curl_timer_armed || macro_now() < loop->curl_timer_at) return;
+    loop->curl_timer_armed = false;
+    int running = 0;
+    curl_multi_socket_action(loop->multi_handle, CURL_SOCKET_TIMEOUT, 0, &running);
+}
+
+int curl_event_epoll_wait(curl_event_loop_t *loop, long timeout_ms)
+{
+    run_due_timer(loop);
+
+    /* Never sleep past libcurl's own deadline */
+    if (loop->curl_timer_armed) {
+        uint64_t now = macro_now();
+        long due = loop->curl_timer_at > now
+                 ? (long)((loop->curl_timer_at - now + 999999ull) / 1000000ull) : 0;
+        if (timeout_ms < 0 || due < timeout_ms) timeout_ms = due;
+    }
+
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int n = epoll_wait(loop->epoll_fd, events, EPOLL_MAX_EVENTS, (int)timeout_ms);
+    if (n < 0 && errno != EINTR) {
+        fprintf(stderr, "[curl_event_epoll_wait] epoll_wait failed: %s\n", strerror(errno));
+    }
+
+    int running = 0;
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        if (fd == loop->wake_fd) {
+            uint64_t v;
+            while (read(loop->wake_fd, &v, sizeof(v)) > 0) {}
+            continue;
+        }
+        int flags = 0;
+        if (events[i].events & EPOLLIN)  flags |= CURL_CSELECT_IN;
+        if (events[i].events & EPOLLOUT) flags |= CURL_CSELECT_OUT;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) flags |= CURL_CSELECT_ERR;
+        curl_multi_socket_action(loop->multi_handle, fd, flags, &running);
+    }
+
+    run_due_timer(loop);
+    return n > 0 ? n : 0;
+}
+
+#else /* !__linux__ */
+
+bool curl_event_epoll_open(curl_event_loop_t *loop) { (void)loop; return false; }
+void curl_event_epoll_close(curl_event_loop_t *loop) { (void)loop; }
+void curl_event_epoll_wake(curl_event_loop_t *loop) { (void)loop; }
+int  curl_event_epoll_wait(curl_event_loop_t *loop, long timeout_ms) {
+    (void)loop; (void)timeout_ms; return 0;
+}
+
+#endif
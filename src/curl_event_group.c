@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/curl_event_group.h"
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <stdio.h>
+
+curl_event_group_t *curl_event_group_init(curl_event_loop_t *loop) {
+    if (!loop) {
+        fprintf(stderr, "[curl_event_group_init] Invalid arguments.\n");
+        return NULL;
+    }
+    curl_event_group_t *group = (curl_event_group_t *)aml_calloc(1, sizeof(*group));
+    if (!group) {
+        fprintf(stderr, "[curl_event_group_init] Memory allocation failed.\n");
+        return NULL;
+    }
+    group->loop = loop;
+    atomic_init(&group->refcnt, 1);
+    atomic_init(&group->cancelled, false);
+    group->members = NULL;
+    group->num_members = 0;
+    return group;
+}
+
+void curl_event_group_retain(curl_event_group_t *group) {
+    atomic_fetch_add(&group->refcnt, 1);
+}
+
+void curl_event_group_release(curl_event_group_t *group) {
+    if (!group) return;
+    if (atomic_fetch_sub(&group->refcnt, 1) == 1)
+        aml_free(group);
+}
+
+bool curl_event_request_group(curl_event_request_t *req, curl_event_group_t *group) {
+    if (!req || !group) return false;
+    curl_event_loop_request_t *wrap = curl_wrap_from_public(req);
+    if (wrap->is_pending || wrap->multi_handle || wrap->group) {
+        fprintf(stderr, "[curl_event_request_group] Request already submitted or grouped.\n");
+        return false;
+    }
+    curl_event_group_retain(group);
+    wrap->group = group;
+    return true;
+}
+
+bool curl_event_group_cancel(curl_event_group_t *group) {
+    if (!group) return false;
+    if (atomic_exchange(&group->cancelled, true))
+        return false;
+    /* the message holds a reference until the loop has processed it */
+    curl_event_group_retain(group);
+    curl_event_loop_post(group->loop, &group->cancel_msg, LOOP_MSG_CANCEL_GROUP);
+    return true;
+}
+
+bool curl_event_group_cancelled(const curl_event_group_t *group) {
+    return group && atomic_load(&group->cancelled);
+}
+
+size_t curl_event_group_size(const curl_event_group_t *group) {
+    return group ? group->num_members : 0;
+}
+
+void curl_event_group_link(curl_event_loop_request_t *req) {
+    curl_event_group_t *group = req->group;
+    if (!group || req->group_linked) return;
+    req->group_prev = NULL;
+    req->group_next = group->members;
+    if (group->members) group->members->group_prev = req;
+    group->members = req;
+    group->num_members++;
+    req->group_linked = true;
+}
+
+void curl_event_group_unlink(curl_event_loop_request_t *req) {
+    curl_event_group_t *group = req->group;
+    if (!group || !req->group_linked) return;
+    if (req->group_prev) req->group_prev->group_next = req->group_next;
+    else                 group->members = req->group_next;
+    if (req->group_next) req->group_next->group_prev = req->group_prev;
+    req->group_prev = req->group_next = NULL;
+    group->num_members--;
+    req->group_linked = false;
+}
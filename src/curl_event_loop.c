@@ -10,8 +10,127 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
+/* Hedge credit grows by hedge_ratio per hedge-enabled start; at most
+   HEDGE_BURST starts' worth is banked. */
+#define HEDGE_BURST        10.0
+/* Samples a key needs before its percentile replaces the fixed delay */
+#define HEDGE_MIN_SAMPLES  20
+/* Default concurrency when the descriptor limit allows more */
+#define MAX_CONCURRENT_DEFAULT 1000
+/* Descriptors always left to the rest of the process */
+#define FD_RESERVE_MIN     32
+/* A breaker's failure-rate window is kept as this many rolling slices */
+#define BREAKER_SLICES     10
+
+/* Attempt latency per rate-limit key or host (loop->latency_keys) */
+typedef struct {
+    macro_map_t    node;
+    const char    *key;             /* stored after the struct */
+    latency_hist_t hist;
+} latency_key_t;
+
+static inline int compare_latency_key(const latency_key_t *a, const latency_key_t *b) {
+    return strcmp(a->key, b->key);
+}
+static inline int compare_latency_key_string(const char *a, const latency_key_t *b) {
+    return strcmp(a, b->key);
+}
+static inline
+macro_map_insert(latency_key_insert, latency_key_t, compare_latency_key);
+static inline
+macro_map_find_kv(latency_key_find, char, latency_key_t, compare_latency_key_string);
+
+/* Requests holding a slot on one URL authority, and those parked until
+   one frees up (loop->hosts; freed when both are empty) */
+typedef struct host_slot_s {
+    macro_map_t   node;
+    const char   *key;              /* stored after the struct */
+    size_t        active;           /* started, or handed a slot */
+    timer_node_t  waiting;          /* parked requests, FIFO   */
+} host_slot_t;
+
+static inline int compare_host_slot(const host_slot_t *a, const host_slot_t *b) {
+    return strcmp(a->key, b->key);
+}
+static inline int compare_host_slot_string(const char *a, const host_slot_t *b) {
+    return strcmp(a, b->key);
+}
+static inline
+macro_map_insert(host_slot_insert, host_slot_t, compare_host_slot);
+static inline
+macro_map_find_kv(host_slot_find, char, host_slot_t, compare_host_slot_string);
+
+/* Attempts in one slice of a breaker's window */
+typedef struct {
+    uint64_t epoch;                 /* slice number + 1; 0 = unused */
+    uint32_t ok;
+    uint32_t failed;
+} breaker_slice_t;
+
+/* Circuit breaker of a rate-limit key or host (loop->breakers; kept until
+   the loop is destroyed) */
+typedef struct breaker_s {
+    macro_map_t   node;
+    const char   *key;              /* stored after the struct */
+    curl_event_breaker_state_t state;
+    unsigned      consecutive;      /* failed attempts in a row (CLOSED) */
+    breaker_slice_t slices[BREAKER_SLICES];
+    uint64_t      open_until;       /* OPEN: half-open from then on */
+    unsigned      probes;           /* probes in flight */
+    unsigned      successes;        /* HALF_OPEN: probes that succeeded */
+    timer_node_t  parked;           /* requests held while open, FIFO */
+    timer_node_t  link;             /* on loop->breakers_parked while any are */
+} breaker_t;
+
+static inline int compare_breaker(const breaker_t *a, const breaker_t *b) {
+    return strcmp(a->key, b->key);
+}
+static inline int compare_breaker_string(const char *a, const breaker_t *b) {
+    return strcmp(a, b->key);
+}
+static inline
+macro_map_insert(breaker_insert, breaker_t, compare_breaker);
+static inline
+macro_map_find_kv(breaker_find, char, breaker_t, compare_breaker_string);
+
+/* Retry tokens of the loop or of one rate-limit key or host
+   (loop->retry_budgets) */
+typedef struct retry_budget_s {
+    macro_map_t   node;
+    const char   *key;              /* stored after the struct; NULL for the loop */
+    double        tokens;
+    uint64_t      last_refill;
+} retry_budget_t;
+
+static inline int compare_retry_budget(const retry_budget_t *a, const retry_budget_t *b) {
+    return strcmp(a->key, b->key);
+}
+static inline int compare_retry_budget_string(const char *a, const retry_budget_t *b) {
+    return strcmp(a, b->key);
+}
+static inline
+macro_map_insert(retry_budget_insert, retry_budget_t, compare_retry_budget);
+static inline
+macro_map_find_kv(retry_budget_find, char, retry_budget_t, compare_retry_budget_string);
+
+static inline breaker_t *breaker_from_link(timer_node_t *n) {
+    return (breaker_t *)((char *)n - offsetof(breaker_t, link));
+}
+
+/* A quarter of RLIMIT_NOFILE (at least FD_RESERVE_MIN) stays with the
+   rest of the process; the remainder can hold transfer sockets. */
+size_t curl_event_fd_budget(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY)
+        return MAX_CONCURRENT_DEFAULT;
+    rlim_t reserve = rl.rlim_cur / 4;
+    if (reserve < FD_RESERVE_MIN) reserve = FD_RESERVE_MIN;
+    return rl.rlim_cur > reserve ? (size_t)(rl.rlim_cur - reserve) : 1;
+}
+
 curl_event_loop_t *curl_event_loop_init(curl_event_on_loop_t on_loop, void *arg) {
     curl_event_loop_t *loop = (curl_event_loop_t *)aml_calloc(1, sizeof(curl_event_loop_t));
     if (!loop) {
@@ -23,8 +142,6 @@ curl_event_loop_t *curl_event_loop_init(curl_event_on_loop_t on_loop, void *arg)
     loop->on_loop_arg = arg;
 
     loop->queued_requests = NULL;
-    loop->inactive_requests = NULL;
-    loop->refresh_requests = NULL;
     loop->resources = NULL;
     loop->multi_handle = curl_multi_init();
     if (!loop->multi_handle) {
@@ -33,16 +150,15 @@ curl_event_loop_t *curl_event_loop_init(curl_event_on_loop_t on_loop, void *arg)
         return NULL;
     }
 
-    loop->shared_handle = curl_share_init();
-    if (!loop->shared_handle) {
+    loop->share = curl_event_share_init(CURL_EVENT_SHARE_DEFAULT);
+    if (!loop->share) {
         fprintf(stderr, "[curl_event_loop_init] Failed to create shared_handle.\n");
         curl_multi_cleanup(loop->multi_handle);
         aml_free(loop);
         return NULL;
     }
-
-    // Example: share DNS cache
-    curl_share_setopt(loop->shared_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    atomic_fetch_add(&loop->share->num_loops, 1);
+    loop->shared_handle = loop->share->sh;
 
     // The user can toggle HTTP/3 support if their libcurl has it
     loop->enable_http3 = true;
@@ -50,31 +166,239 @@ curl_event_loop_t *curl_event_loop_init(curl_event_on_loop_t on_loop, void *arg)
     loop->queued_requests = NULL;
     loop->num_queued_requests = 0;
     loop->num_multi_requests = 0;
-    loop->inactive_requests = NULL;
-    loop->num_inactive_requests = 0;
-
-    loop->refresh_requests = NULL;
-    loop->num_refresh_requests = 0;
-
-    loop->cancelled_requests = NULL;
+    loop->num_ready_requests = 0;
+    timer_wheel_init(&loop->timers, macro_now() / 1000000ull);
+
+    for (int l = 0; l < CURL_EVENT_PRIORITY_LANES; l++) {
+        timer_list_init(&loop->lanes[l]);
+        timer_list_init(&loop->lane_arrivals[l]);
+        loop->lane_weight[l] = 1u << l;      /* 1, 2, 4, 8 */
+        loop->lane_credit[l] = loop->lane_weight[l];
+    }
+    loop->dispatch_mode = CURL_EVENT_DISPATCH_STRICT;
+    loop->aging_ns = 10000ull * 1000000ull;
+
+    timer_wheel_init(&loop->hedge_timers, macro_now() / 1000000ull);
+    timer_list_init(&loop->hedge_losers);
+    loop->hedge_ratio = 0.1;
+    loop->hedge_credit = 0.0;
+    loop->latency_keys = NULL;
+    loop->hosts = NULL;
+    loop->breaker_on = false;
+    loop->breakers = NULL;
+    timer_list_init(&loop->breakers_parked);
+    loop->num_breaker_parked = 0;
+    loop->retry_budget_on = false;
+    loop->loop_budget = NULL;
+    loop->retry_budgets = NULL;
+    timer_list_init(&loop->rate_waiting);
+    loop->inflight = NULL;
+    loop->cache = NULL;
+    timer_list_init(&loop->cache_ready);
+
+    mpsc_queue_init(&loop->inbox);
+    atomic_init(&loop->total_requests, 0);
     loop->pending_requests = NULL;
     loop->injected_requests = NULL;
-    loop->rate_limited_requests = NULL;
+
+    pthread_mutex_init(&loop->stats_lock, NULL);
+    loop->key_stats[CURL_EVENT_STATS_RATE_KEY] = NULL;
+    loop->key_stats[CURL_EVENT_STATS_HOST] = NULL;
 
     loop->metrics.total_requests = 0;
     loop->metrics.completed_requests = 0;
     loop->metrics.failed_requests = 0;
     loop->metrics.retried_requests = 0;
+    loop->metrics.expired_requests = 0;
+
+    loop->easy_pool = NULL;
+    loop->easy_pool_len = 0;
+    loop->easy_pool_cap = 64;
 
-    // Let’s default to a high concurrency.
-    loop->max_concurrent_requests = 1000;
+    // Concurrency follows the descriptor limit, and open connections
+    // (idle ones in the connection cache included) stay within it.
+    size_t budget = curl_event_fd_budget();
+    loop->max_concurrent_requests = budget < MAX_CONCURRENT_DEFAULT
+                                  ? budget : MAX_CONCURRENT_DEFAULT;
+    curl_multi_setopt(loop->multi_handle, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)budget);
+    loop->max_host_requests = 0;
+    loop->multiplex = true;
+
+    loop->backend = CURL_EVENT_BACKEND_POLL;
+    loop->epoll_fd = -1;
+    loop->wake_fd = -1;
 
     loop->keep_running = true;
-    pthread_mutex_init(&loop->mutex, NULL);
 
     return loop;
 }
 
+CURL *curl_event_loop_easy_acquire(curl_event_loop_t *loop) {
+    if (loop->easy_pool_len > 0) {
+        loop->metrics.easy_handle_hits++;
+        return loop->easy_pool[--loop->easy_pool_len];
+    }
+    loop->metrics.easy_handle_misses++;
+    return curl_easy_init();
+}
+
+void curl_event_loop_easy_release(curl_event_loop_t *loop, CURL *easy) {
+    if (!easy) return;
+    if (loop->easy_pool_len >= loop->easy_pool_cap) {
+        curl_easy_cleanup(easy);
+        return;
+    }
+    if (!loop->easy_pool) {
+        loop->easy_pool = (CURL **)aml_calloc(loop->easy_pool_cap, sizeof(CURL *));
+        if (!loop->easy_pool) {
+            curl_easy_cleanup(easy);
+            return;
+        }
+    }
+    curl_easy_reset(easy);
+    loop->easy_pool[loop->easy_pool_len++] = easy;
+    if (loop->easy_pool_len > loop->metrics.easy_handle_high_water)
+        loop->metrics.easy_handle_high_water = loop->easy_pool_len;
+}
+
+void curl_event_loop_set_easy_pool_size(curl_event_loop_t *loop, size_t max_idle) {
+    if (!loop) return;
+    while (loop->easy_pool_len > max_idle)
+        curl_easy_cleanup(loop->easy_pool[--loop->easy_pool_len]);
+    if (loop->easy_pool && max_idle != loop->easy_pool_cap) {
+        CURL **p = NULL;
+        if (max_idle) {
+            p = (CURL **)aml_calloc(max_idle, sizeof(CURL *));
+            if (!p) return;   /* keep the old array; cap unchanged */
+            memcpy(p, loop->easy_pool, loop->easy_pool_len * sizeof(CURL *));
+        }
+        aml_free(loop->easy_pool);
+        loop->easy_pool = p;
+    }
+    loop->easy_pool_cap = max_idle;
+}
+
+bool curl_event_loop_set_share(curl_event_loop_t *loop, curl_event_share_t *share) {
+    if (!loop || !share) return false;
+    if (share == loop->share) return true;
+    if (loop->num_multi_requests > 0) {
+        fprintf(stderr, "[curl_event_loop_set_share] Cannot switch share with transfers in flight.\n");
+        return false;
+    }
+    if (atomic_fetch_add(&share->num_loops, 1) > 0 &&
+        (share->flags & CURL_EVENT_SHARE_CONNECT)) {
+        atomic_fetch_sub(&share->num_loops, 1);
+        fprintf(stderr, "[curl_event_loop_set_share] A CONNECT share can only serve one loop.\n");
+        return false;
+    }
+    curl_event_share_retain(share);
+
+    atomic_fetch_sub(&loop->share->num_loops, 1);
+    curl_event_share_release(loop->share);
+    loop->share = share;
+    loop->shared_handle = share->sh;
+    return true;
+}
+
+bool curl_event_loop_set_share_profile(curl_event_loop_t *loop, unsigned flags) {
+    if (!loop) return false;
+    curl_event_share_t *share = curl_event_share_init(flags);
+    if (!share) return false;
+    bool ok = curl_event_loop_set_share(loop, share);
+    curl_event_share_release(share);   /* the loop holds its own reference */
+    return ok;
+}
+
+void curl_event_loop_set_dispatch(curl_event_loop_t *loop,
+                                  curl_event_dispatch_t mode,
+                                  const unsigned *weights)
+{
+    if (!loop) return;
+    loop->dispatch_mode = mode;
+    for (int l = 0; l < CURL_EVENT_PRIORITY_LANES; l++) {
+        if (weights)
+            loop->lane_weight[l] = weights[l] ? weights[l] : 1;
+        loop->lane_credit[l] = loop->lane_weight[l];
+    }
+}
+
+void curl_event_loop_set_priority_aging(curl_event_loop_t *loop, uint64_t aging_ms) {
+    if (!loop) return;
+    loop->aging_ns = aging_ms * 1000000ull;
+}
+
+void curl_event_loop_set_hedge_ratio(curl_event_loop_t *loop, double max_ratio) {
+    if (!loop) return;
+    if (max_ratio < 0.0) max_ratio = 0.0;
+    if (max_ratio > 1.0) max_ratio = 1.0;
+    loop->hedge_ratio = max_ratio;
+}
+
+void curl_event_loop_set_max_concurrent(curl_event_loop_t *loop, size_t max) {
+    if (!loop) return;
+    loop->max_concurrent_requests = max;
+}
+
+static void host_unpark(curl_event_loop_t *loop, host_slot_t *h);
+
+void curl_event_loop_set_max_host_requests(curl_event_loop_t *loop, size_t max) {
+    if (!loop) return;
+    loop->max_host_requests = max;
+    /* a higher cap (or none) lets parked requests go now */
+    for (macro_map_t *n = macro_map_first(loop->hosts); n; n = macro_map_next(n))
+        host_unpark(loop, (host_slot_t *)n);
+}
+
+bool curl_event_loop_set_connection_limits(curl_event_loop_t *loop, long per_host,
+                                           long total, long cache_size) {
+    if (!loop) return false;
+    CURLMcode rc = CURLM_OK;
+    if (per_host >= 0)
+        rc = curl_multi_setopt(loop->multi_handle, CURLMOPT_MAX_HOST_CONNECTIONS, per_host);
+    if (rc == CURLM_OK && total >= 0)
+        rc = curl_multi_setopt(loop->multi_handle, CURLMOPT_MAX_TOTAL_CONNECTIONS, total);
+    if (rc == CURLM_OK && cache_size >= 0)
+        rc = curl_multi_setopt(loop->multi_handle, CURLMOPT_MAXCONNECTS, cache_size);
+    if (rc != CURLM_OK) {
+        fprintf(stderr, "[curl_event_loop_set_connection_limits] %s\n", curl_multi_strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+bool curl_event_loop_set_multiplex(curl_event_loop_t *loop, bool enable) {
+    if (!loop) return false;
+    CURLMcode rc = curl_multi_setopt(loop->multi_handle, CURLMOPT_PIPELINING,
+                                     enable ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+    if (rc != CURLM_OK) {
+        fprintf(stderr, "[curl_event_loop_set_multiplex] %s\n", curl_multi_strerror(rc));
+        return false;
+    }
+    loop->multiplex = enable;
+    return true;
+}
+
+bool curl_event_loop_set_backend(curl_event_loop_t *loop, curl_event_backend_t backend) {
+    if (!loop) return false;
+    if (backend == loop->backend) return true;
+    if (loop->num_multi_requests > 0) {
+        fprintf(stderr, "[curl_event_loop_set_backend] Cannot switch backend with transfers in flight.\n");
+        return false;
+    }
+    if (backend == CURL_EVENT_BACKEND_EPOLL) {
+        if (!curl_event_epoll_open(loop)) {
+            fprintf(stderr, "[curl_event_loop_set_backend] epoll backend unavailable.\n");
+            return false;
+        }
+    } else {
+        curl_multi_setopt(loop->multi_handle, CURLMOPT_SOCKETFUNCTION, NULL);
+        curl_multi_setopt(loop->multi_handle, CURLMOPT_TIMERFUNCTION, NULL);
+        curl_event_epoll_close(loop);
+    }
+    loop->backend = backend;
+    return true;
+}
+
 // curl_event_loop_inject lets you post a “synthetic completion” into the loop
 void curl_event_loop_inject(curl_event_loop_t *loop, curl_event_request_t *req_pub) {
     if (!loop || !req_pub) return;
@@ -95,37 +419,122 @@ void curl_event_loop_inject(curl_event_loop_t *loop, curl_event_request_t *req_p
     injected_req->easy_handle = NULL; // No actual cURL handle
     injected_req->multi_handle = NULL;
 
-    pthread_mutex_lock(&loop->mutex);
-    injected_req->next_pending = loop->injected_requests;
-    loop->injected_requests = injected_req;
-    pthread_mutex_unlock(&loop->mutex);
+    curl_event_loop_post(loop, &injected_req->submit_msg, LOOP_MSG_INJECT);
 }
 
 bool curl_event_loop_cancel(curl_event_loop_t *loop, curl_event_request_t *r) {
     if (!loop || !r) return false;
 
     curl_event_loop_request_t *req = curl_wrap_from_public(r);
+    if (atomic_exchange(&req->cancel_requested, true))
+        return false; // Already canceled
 
-    pthread_mutex_lock(&loop->mutex);
+    curl_event_loop_post(loop, &req->cancel_msg, LOOP_MSG_CANCEL);
+    return true;
+}
 
-    if (req->next_cancelled) {
-        pthread_mutex_unlock(&loop->mutex);
-        return false; // Already canceled
+size_t curl_event_loop_submit_batch(curl_event_loop_t *loop,
+                                    curl_event_request_t **reqs,
+                                    size_t n)
+{
+    if (!loop || !reqs) {
+        fprintf(stderr, "[curl_event_loop_submit_batch] Invalid arguments.\n");
+        return 0;
     }
 
-    req->is_cancelled = true;
-    if (!req->is_pending) {
-        req->next_cancelled = loop->cancelled_requests;
-        loop->cancelled_requests = req;
+    /* Link the chain privately, then publish it with one exchange */
+    mpsc_node_t *first = NULL, *last = NULL;
+    size_t submitted = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!reqs[i] || !curl_event_request_prepare_submit(loop, reqs[i], reqs[i]->priority))
+            continue;
+        mpsc_node_t *node = &curl_wrap_from_public(reqs[i])->submit_msg.node;
+        if (last)
+            atomic_store_explicit(&last->next, node, memory_order_relaxed);
+        else
+            first = node;
+        last = node;
+        submitted++;
     }
-    pthread_mutex_unlock(&loop->mutex);
-    return true;
+    if (!submitted) return 0;
+
+    atomic_fetch_add_explicit(&loop->total_requests, submitted, memory_order_relaxed);
+    if (mpsc_queue_push_chain(&loop->inbox, first, last))
+        curl_event_loop_wake(loop);
+    return submitted;
+}
+
+void curl_event_loop_post(curl_event_loop_t *loop, loop_msg_t *msg, int kind) {
+    msg->kind = kind;
+    if (mpsc_queue_push(&loop->inbox, &msg->node))
+        curl_event_loop_wake(loop);
 }
 
 void curl_event_loop_destroy(curl_event_loop_t *loop) {
     if (!loop) return;
 
-    // First, clean up requests stored in macro_map_t-based containers
+    // Withdraw requests queued on a rate-limit key so that no other loop
+    // can wake them from now on.  One already woken has a message below.
+    timer_node_t timed;
+    timer_list_init(&timed);
+    for (timer_node_t *t = loop->rate_waiting.next, *next; t != &loop->rate_waiting; t = next) {
+        next = t->next;
+        curl_event_loop_request_t *r = curl_wrap_from_timer(t);
+        if (rate_key_cancel_wait(r->request.rate_key, &r->rate_waiter)) {
+            timer_list_unlink(t);
+            r->where = REQ_WHERE_NONE;
+            timer_list_append(&timed, t);
+        }
+    }
+
+    // Empty the inbox first: a cancel message lives inside a request that
+    // may be destroyed below.  Submitted and injected requests are kept.
+    curl_event_loop_request_t *unseen = NULL;
+    mpsc_node_t *m;
+    while ((m = mpsc_queue_pop(&loop->inbox)) != NULL) {
+        int kind = ((loop_msg_t *)m)->kind;
+        if (kind == LOOP_MSG_CANCEL)
+            continue;
+        if (kind == LOOP_MSG_CANCEL_GROUP) {
+            curl_event_group_release(curl_group_from_msg(m));
+            continue;
+        }
+        curl_event_loop_request_t *r = curl_wrap_from_msg(m);
+        if (kind == LOOP_MSG_RATE_WAKE) {
+            timer_list_unlink(&r->timer);
+            r->where = REQ_WHERE_NONE;
+            r->rate_slot = r->rate_granted;   /* released when destroyed */
+        }
+        r->next_pending = unseen;
+        unseen = r;
+    }
+
+    // Requests parked on a host go next, so finishing the ones that
+    // hold its slots cannot hand those slots on.
+    for (macro_map_t *h = macro_map_first(loop->hosts); h; h = macro_map_next(h)) {
+        host_slot_t *host = (host_slot_t *)h;
+        while (!timer_list_empty(&host->waiting)) {
+            curl_event_loop_request_t *r = curl_wrap_from_timer(host->waiting.next);
+            timer_list_unlink(&r->timer);
+            r->host_slot = NULL;
+            r->where = REQ_WHERE_NONE;
+            timer_list_append(&timed, &r->timer);
+        }
+    }
+    while (!timer_list_empty(&loop->breakers_parked)) {
+        breaker_t *b = breaker_from_link(loop->breakers_parked.next);
+        timer_list_unlink(&b->link);
+        while (!timer_list_empty(&b->parked)) {
+            curl_event_loop_request_t *r = curl_wrap_from_timer(b->parked.next);
+            timer_list_unlink(&r->timer);
+            r->breaker = NULL;
+            r->where = REQ_WHERE_NONE;
+            timer_list_append(&timed, &r->timer);
+        }
+    }
+    loop->num_breaker_parked = 0;
+
+    // Then clean up requests stored in macro_map_t-based containers
 
     macro_map_t *n = macro_map_first(loop->queued_requests);
     while (n) {
@@ -135,43 +544,37 @@ void curl_event_loop_destroy(curl_event_loop_t *loop) {
         n = macro_map_first(loop->queued_requests);
     }
 
-    n = macro_map_first(loop->inactive_requests);
-    while (n) {
-        curl_event_loop_request_t *req = (curl_event_loop_request_t *)n;
-        macro_map_erase(&loop->inactive_requests, n);
-        curl_event_request_destroy(req);
-        n = macro_map_first(loop->inactive_requests);
+    // Requests waiting in a priority lane or on a retry, refresh or
+    // rate-limit timer
+    for (int l = 0; l < CURL_EVENT_PRIORITY_LANES; l++) {
+        while (!timer_list_empty(&loop->lanes[l])) {
+            timer_node_t *t = loop->lanes[l].next;
+            timer_list_unlink(t);
+            timer_list_append(&timed, t);
+        }
+        timer_list_init(&loop->lane_arrivals[l]);
     }
-
-    n = macro_map_first(loop->refresh_requests);
-    while (n) {
-        curl_event_loop_request_t *req = (curl_event_loop_request_t *)n;
-        macro_map_erase(&loop->refresh_requests, n);
-        curl_event_request_destroy(req);
-        n = macro_map_first(loop->refresh_requests);
+    while (!timer_list_empty(&loop->cache_ready)) {
+        timer_node_t *t = loop->cache_ready.next;
+        timer_list_unlink(t);
+        timer_list_append(&timed, t);
     }
-
-    n = macro_map_first(loop->rate_limited_requests);
-    while (n) {
-        curl_event_loop_request_t *req = (curl_event_loop_request_t *)n;
-        macro_map_erase(&loop->rate_limited_requests, n);
-        curl_event_request_destroy(req);
-        n = macro_map_first(loop->rate_limited_requests);
+    timer_wheel_drain(&loop->timers, &timed);
+    while (!timer_list_empty(&timed)) {
+        timer_node_t *t = timed.next;
+        timer_list_unlink(t);
+        curl_event_request_destroy(curl_wrap_from_timer(t));
     }
 
     // Now, clean up requests stored in linked lists
-    pthread_mutex_lock(&loop->mutex);
-
-    // Cancelled requests
-    curl_event_loop_request_t *req = loop->cancelled_requests;
+    curl_event_loop_request_t *req = unseen;
     while (req) {
-        curl_event_loop_request_t *next = req->next_cancelled;
+        curl_event_loop_request_t *next = req->next_pending;
         curl_event_request_destroy(req);
         req = next;
     }
-    loop->cancelled_requests = NULL;
 
-    // Pending requests (waiting on dependencies)
+    // Pending requests (requeued by a resource)
     req = loop->pending_requests;
     while (req) {
         curl_event_loop_request_t *next = req->next_pending;
@@ -189,31 +592,227 @@ void curl_event_loop_destroy(curl_event_loop_t *loop) {
     }
     loop->injected_requests = NULL;
 
-    pthread_mutex_unlock(&loop->mutex);
+    curl_event_loop_set_easy_pool_size(loop, 0);
 
-    // Clean up libcurl handles and the mutex
+    // Clean up libcurl handles
     curl_multi_cleanup(loop->multi_handle);
-    curl_share_cleanup(loop->shared_handle);
-    pthread_mutex_destroy(&loop->mutex);
+    atomic_fetch_sub(&loop->share->num_loops, 1);
+    curl_event_share_release(loop->share);
+    curl_event_epoll_close(loop);   /* after multi cleanup: socket_cb may still fire */
 
     curl_resource_destroy_all(loop);
+    curl_event_cache_destroy(loop);
+
+    macro_map_t *k;
+    while ((k = macro_map_first(loop->latency_keys)) != NULL) {
+        macro_map_erase(&loop->latency_keys, k);
+        aml_free(k);
+    }
+    while ((k = macro_map_first(loop->hosts)) != NULL) {
+        macro_map_erase(&loop->hosts, k);
+        aml_free(k);
+    }
+    while ((k = macro_map_first(loop->breakers)) != NULL) {
+        macro_map_erase(&loop->breakers, k);
+        aml_free(k);
+    }
+    while ((k = macro_map_first(loop->retry_budgets)) != NULL) {
+        macro_map_erase(&loop->retry_budgets, k);
+        aml_free(k);
+    }
+    aml_free(loop->loop_budget);
+    curl_event_stats_destroy(loop);
     aml_free(loop);
 }
 
-static bool request_is_rate_limited(curl_event_loop_t *loop, macro_map_t **root, curl_event_loop_request_t *req) {
-    if (!req->request.rate_limit)
+static int lane_for_priority(int priority) {
+    if (priority < 0) return 0;
+    if (priority >= CURL_EVENT_PRIORITY_LANES) return CURL_EVENT_PRIORITY_LANES - 1;
+    return priority;
+}
+
+/* EDF key: requests without a deadline sort after every deadline */
+static inline uint64_t edf_key(const curl_event_loop_request_t *req) {
+    return req->request.deadline ? req->request.deadline : UINT64_MAX;
+}
+
+/* Lanes are earliest-deadline-first, FIFO among equal keys.  The walk
+   starts at the tail, so requests without a deadline, or with a common
+   budget (later submit, later deadline), append in O(1).  lane_arrivals
+   keeps the same requests in the order they entered the lane, for
+   aging. */
+static void lane_push(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                      int lane, uint64_t now) {
+    timer_node_t *head = &loop->lanes[lane];
+    timer_node_t *pos = head;
+    uint64_t key = edf_key(req);
+    while (pos->prev != head && edf_key(curl_wrap_from_timer(pos->prev)) > key)
+        pos = pos->prev;
+    timer_list_append(pos, &req->timer);    /* links before pos */
+    timer_list_append(&loop->lane_arrivals[lane], &req->lane_node);
+    req->lane = (unsigned char)lane;
+    req->lane_at = now;
+    req->where = REQ_WHERE_READY;
+    loop->metrics.lanes[lane].depth++;
+}
+
+static void lane_unlink(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    timer_list_unlink(&req->timer);
+    timer_list_unlink(&req->lane_node);
+    loop->metrics.lanes[req->lane].depth--;
+}
+
+/* A request leaving the wheel or pending always restarts in its own lane */
+static void make_ready(curl_event_loop_t *loop, curl_event_loop_request_t *req, uint64_t now) {
+    req->ready_at = now;
+    lane_push(loop, req, lane_for_priority(req->request.priority), now);
+    loop->num_ready_requests++;
+}
+
+/* ---------------------------------------------------------------------
+   Per-host cap: a request takes one of its host's max_host_requests
+   slots at dispatch and gives it back when its attempt ends.  At the cap
+   it is parked on the host instead, so the lanes keep serving other
+   hosts; a freed slot goes straight to the oldest parked request.
+   --------------------------------------------------------------------- */
+
+/* URL authority (host[:port]) */
+static const char *request_host_key(curl_event_loop_request_t *req) {
+    if (req->host_key) return req->host_key;
+    const char *host = strstr(req->request.url, "://");
+    host = host ? host + 3 : req->request.url;
+    size_t len = strcspn(host, "/?#");
+    char *key = (char *)aml_pool_alloc(req->request.pool, len + 1);
+    memcpy(key, host, len);
+    key[len] = '\0';
+    return req->host_key = key;
+}
+
+static void host_free_if_idle(curl_event_loop_t *loop, host_slot_t *h) {
+    if (h->active || !timer_list_empty(&h->waiting)) return;
+    macro_map_erase(&loop->hosts, &h->node);
+    aml_free(h);
+}
+
+/* Hand free slots to parked requests, oldest first */
+static void host_unpark(curl_event_loop_t *loop, host_slot_t *h) {
+    uint64_t now = macro_now();
+    while (!timer_list_empty(&h->waiting) &&
+           (!loop->max_host_requests || h->active < loop->max_host_requests)) {
+        curl_event_loop_request_t *req = curl_wrap_from_timer(h->waiting.next);
+        timer_list_unlink(&req->timer);
+        h->active++;                    /* req->host_slot now holds it */
+        make_ready(loop, req, now);
+    }
+}
+
+/* Take a slot on req's host, or park req there and return false */
+static bool host_acquire(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    if (!loop->max_host_requests || req->host_slot)
+        return true;
+    const char *key = request_host_key(req);
+    host_slot_t *h = host_slot_find(loop->hosts, key);
+    if (!h) {
+        size_t len = strlen(key);
+        h = (host_slot_t *)aml_calloc(1, sizeof(*h) + len + 1);
+        if (!h) return true;            /* uncapped rather than stuck */
+        memcpy((char *)(h + 1), key, len + 1);
+        h->key = (const char *)(h + 1);
+        timer_list_init(&h->waiting);
+        host_slot_insert(&loop->hosts, h);
+    }
+    req->host_slot = h;
+    if (h->active < loop->max_host_requests) {
+        h->active++;
+        return true;
+    }
+    timer_list_append(&h->waiting, &req->timer);
+    req->where = REQ_WHERE_HOST;
+    loop->metrics.host_parked++;
+    return false;
+}
+
+void curl_event_host_release(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    host_slot_t *h = req->host_slot;
+    if (!h || req->where == REQ_WHERE_HOST) return;
+    req->host_slot = NULL;
+    h->active--;
+    host_unpark(loop, h);
+    host_free_if_idle(loop, h);
+}
+
+void curl_event_loop_schedule(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    uint64_t now = macro_now();
+    /* slots are held from dispatch until the attempt ends */
+    curl_event_host_release(loop, req);
+    if (req->request.next_retry_at <= now) {
+        if (!curl_event_coalesce_follow(loop, req))
+            make_ready(loop, req, now);
+    } else {
+        /* round up so the timer never fires before next_retry_at; a
+           deadline that comes first wakes the request to be expired */
+        uint64_t at = req->request.next_retry_at;
+        if (req->request.deadline && req->request.deadline < at)
+            at = req->request.deadline;
+        timer_wheel_insert(&loop->timers, &req->timer, (at + 999999ull) / 1000000ull);
+        req->where = REQ_WHERE_TIMER;
+    }
+}
+
+/* Any thread: the rate manager took req off its key's queue */
+static void rate_on_wake(rate_manager_waiter_t *w, bool granted) {
+    curl_event_loop_request_t *req = (curl_event_loop_request_t *)((char *)w
+        - offsetof(curl_event_loop_request_t, rate_waiter));
+    req->rate_granted = granted;
+    curl_event_loop_post(req->request.loop, &req->rate_msg, LOOP_MSG_RATE_WAKE);
+}
+
+/* Take a slot on req's rate-limit key (and its ancestors) now, or wait
+   for one: on the wheel until the bucket refills (or a 429 pause ends), or
+   queued on the full level until a finishing request frees a slot there. */
+static bool request_is_rate_limited(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    if (!req->request.rate_key || req->rate_slot)
         return false;
-    uint64_t next = rate_manager_can_proceed(req->request.rate_limit, req->request.rate_limit_high_priority);
-    if (next == 0)
+    req->rate_waiter.on_wake = rate_on_wake;
+    uint64_t next = rate_key_acquire(req->request.rate_key,
+                                     req->request.rate_limit_high_priority,
+                                     &req->rate_waiter);
+    if (next == 0) {
+        req->rate_slot = true;
         return false;
+    }
+    req->request.rate_limited_by = rate_key_name(req->rate_waiter.limited_by);
+    if (next == RATE_MANAGER_QUEUED) {
+        timer_list_append(&loop->rate_waiting, &req->timer);
+        req->where = REQ_WHERE_RATE;
+        return true;
+    }
 
-    macro_map_erase(root, &req->node);
-    // insert into a rate limited queue with time as key
+    // wait on the timer wheel until the bucket refills
     req->request.next_retry_at = macro_now() + next;
-    curl_event_request_insert(&loop->rate_limited_requests, req);
+    curl_event_loop_schedule(loop, req);
     return true;
 }
 
+/* Loop thread: a queued request was handed a slot, or told to retry */
+static void rate_woken(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    timer_list_unlink(&req->timer);
+    req->where = REQ_WHERE_NONE;
+    req->rate_slot = req->rate_granted;
+    if (req->is_cancelled) {
+        curl_event_request_destroy(req);   /* gives the slot back */
+        return;
+    }
+    make_ready(loop, req, macro_now());
+}
+
+void curl_event_rate_release(curl_event_loop_request_t *req) {
+    rate_manager_release_reservation(&req->rate_waiter);
+    if (!req->rate_slot) return;
+    req->rate_slot = false;
+    rate_key_request_done(req->request.rate_key);
+}
+
 static bool request_waiting_on_dependencies(curl_event_loop_t *loop,
                                             curl_event_loop_request_t *req)
 {
@@ -222,183 +821,831 @@ static bool request_waiting_on_dependencies(curl_event_loop_t *loop,
     return curl_resource_check_and_block_list(loop, req, req->request.dep_head);
 }
 
+/* Take a parked request off its breaker */
+static void breaker_unpark(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    breaker_t *b = req->breaker;
+    timer_list_unlink(&req->timer);
+    req->breaker = NULL;
+    loop->num_breaker_parked--;
+    if (timer_list_empty(&b->parked))
+        timer_list_unlink(&b->link);
+}
+
+static void unlink_request(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    switch (req->where) {
+    case REQ_WHERE_ACTIVE:
+        macro_map_erase(&loop->queued_requests, (macro_map_t *)req);
+        loop->num_queued_requests--;
+        curl_event_coalesce_forget(loop, req);
+        curl_event_host_release(loop, req);
+        break;
+    case REQ_WHERE_READY:
+        lane_unlink(loop, req);
+        loop->num_ready_requests--;
+        break;
+    case REQ_WHERE_TIMER:
+        timer_wheel_remove(&loop->timers, &req->timer);
+        break;
+    case REQ_WHERE_BLOCKED:
+        curl_resource_unblock(loop, req);
+        break;
+    case REQ_WHERE_FOLLOWER:
+        curl_event_coalesce_unfollow(req);
+        break;
+    case REQ_WHERE_CACHED:
+        timer_list_unlink(&req->timer);
+        break;
+    case REQ_WHERE_RATE:
+        timer_list_unlink(&req->timer);
+        break;
+    case REQ_WHERE_HOST: {
+        host_slot_t *h = req->host_slot;
+        timer_list_unlink(&req->timer);
+        req->host_slot = NULL;
+        host_free_if_idle(loop, h);
+        break;
+    }
+    case REQ_WHERE_BREAKER:
+        breaker_unpark(loop, req);
+        break;
+    }
+    req->where = REQ_WHERE_NONE;
+}
+
+/* A submitted (or resource-requeued) request enters the scheduler */
+static void admit_request(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    req->next_pending = NULL;
+    if (req->is_cancelled || curl_event_group_cancelled(req->group)) {
+        curl_event_request_destroy(req);
+        return;
+    }
+    curl_event_group_link(req);
+    /* Retain all resource deps the FIRST time the loop thread
+       touches this request. This pins resources until the request
+       is destroyed (or released explicitly). */
+    if (!req->deps_retained && req->request.dep_head) {
+        curl_resource_retain_request_deps(loop, &req->request);
+        req->deps_retained = true;
+    }
+    if (!request_waiting_on_dependencies(loop, req))
+        curl_event_loop_schedule(loop, req);
+}
+
+void curl_event_loop_cancel_request(curl_event_loop_t *loop,
+                                    curl_event_loop_request_t *req) {
+    req->is_cancelled = true;
+    /* A request requeued to pending is destroyed when admit_request
+       sees is_cancelled. */
+    if (req->where == REQ_WHERE_NONE)
+        return;
+    /* already woken: the RATE_WAKE message finishes the job */
+    if (req->where == REQ_WHERE_RATE &&
+        !rate_key_cancel_wait(req->request.rate_key, &req->rate_waiter))
+        return;
+    /* a rate-limit slot is given back when req is destroyed */
+    bool was_active = req->where == REQ_WHERE_ACTIVE;
+    unlink_request(loop, req);
+    if (was_active) {
+        /* followers go back to the scheduler; one of them will lead */
+        curl_event_loop_request_t *follower;
+        while ((follower = curl_event_coalesce_pop_follower(req)) != NULL) {
+            follower->request.next_retry_at = macro_now();
+            curl_event_loop_schedule(loop, follower);
+        }
+    }
+    curl_event_request_destroy(req);
+}
+
+/* Cancel every admitted member.  A member whose own cancel message is
+   still queued is only flagged; that message finishes the job. */
+static void cancel_group(curl_event_loop_t *loop, curl_event_group_t *group) {
+    while (group->members) {
+        curl_event_loop_request_t *req = group->members;
+        curl_event_group_unlink(req);
+        if (atomic_exchange(&req->cancel_requested, true))
+            req->is_cancelled = true;
+        else
+            curl_event_loop_cancel_request(loop, req);
+    }
+    curl_event_group_release(group);
+}
+
+/* Apply submits, cancels and injects in the order they were posted */
+static void process_inbox_and_pending_requests(curl_event_loop_t *loop) {
+    mpsc_queue_begin_drain(&loop->inbox);
+    mpsc_node_t *m;
+    while ((m = mpsc_queue_pop(&loop->inbox)) != NULL) {
+        int kind = ((loop_msg_t *)m)->kind;
+        if (kind == LOOP_MSG_CANCEL_GROUP) {
+            cancel_group(loop, curl_group_from_msg(m));
+            continue;
+        }
+        curl_event_loop_request_t *req = curl_wrap_from_msg(m);
+        switch (kind) {
+        case LOOP_MSG_SUBMIT:
+            atomic_store(&req->is_pending, false);
+            admit_request(loop, req);
+            break;
+        case LOOP_MSG_CANCEL:
+            curl_event_loop_cancel_request(loop, req);
+            break;
+        case LOOP_MSG_RATE_WAKE:
+            rate_woken(loop, req);
+            break;
+        case LOOP_MSG_INJECT:
+            req->next_pending = loop->injected_requests;
+            loop->injected_requests = req;
+            break;
+        }
+    }
+
+    curl_event_loop_request_t *pending = loop->pending_requests;
+    loop->pending_requests = NULL;
+    while (pending) {
+        curl_event_loop_request_t *next = pending->next_pending;
+        admit_request(loop, pending);
+        pending = next;
+    }
+}
+
+static uint64_t breaker_next_expiry(curl_event_loop_t *loop);
+
 /**
- * Check if a request is ready to be retried or become active.
+ * Milliseconds until the scheduler has timed work (retry, refresh, rate
+ * limit or a libcurl timeout), capped at max_value.  Returns max_value when
+ * nothing is scheduled; a negative max_value means "no cap" and is returned
+ * as-is when idle.
  */
-static bool request_ready(curl_event_loop_t *loop, const curl_event_loop_request_t *req) {
-    if (loop->num_queued_requests >= loop->max_concurrent_requests) {
-        return false;
+static long calculate_next_timer_expiry(curl_event_loop_t *loop, long max_value) {
+    uint64_t now = macro_now();
+    long timeout = -1;
+
+    /* Ready requests cannot start while we are at the concurrency cap;
+       a completion will wake us instead of a busy spin. */
+    if (loop->num_ready_requests > 0 &&
+        loop->num_queued_requests < (int)loop->max_concurrent_requests)
+        timeout = 0;
+    else {
+        uint64_t next_ms = timer_wheel_next_expiry(&loop->timers);
+        if (next_ms != UINT64_MAX) {
+            uint64_t now_ms = now / 1000000ull;
+            timeout = next_ms <= now_ms ? 0 : (long)(next_ms - now_ms);
+        }
     }
-    if (req->request.rate_limit) {
-        if (rate_manager_can_proceed(req->request.rate_limit, req->request.rate_limit_high_priority) > 0) {
-            return false;
+
+    /* hedges fire, and breakers half-open, regardless of free slots */
+    uint64_t hedge_ms = timer_wheel_next_expiry(&loop->hedge_timers);
+    uint64_t breaker_ms = breaker_next_expiry(loop);
+    if (breaker_ms < hedge_ms) hedge_ms = breaker_ms;
+    if (hedge_ms != UINT64_MAX) {
+        uint64_t now_ms = now / 1000000ull;
+        long t = hedge_ms <= now_ms ? 0 : (long)(hedge_ms - now_ms);
+        if (timeout < 0 || t < timeout) timeout = t;
+    }
+
+    long curl_ms = -1;
+    if (loop->backend == CURL_EVENT_BACKEND_EPOLL) {
+        if (loop->curl_timer_armed) {
+            curl_ms = loop->curl_timer_at > now
+                    ? (long)((loop->curl_timer_at - now + 999999ull) / 1000000ull) : 0;
         }
+    } else if (loop->num_multi_requests > 0) {
+        curl_multi_timeout(loop->multi_handle, &curl_ms);
     }
-    if (req->request.dep_head) {
-        if (!curl_resource_all_ready_list(loop, req->request.dep_head)) {
-            return false;
+
+    if (curl_ms >= 0 && (timeout < 0 || curl_ms < timeout))
+        timeout = curl_ms;
+    if (timeout < 0 || (max_value >= 0 && timeout > max_value))
+        return max_value;
+    return timeout;
+}
+
+/* Move requests that have waited aging_ns up one lane.  EDF order puts
+   new deadline requests ahead of older ones, so the oldest entries are
+   found through lane_arrivals rather than at the lane heads. */
+static void age_lanes(curl_event_loop_t *loop, uint64_t now) {
+    if (!loop->aging_ns) return;
+    for (int l = CURL_EVENT_PRIORITY_LANES - 2; l >= 0; l--) {
+        while (!timer_list_empty(&loop->lane_arrivals[l])) {
+            curl_event_loop_request_t *req =
+                curl_wrap_from_lane_node(loop->lane_arrivals[l].next);
+            if (now - req->lane_at < loop->aging_ns)
+                break;
+            lane_unlink(loop, req);
+            loop->metrics.lanes[l].promoted++;
+            lane_push(loop, req, l + 1, now);
         }
     }
+}
 
-    // Check if the current time is greater than or equal to the retry time
-    return macro_now() >= req->request.next_retry_at;
+/* Drop a request whose deadline passed before it took a connection */
+static void expire_request(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    loop->metrics.expired_requests++;
+    if (req->request.on_failure)
+        req->request.on_failure(NULL, CURL_EVENT_E_DEADLINE, 0, &req->request);
+    curl_event_request_destroy(req);
 }
 
-static void enqueue_request(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
-    if (req->request.should_refresh) {
-        curl_event_request_insert(&loop->refresh_requests, req);
-        loop->num_refresh_requests++;
-    } else {
-        curl_event_request_insert(&loop->inactive_requests, req);
-        loop->num_inactive_requests++;
+/* Lanes are EDF ordered, so expired requests are at the heads */
+static void expire_lanes(curl_event_loop_t *loop, uint64_t now) {
+    for (int l = 0; l < CURL_EVENT_PRIORITY_LANES; l++) {
+        while (!timer_list_empty(&loop->lanes[l])) {
+            curl_event_loop_request_t *req = curl_wrap_from_timer(loop->lanes[l].next);
+            if (!req->request.deadline || req->request.deadline > now)
+                break;
+            unlink_request(loop, req);
+            expire_request(loop, req);
+        }
     }
 }
 
-void process_cancelled_and_pending_requests(curl_event_loop_t *loop) {
-    pthread_mutex_lock(&loop->mutex);
-    curl_event_loop_request_t *cancelled = loop->cancelled_requests;
-    loop->cancelled_requests = NULL; // Reset the list for new cancellations
+/* Next lane to serve, or -1 when every lane is empty */
+static int pick_lane(curl_event_loop_t *loop) {
+    if (loop->dispatch_mode == CURL_EVENT_DISPATCH_STRICT) {
+        for (int l = CURL_EVENT_PRIORITY_LANES - 1; l >= 0; l--)
+            if (!timer_list_empty(&loop->lanes[l])) return l;
+        return -1;
+    }
+    /* Deficit round robin: each non-empty lane may start `weight` requests
+       per round, higher lanes first; refill once every non-empty lane has
+       used its credit. */
+    for (int pass = 0; pass < 2; pass++) {
+        for (int l = CURL_EVENT_PRIORITY_LANES - 1; l >= 0; l--) {
+            if (loop->lane_credit[l] && !timer_list_empty(&loop->lanes[l])) {
+                loop->lane_credit[l]--;
+                return l;
+            }
+        }
+        for (int l = 0; l < CURL_EVENT_PRIORITY_LANES; l++)
+            loop->lane_credit[l] = loop->lane_weight[l];
+    }
+    return -1;
+}
 
-    curl_event_loop_request_t *pending = loop->pending_requests;
-    loop->pending_requests = NULL; // Reset the list for new additions
-    pthread_mutex_unlock(&loop->mutex);
+/* ---------------------------------------------------------------------
+   Hedging
+   --------------------------------------------------------------------- */
+
+static bool request_is_get(const curl_event_request_t *r) {
+    if (r->method) return strcasecmp(r->method, "GET") == 0;
+    return !r->post_data && !r->json_root;
+}
 
-    while (cancelled) {
-        curl_event_loop_request_t *next = cancelled->next_cancelled;
+/* Latency key: the rate-limit key if set, else the URL's authority */
+static const char *request_latency_key(curl_event_loop_request_t *req) {
+    if (req->hedge_key) return req->hedge_key;
+    if (req->request.rate_limit) return req->hedge_key = req->request.rate_limit;
+    return req->hedge_key = request_host_key(req);
+}
 
-        if (cancelled->multi_handle) {
-            macro_map_erase(&loop->queued_requests, (macro_map_t *)cancelled);
-            loop->num_queued_requests--;
-        } else {
-            if (cancelled->request.should_refresh) {
-                macro_map_erase(&loop->refresh_requests, (macro_map_t *)cancelled);
-                loop->num_refresh_requests--;
-            } else {
-                macro_map_erase(&loop->inactive_requests, (macro_map_t *)cancelled);
-                loop->num_inactive_requests--;
-            }
+static latency_hist_t *request_latency(curl_event_loop_t *loop,
+                                       curl_event_loop_request_t *req, bool create) {
+    const char *key = request_latency_key(req);
+    latency_key_t *k = latency_key_find(loop->latency_keys, key);
+    if (k || !create) return k ? &k->hist : NULL;
+
+    size_t len = strlen(key);
+    k = (latency_key_t *)aml_calloc(1, sizeof(*k) + len + 1);
+    if (!k) return NULL;
+    memcpy((char *)(k + 1), key, len + 1);
+    k->key = (const char *)(k + 1);
+    latency_key_insert(&loop->latency_keys, k);
+    return &k->hist;
+}
+
+/* Called when a hedge-enabled GET starts its (primary) attempt */
+static void arm_hedge(curl_event_loop_t *loop, curl_event_loop_request_t *req, uint64_t now) {
+    curl_event_request_t *r = &req->request;
+    if ((!r->hedge_delay_ms && r->hedge_percentile <= 0.0) ||
+        loop->hedge_ratio <= 0.0 || !request_is_get(r))
+        return;
+
+    double cap = loop->hedge_ratio * HEDGE_BURST;
+    loop->hedge_credit += loop->hedge_ratio;
+    if (loop->hedge_credit > (cap > 1.0 ? cap : 1.0))
+        loop->hedge_credit = cap > 1.0 ? cap : 1.0;
+
+    uint64_t delay_ms = r->hedge_delay_ms;
+    if (r->hedge_percentile > 0.0) {
+        latency_hist_t *h = request_latency(loop, req, false);
+        if (h && h->count >= HEDGE_MIN_SAMPLES) {
+            delay_ms = (latency_hist_percentile(h, r->hedge_percentile) + 999) / 1000;
+            if (!delay_ms) delay_ms = 1;
         }
-        curl_event_request_destroy(cancelled);
-        cancelled = next;
     }
+    if (!delay_ms) return;      /* percentile only, not enough samples yet */
+    timer_wheel_insert(&loop->hedge_timers, &req->hedge_timer, now / 1000000ull + delay_ms);
+    req->hedge_state = HEDGE_ARMED;
+}
 
-    while (pending) {
-        curl_event_loop_request_t *next = pending->next_pending;
-        pending->is_pending = false;
-        pending->next_pending = NULL;
-        if (pending->is_cancelled) {
-            curl_event_request_destroy(pending);
-        } else {
-            /* Retain all resource deps the FIRST time the loop thread
-               touches this request. This pins resources until the request
-               is destroyed (or released explicitly). */
-            if (!pending->deps_retained && pending->request.dep_head) {
-                curl_resource_retain_request_deps(loop, &pending->request);
-                pending->deps_retained = true;
-            }
+/* Launch the hedges that came due, as far as the hedge credit allows */
+static void fire_hedges(curl_event_loop_t *loop, uint64_t now) {
+    timer_node_t due;
+    timer_list_init(&due);
+    timer_wheel_advance(&loop->hedge_timers, now / 1000000ull, &due);
+    while (!timer_list_empty(&due)) {
+        curl_event_loop_request_t *req = curl_wrap_from_hedge_timer(due.next);
+        timer_list_unlink(&req->hedge_timer);
+        req->hedge_state = HEDGE_DONE;
+        if (loop->hedge_credit < 1.0)
+            continue;
+        if (curl_event_loop_request_hedge(req)) {
+            loop->hedge_credit -= 1.0;
+            loop->metrics.hedges_fired++;
+        }
+    }
+}
 
-            if (!request_waiting_on_dependencies(loop, pending)) {
-                if (request_ready(loop, pending)) {
-                    curl_event_loop_request_start(pending);
-                } else {
-                    enqueue_request(loop, pending);
-                }
-            }
+/* Remove the losers of races decided inside write callbacks */
+static void settle_hedges(curl_event_loop_t *loop) {
+    while (!timer_list_empty(&loop->hedge_losers)) {
+        curl_event_loop_request_t *req = curl_wrap_from_hedge_timer(loop->hedge_losers.next);
+        curl_event_loop_request_settle_hedge(req, req->hedge_winner);
+    }
+}
+
+/* ---------------------------------------------------------------------
+   Circuit breaker: attempts are counted per latency key (rate-limit key
+   or host).  Too many failures in a row, or too high a share over the
+   window, open the breaker; requests for the key then fail fast or park
+   on it.  After open_ms up to `probes` requests go through at a time
+   (half-open): that many successes close the breaker, one failure opens
+   it again.
+   --------------------------------------------------------------------- */
+
+/* No response (a write error is the sink's doing) or a server error */
+static bool attempt_failed(CURLcode result, long http_code) {
+    if (result != CURLE_OK)
+        return result != CURLE_WRITE_ERROR && result != CURLE_ABORTED_BY_CALLBACK;
+    return http_code >= 500;
+}
+
+static breaker_t *breaker_get(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    const char *key = request_latency_key(req);
+    breaker_t *b = breaker_find(loop->breakers, key);
+    if (b) return b;
+
+    size_t len = strlen(key);
+    b = (breaker_t *)aml_calloc(1, sizeof(*b) + len + 1);
+    if (!b) return NULL;                /* unguarded rather than stuck */
+    memcpy((char *)(b + 1), key, len + 1);
+    b->key = (const char *)(b + 1);
+    b->state = CURL_EVENT_BREAKER_CLOSED;
+    timer_list_init(&b->parked);
+    breaker_insert(&loop->breakers, b);
+    return b;
+}
+
+static void breaker_make_probe(curl_event_loop_t *loop, breaker_t *b,
+                               curl_event_loop_request_t *req) {
+    b->probes++;
+    req->breaker = b;
+    req->breaker_probe = true;
+    loop->metrics.breaker_probes++;
+}
+
+/* Half-open: send parked requests as probes while there is room */
+static void breaker_fill_probes(curl_event_loop_t *loop, breaker_t *b, uint64_t now) {
+    while (b->state == CURL_EVENT_BREAKER_HALF_OPEN && b->probes < loop->breaker.probes &&
+           !timer_list_empty(&b->parked)) {
+        curl_event_loop_request_t *req = curl_wrap_from_timer(b->parked.next);
+        breaker_unpark(loop, req);
+        breaker_make_probe(loop, b, req);
+        make_ready(loop, req, now);
+    }
+}
+
+static void breaker_set_state(curl_event_loop_t *loop, breaker_t *b,
+                              curl_event_breaker_state_t to, uint64_t now) {
+    curl_event_breaker_state_t from = b->state;
+    b->state = to;
+    b->consecutive = 0;
+    b->successes = 0;
+    memset(b->slices, 0, sizeof(b->slices));
+    if (from == CURL_EVENT_BREAKER_CLOSED) loop->metrics.breakers_open++;
+    if (to == CURL_EVENT_BREAKER_CLOSED) loop->metrics.breakers_open--;
+
+    switch (to) {
+    case CURL_EVENT_BREAKER_OPEN:
+        b->open_until = now + loop->breaker.open_ms * 1000000ull;
+        loop->metrics.breaker_trips++;
+        break;
+    case CURL_EVENT_BREAKER_HALF_OPEN:
+        loop->metrics.breaker_half_opens++;
+        break;
+    case CURL_EVENT_BREAKER_CLOSED:
+        loop->metrics.breaker_recoveries++;
+        break;
+    }
+    if (loop->breaker.on_change)
+        loop->breaker.on_change(b->key, from, to, loop->breaker.on_change_arg);
+
+    if (to == CURL_EVENT_BREAKER_HALF_OPEN) {
+        breaker_fill_probes(loop, b, now);
+    } else if (to == CURL_EVENT_BREAKER_CLOSED) {
+        while (!timer_list_empty(&b->parked)) {
+            curl_event_loop_request_t *req = curl_wrap_from_timer(b->parked.next);
+            breaker_unpark(loop, req);
+            make_ready(loop, req, now);
         }
-        pending = next;
     }
 }
 
-static long calculate_next_timer_expiry(curl_event_loop_t *loop, long max_value) {
-    uint64_t current_time, next_time;
+/* Count an attempt in the window; true if the breaker should trip */
+static bool breaker_count(curl_event_loop_t *loop, breaker_t *b, bool failed, uint64_t now) {
+    const curl_event_breaker_config_t *c = &loop->breaker;
+    b->consecutive = failed ? b->consecutive + 1 : 0;
+    if (c->consecutive_failures && b->consecutive >= c->consecutive_failures)
+        return true;
+    if (c->failure_rate <= 0.0)
+        return false;
 
-    // Get the first request from the inactive map (sorted by `next_retry_at`)
-    macro_map_t *first_inactive_node = macro_map_first(loop->inactive_requests);
-    macro_map_t *first_refresh_node = macro_map_first(loop->refresh_requests);
-    if (!first_inactive_node && !first_refresh_node) {
-        return max_value;
-    } else if (!first_inactive_node) {
-        curl_event_loop_request_t *r = (curl_event_loop_request_t *)first_refresh_node;
-        next_time = r->request.next_retry_at;
-    } else if (!first_refresh_node) {
-        curl_event_loop_request_t *r = (curl_event_loop_request_t *)first_inactive_node;
-        next_time = r->request.next_retry_at;
+    uint64_t slice_ns = c->window_ms * 1000000ull / BREAKER_SLICES;
+    if (!slice_ns) slice_ns = 1;
+    uint64_t epoch = now / slice_ns + 1;
+    breaker_slice_t *s = &b->slices[epoch % BREAKER_SLICES];
+    if (s->epoch != epoch) {
+        s->epoch = epoch;
+        s->ok = s->failed = 0;
+    }
+    if (failed) s->failed++;
+    else s->ok++;
+    if (!failed)
+        return false;
+
+    uint64_t ok = 0, bad = 0;
+    for (int i = 0; i < BREAKER_SLICES; i++) {
+        if (b->slices[i].epoch + BREAKER_SLICES > epoch) {
+            ok += b->slices[i].ok;
+            bad += b->slices[i].failed;
+        }
+    }
+    return ok + bad >= c->min_requests &&
+           (double)bad >= c->failure_rate * (double)(ok + bad);
+}
+
+/* Dispatch: true if req may start.  Otherwise it was failed (and
+   destroyed) or parked on its breaker. */
+static bool breaker_admit(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                          uint64_t now) {
+    if (!loop->breaker_on || req->breaker_probe)
+        return true;
+    breaker_t *b = breaker_get(loop, req);
+    if (!b) return true;
+    if (b->state == CURL_EVENT_BREAKER_OPEN && now >= b->open_until)
+        breaker_set_state(loop, b, CURL_EVENT_BREAKER_HALF_OPEN, now);
+    if (b->state == CURL_EVENT_BREAKER_CLOSED)
+        return true;
+    if (b->state == CURL_EVENT_BREAKER_HALF_OPEN && b->probes < loop->breaker.probes &&
+        timer_list_empty(&b->parked)) {
+        breaker_make_probe(loop, b, req);
+        return true;
+    }
+
+    if (loop->breaker.park) {
+        if (timer_list_empty(&b->parked))
+            timer_list_append(&loop->breakers_parked, &b->link);
+        timer_list_append(&b->parked, &req->timer);
+        req->breaker = b;
+        req->where = REQ_WHERE_BREAKER;
+        loop->num_breaker_parked++;
+        loop->metrics.breaker_parked++;
+        return false;
+    }
+    loop->metrics.breaker_rejected++;
+    if (req->request.on_failure)
+        req->request.on_failure(NULL, CURL_EVENT_E_CIRCUIT_OPEN, 0, &req->request);
+    curl_event_request_destroy(req);
+    return false;
+}
+
+/* A finished attempt: probes decide a half-open breaker, other attempts
+   count while it is closed */
+static void breaker_record(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                           bool failed, uint64_t now) {
+    if (req->breaker_probe) {
+        breaker_t *b = req->breaker;
+        req->breaker_probe = false;
+        req->breaker = NULL;
+        b->probes--;
+        if (b->state != CURL_EVENT_BREAKER_HALF_OPEN)
+            return;                     /* another probe opened it again */
+        if (failed)
+            breaker_set_state(loop, b, CURL_EVENT_BREAKER_OPEN, now);
+        else if (++b->successes >= loop->breaker.probes)
+            breaker_set_state(loop, b, CURL_EVENT_BREAKER_CLOSED, now);
+        else
+            breaker_fill_probes(loop, b, now);
+        return;
+    }
+    if (!loop->breaker_on) return;
+    breaker_t *b = breaker_get(loop, req);
+    if (b && b->state == CURL_EVENT_BREAKER_CLOSED && breaker_count(loop, b, failed, now))
+        breaker_set_state(loop, b, CURL_EVENT_BREAKER_OPEN, now);
+}
+
+void curl_event_breaker_release(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    if (!req->breaker_probe) return;
+    breaker_t *b = req->breaker;
+    req->breaker_probe = false;
+    req->breaker = NULL;
+    b->probes--;
+    breaker_fill_probes(loop, b, macro_now());
+}
+
+/* Open breakers with parked requests go half-open when their time is up */
+static void breaker_tick(curl_event_loop_t *loop, uint64_t now) {
+    for (timer_node_t *t = loop->breakers_parked.next, *next; t != &loop->breakers_parked; t = next) {
+        next = t->next;
+        breaker_t *b = breaker_from_link(t);
+        if (b->state == CURL_EVENT_BREAKER_OPEN && now >= b->open_until)
+            breaker_set_state(loop, b, CURL_EVENT_BREAKER_HALF_OPEN, now);
+    }
+}
+
+/* Earliest half-open time of a breaker with parked requests (ms), or
+   UINT64_MAX */
+static uint64_t breaker_next_expiry(curl_event_loop_t *loop) {
+    uint64_t next = UINT64_MAX;
+    for (timer_node_t *t = loop->breakers_parked.next; t != &loop->breakers_parked; t = t->next) {
+        breaker_t *b = breaker_from_link(t);
+        if (b->state == CURL_EVENT_BREAKER_OPEN && b->open_until < next)
+            next = b->open_until;
+    }
+    return next == UINT64_MAX ? next : (next + 999999ull) / 1000000ull;
+}
+
+bool curl_event_loop_set_breaker(curl_event_loop_t *loop,
+                                 const curl_event_breaker_config_t *config) {
+    if (!loop) return false;
+    if (!config) {
+        uint64_t now = macro_now();
+        loop->breaker_on = false;
+        for (macro_map_t *n = macro_map_first(loop->breakers); n; n = macro_map_next(n)) {
+            breaker_t *b = (breaker_t *)n;
+            if (b->state != CURL_EVENT_BREAKER_CLOSED)
+                breaker_set_state(loop, b, CURL_EVENT_BREAKER_CLOSED, now);
+        }
+        return true;
+    }
+    if (config->failure_rate < 0.0 || config->failure_rate > 1.0) {
+        fprintf(stderr, "[curl_event_loop_set_breaker] failure_rate must be in [0, 1].\n");
+        return false;
+    }
+    curl_event_breaker_config_t c = *config;
+    if (!c.min_requests) c.min_requests = 10;
+    if (!c.window_ms) c.window_ms = 10000;
+    if (!c.open_ms) c.open_ms = 5000;
+    if (!c.probes) c.probes = 1;
+    loop->breaker = c;
+    loop->breaker_on = true;
+    return true;
+}
+
+curl_event_breaker_state_t curl_event_loop_breaker_state(const curl_event_loop_t *loop,
+                                                         const char *key) {
+    if (!loop || !key) return CURL_EVENT_BREAKER_CLOSED;
+    breaker_t *b = breaker_find(loop->breakers, key);
+    return b ? b->state : CURL_EVENT_BREAKER_CLOSED;
+}
+
+/* ---------------------------------------------------------------------
+   Retry budget: first attempts earn `ratio` of a retry each and time
+   earns min_per_sec; a retry spends one.  Counted on the loop, or per
+   latency key with per_key.
+   --------------------------------------------------------------------- */
+
+static retry_budget_t *retry_budget_get(curl_event_loop_t *loop,
+                                        curl_event_loop_request_t *req, uint64_t now) {
+    retry_budget_t *b;
+    if (!loop->retry_budget.per_key) {
+        if (!loop->loop_budget)
+            loop->loop_budget = (retry_budget_t *)aml_calloc(1, sizeof(retry_budget_t));
+        b = loop->loop_budget;
+        if (!b) return NULL;
     } else {
-        curl_event_loop_request_t *r = (curl_event_loop_request_t *)first_inactive_node;
-        if (!request_ready(loop, r)) {
-            r = (curl_event_loop_request_t *)first_refresh_node;
-            next_time = r->request.next_retry_at;
-        } else {
-            long inactive_time = r->request.next_retry_at;
-            r = (curl_event_loop_request_t *)first_refresh_node;
-            long refresh_time = r->request.next_retry_at;
-            next_time = inactive_time < refresh_time ? inactive_time : refresh_time;
+        const char *key = request_latency_key(req);
+        b = retry_budget_find(loop->retry_budgets, key);
+        if (!b) {
+            size_t len = strlen(key);
+            b = (retry_budget_t *)aml_calloc(1, sizeof(*b) + len + 1);
+            if (!b) return NULL;
+            memcpy((char *)(b + 1), key, len + 1);
+            b->key = (const char *)(b + 1);
+            retry_budget_insert(&loop->retry_budgets, b);
         }
     }
-    current_time = macro_now();
-    if (next_time < current_time) {
-        return 0;
+    if (!b->last_refill) {
+        b->tokens = loop->retry_budget.burst;   /* starts full */
+    } else if (loop->retry_budget.min_per_sec > 0.0) {
+        b->tokens += loop->retry_budget.min_per_sec * (double)(now - b->last_refill) / 1e9;
     }
-    next_time = next_time - current_time;
-    next_time /= 1000000L; // Convert to milliseconds
-    return next_time > max_value ? max_value : next_time;
+    if (b->tokens > loop->retry_budget.burst)
+        b->tokens = loop->retry_budget.burst;
+    b->last_refill = now;
+    return b;
+}
+
+/* An attempt starts: a first attempt tops up its budget */
+static void retry_budget_earn(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                              uint64_t now) {
+    if (req->budget_retry) {
+        req->budget_retry = false;
+        return;
+    }
+    if (!loop->retry_budget_on) return;
+    retry_budget_t *b = retry_budget_get(loop, req, now);
+    if (b) b->tokens += loop->retry_budget.ratio;
+}
+
+/* on_retry wants another attempt: true if the budget pays for it */
+static bool retry_budget_take(curl_event_loop_t *loop, curl_event_loop_request_t *req) {
+    if (!loop->retry_budget_on) return true;
+    retry_budget_t *b = retry_budget_get(loop, req, macro_now());
+    if (!b) return true;
+    if (b->tokens < 1.0) {
+        loop->metrics.retries_denied++;
+        return false;
+    }
+    b->tokens -= 1.0;
+    req->budget_retry = true;
+    return true;
 }
 
-static void move_inactive_requests_to_queue(curl_event_loop_t *loop) {
-    macro_map_t *n;
-    macro_map_t *root = loop->rate_limited_requests;
-    loop->rate_limited_requests = NULL;
+bool curl_event_loop_set_retry_budget(curl_event_loop_t *loop,
+                                      const curl_event_retry_budget_t *budget) {
+    if (!loop) return false;
+    if (!budget) {
+        loop->retry_budget_on = false;
+        return true;
+    }
+    if (budget->ratio < 0.0 || budget->min_per_sec < 0.0 || budget->burst < 0.0) {
+        fprintf(stderr, "[curl_event_loop_set_retry_budget] Negative budget.\n");
+        return false;
+    }
+    curl_event_retry_budget_t c = *budget;
+    if (c.ratio == 0.0) c.ratio = 0.1;
+    if (c.burst == 0.0) c.burst = 10.0;
+    loop->retry_budget = c;
+    loop->retry_budget_on = true;
+    return true;
+}
+
+/**
+ * Expire due timers into the priority lanes, then start ready requests
+ * lane by lane until the concurrency cap is reached.
+ */
+static void dispatch_ready_requests(curl_event_loop_t *loop) {
     uint64_t now = macro_now();
-    n = macro_map_first(root);
-    while (n) {
-        if (now < ((curl_event_loop_request_t *)n)->request.next_retry_at)
-            break;
-        if (!request_is_rate_limited(loop, &root, (curl_event_loop_request_t *)n)) {
-            if (!request_ready(loop, (curl_event_loop_request_t *)n)) {
-                break;
-            }
-            curl_event_loop_request_t *req = (curl_event_loop_request_t *)n;
-            macro_map_erase(&root, n);
-            curl_event_loop_request_start(req);
+    timer_node_t expired;
+    timer_list_init(&expired);
+    timer_wheel_advance(&loop->timers, now / 1000000ull, &expired);
+    while (!timer_list_empty(&expired)) {
+        timer_node_t *t = expired.next;
+        timer_list_unlink(t);
+        make_ready(loop, curl_wrap_from_timer(t), now);
+    }
+    fire_hedges(loop, now);
+    breaker_tick(loop, now);
+    if (loop->num_ready_requests == 0)
+        return;
+
+    age_lanes(loop, now);
+    expire_lanes(loop, now);
+
+    int lane;
+    while (loop->num_queued_requests < (int)loop->max_concurrent_requests &&
+           (lane = pick_lane(loop)) >= 0) {
+        curl_event_loop_request_t *req = curl_wrap_from_timer(loop->lanes[lane].next);
+        unlink_request(loop, req);
+        if (curl_event_cache_lookup(loop, req))
+            continue;   /* fresh: answered in the completion phase */
+        if (curl_event_coalesce_follow(loop, req))
+            continue;   /* rides a transfer already in flight */
+        if (!breaker_admit(loop, req, now))
+            continue;   /* failed fast, or parked until its breaker half-opens */
+        if (!host_acquire(loop, req))
+            continue;   /* parked until its host frees a slot */
+        if (request_waiting_on_dependencies(loop, req)) {
+            curl_event_host_release(loop, req);
+            curl_event_rate_release(req);
+            continue;   /* parked on a resource */
+        }
+        if (request_is_rate_limited(loop, req))
+            continue;   /* on the wheel, or queued on its key */
+
+        curl_event_lane_metrics_t *lm = &loop->metrics.lanes[lane];
+        uint64_t wait = now - req->ready_at;
+        lm->dispatched++;
+        lm->wait_ns_total += wait;
+        if (wait > lm->wait_ns_max) lm->wait_ns_max = wait;
+        retry_budget_earn(loop, req, now);
+        if (curl_event_loop_request_start(req)) {
+            curl_event_coalesce_lead(loop, req);
+            arm_hedge(loop, req, now);
         }
-        n = macro_map_first(root);
     }
-    n = macro_map_first(loop->rate_limited_requests);
-    while (n) {
-        macro_map_erase(&loop->rate_limited_requests, n);
-        curl_event_request_insert(&root, (curl_event_loop_request_t *)n);
-        n = macro_map_first(loop->rate_limited_requests);
+}
+
+static void record_connection_metrics(curl_event_loop_t *loop,
+                                      curl_event_loop_request_t *req, CURL *easy) {
+    char *ip = NULL;
+    curl_easy_getinfo(easy, CURLINFO_PRIMARY_IP, &ip);
+    if (!ip || !*ip) return;             /* no network connection (file://) */
+
+    long num_connects = 0;
+    curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &num_connects);
+    if (num_connects == 0) {
+        loop->metrics.connections_reused++;
+        return;
     }
-    loop->rate_limited_requests = root;
+    loop->metrics.connections_new++;
+
+    curl_off_t appconnect = 0;
+    curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME_T, &appconnect);
+    if (appconnect > 0) {
+        loop->metrics.tls_handshakes++;
+        if (req->tls_session_reused == 1)
+            loop->metrics.tls_resumed++;
+    }
+}
 
-    n = macro_map_first(loop->refresh_requests);
-    while (n) {
-        if (!request_is_rate_limited(loop, &loop->refresh_requests, (curl_event_loop_request_t *)n)) {
-            if (!request_ready(loop, (curl_event_loop_request_t *)n)) {
-                break;
-            }
-            curl_event_loop_request_t *req = (curl_event_loop_request_t *)n;
-            macro_map_erase(&loop->refresh_requests, n);
-            loop->num_refresh_requests--;
-            curl_event_loop_request_start(req);
-        } else
-            loop->num_refresh_requests--;
-        n = macro_map_first(loop->refresh_requests);
+/* When the server's Retry-After (usually on a 503) lets this request try
+   again; 0 if it sent none */
+static uint64_t retry_not_before(curl_event_loop_request_t *req, CURL *easy) {
+    int64_t wait = req->response.rate_hints.retry_after_ns;
+#if LIBCURL_VERSION_NUM >= 0x074200
+    if (wait < 0 && easy) {
+        curl_off_t secs = 0;    /* requests without a rate key: libcurl's parse */
+        if (curl_easy_getinfo(easy, CURLINFO_RETRY_AFTER, &secs) == CURLE_OK && secs > 0)
+            wait = (int64_t)secs * 1000000000ll;
     }
+#endif
+    return wait > 0 ? macro_now() + (uint64_t)wait : 0;
+}
 
-    n = macro_map_first(loop->inactive_requests);
-    while (n) {
-        if (!request_is_rate_limited(loop, &loop->inactive_requests, (curl_event_loop_request_t *)n)) {
-            if (!request_ready(loop, (curl_event_loop_request_t *)n)) {
-                break;
-            }
-            curl_event_loop_request_t *req = (curl_event_loop_request_t *)n;
-            macro_map_erase(&loop->inactive_requests, n);
-            loop->num_inactive_requests--;
-            curl_event_loop_request_start(req);
-        } else
-            loop->num_inactive_requests--;
-        n = macro_map_first(loop->inactive_requests);
+/**
+ * Run a finished attempt's callbacks and decide what happens next: retry,
+ * refresh or destroy.  Coalesced followers and cache hits normally hold
+ * no rate-limit slot of their own (req->rate_slot).
+ */
+static void finish_attempt(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                           CURL *easy, CURLcode result, long http_code) {
+    bool success = (result == CURLE_OK && http_code == 200);
+    int retry_in;
+    if (success) {
+        retry_in = req->request.on_complete(easy, &req->request);
+    } else {
+        retry_in = -1;
+        if (req->request.on_failure)
+            retry_in = req->request.on_failure(easy, result, http_code, &req->request);
+    }
+
+    // Handle 429: Too Many Requests.  Retry-After or the quota reset, when
+    // the server sent one, decides how long the key pauses.
+    if (req->rate_slot && http_code == 429) {
+        req->rate_slot = false;
+        retry_in = rate_key_handle_429(req->request.rate_key, &req->response.rate_hints);
+        req->request.next_retry_at = macro_now_add_seconds(retry_in);
+        curl_event_loop_request_cleanup(req);
+        curl_event_loop_schedule(loop, req);
+        return;
+    }
+
+    if (req->request.rate_key)
+        rate_key_apply_hints(req->request.rate_key, &req->response.rate_hints);
+    curl_event_rate_release(req);
+
+    uint64_t not_before = success ? 0 : retry_not_before(req, easy);
+    // A failure rescheduled by on_failure spends the retry budget like an
+    // on_retry retry does; a success asking to run again does not
+    if (retry_in > 0 && (success || retry_budget_take(loop, req))) {
+        req->request.next_retry_at = macro_now_add_seconds(retry_in);
+        if (req->request.next_retry_at < not_before)
+            req->request.next_retry_at = not_before;
+        curl_event_loop_request_cleanup(req);  // these don't count towards retries
+        curl_event_loop_schedule(loop, req);
+    } else if (retry_in < 0 && req->request.on_retry &&
+               req->request.on_retry(&req->request) &&
+               retry_budget_take(loop, req)) {
+        if (req->request.next_retry_at < not_before)
+            req->request.next_retry_at = not_before;
+        curl_event_loop_request_cleanup(req);
+        loop->metrics.retried_requests++;
+        curl_event_loop_schedule(loop, req);
+    } else {
+        if (success)
+            loop->metrics.completed_requests++;
+        else
+            loop->metrics.failed_requests++;
+        // Clean up resources
+        if (req->request.should_refresh) {
+            req->request.current_retries = 0;
+            curl_event_loop_request_cleanup(req);
+            curl_event_loop_schedule(loop, req);
+        } else {
+            curl_event_request_destroy(req);
+        }
     }
 }
 
@@ -410,64 +1657,76 @@ static void process_completed_requests(curl_event_loop_t *loop) {
             CURL *easy = msg->easy_handle;
             curl_event_loop_request_t *req = NULL;
             curl_easy_getinfo(easy, CURLINFO_PRIVATE, (void **)&req);
+            if (!req) continue;     /* hedge loser already recycled */
 
             long http_code = 0;
             curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_code);
             CURLcode result = msg->data.result;
+            uint64_t attempt_start = easy == req->hedge_easy
+                                   ? req->hedge_start_time
+                                   : req->request.request_start_time;
+
+            // A hedged request finishes with whichever attempt won the
+            // sink; if neither answered yet, a success wins and a failure
+            // leaves the other attempt running.
+            if (req->hedge_state == HEDGE_RACING || req->hedge_state == HEDGE_SETTLING) {
+                CURL *other = easy == req->easy_handle ? req->hedge_easy : req->easy_handle;
+                CURL *winner = req->hedge_winner;
+                if (!winner)
+                    winner = (result == CURLE_OK && curl_event_request_answered(req, http_code))
+                           ? easy : other;
+                curl_event_loop_request_settle_hedge(req, winner);
+                if (winner != easy)
+                    continue;
+            }
+            record_connection_metrics(loop, req, easy);
 
             // Remove handle from multi
-            macro_map_erase(&loop->queued_requests, (macro_map_t *)req);
-            loop->num_queued_requests--;
+            unlink_request(loop, req);
+
+            // Store a cacheable response, or replay the cached one on 304
+            http_code = curl_event_cache_complete(loop, req, &result, http_code);
 
             bool success = (result == CURLE_OK && http_code == 200);
-            int retry_in;
-            if (success) {
-                retry_in = req->request.on_complete(easy, &req->request);
-            } else {
-                retry_in = -1;
-                if (req->request.on_failure)
-                    retry_in = req->request.on_failure(easy, result, http_code, &req->request);
+            if (success && (req->request.hedge_delay_ms || req->request.hedge_percentile > 0.0)) {
+                latency_hist_t *h = request_latency(loop, req, true);
+                if (h) latency_hist_record(h, (macro_now() - attempt_start) / 1000ull);
             }
-
-            // Handle 429: Too Many Requests
-            if (http_code == 429 && req->request.rate_limit) {
-                retry_in = rate_manager_handle_429(req->request.rate_limit);
-                req->request.next_retry_at = macro_now_add_seconds(retry_in);
-                curl_event_request_insert(&loop->rate_limited_requests, req);
-                continue;
+            // Adaptive concurrency learns from every attempt that held a slot
+            if (req->request.rate_key) {
+                bool overloaded = http_code == 429 || http_code >= 500 ||
+                                  result == CURLE_OPERATION_TIMEDOUT;
+                rate_key_request_sample(req->request.rate_key,
+                                        macro_now() - attempt_start, overloaded);
             }
+            breaker_record(loop, req, attempt_failed(result, http_code), macro_now());
+            curl_event_stats_record(loop, req, request_host_key(req), easy, http_code);
 
-            if (req->request.rate_limit) {
-                rate_manager_request_done(req->request.rate_limit);
-            }
+            // Coalesced followers share this attempt's outcome
+            curl_event_loop_request_t *follower;
+            while ((follower = curl_event_coalesce_pop_follower(req)) != NULL)
+                finish_attempt(loop, follower, easy, result, http_code);
 
-            if (retry_in > 0) {
-                req->request.next_retry_at = macro_now_add_seconds(retry_in);
-                curl_event_loop_request_cleanup(req);  // these don't count towards retries
-                enqueue_request(loop, req);
-            } else if (retry_in < 0 && req->request.on_retry(&req->request)) {
-                curl_event_loop_request_cleanup(req);
-                loop->metrics.retried_requests++;
-                enqueue_request(loop, req);
-            } else {
-                if (success)
-                    loop->metrics.completed_requests++;
-                // Clean up resources
-                if (req->request.should_refresh) {
-                    req->request.current_retries = 0;
-                    curl_event_loop_request_cleanup(req);
-                    enqueue_request(loop, req);
-                } else {
-                    curl_event_request_destroy(req);
-                }
-            }
+            finish_attempt(loop, req, easy, result, http_code);
         }
     }
 
-    pthread_mutex_lock(&loop->mutex);
-    curl_event_loop_request_t *injected = loop->injected_requests;
-    loop->injected_requests = NULL; // Reset the injected queue
-    pthread_mutex_unlock(&loop->mutex);
+    // Fresh cache hits found by dispatch_ready_requests
+    while (!timer_list_empty(&loop->cache_ready)) {
+        curl_event_loop_request_t *req = curl_wrap_from_timer(loop->cache_ready.next);
+        unlink_request(loop, req);
+        CURLcode result = curl_event_cache_deliver(req);
+        finish_attempt(loop, req, NULL, result, result == CURLE_OK ? 200 : 0);
+    }
+
+    // Injected completions run in the order they were posted
+    curl_event_loop_request_t *injected = NULL;
+    while (loop->injected_requests) {
+        curl_event_loop_request_t *r = loop->injected_requests;
+        loop->injected_requests = r->next_pending;
+        r->next_pending = injected;
+        injected = r;
+    }
 
     while (injected) {
         curl_event_loop_request_t *next = injected->next_pending;
@@ -481,64 +1740,117 @@ static void process_completed_requests(curl_event_loop_t *loop) {
     }
 }
 
+static bool loop_is_idle(curl_event_loop_t *loop, int still_running) {
+    bool pending = loop->pending_requests || loop->injected_requests ||
+                   !mpsc_queue_empty(&loop->inbox);
+    return still_running == 0 && !pending &&
+           macro_map_first(loop->queued_requests) == NULL &&
+           loop->num_ready_requests == 0 &&
+           loop->num_breaker_parked == 0 &&
+           timer_list_empty(&loop->rate_waiting) &&
+           timer_wheel_count(&loop->timers) == 0;
+}
+
 /**
- * Run the event loop.
- * A simple approach that calls curl_multi_wait + curl_multi_perform in a loop.
- * More advanced usage would integrate with epoll, libuv, etc.
+ * One pass over every scheduling phase.  When dispatch_io is false the
+ * caller already handed socket readiness to libcurl (the EPOLL wait in
+ * curl_event_loop_run does this), so only completions are collected.
+ * Returns false when the loop should stop or has nothing left to do.
  */
-void curl_event_loop_run(curl_event_loop_t *loop) {
-    if (!loop) return;
+static bool loop_iteration(curl_event_loop_t *loop, bool dispatch_io) {
+    curl_resource_set_owner_thread(loop);
 
-    loop->keep_running = true;
+    /* Apply cross-thread resource ops before scheduling anything */
+    curl_resource_inbox_drain(loop);
+
+    // Allow user-defined loop logic (e.g., dynamically enqueue requests)
+    if (loop->on_loop && !loop->on_loop(loop, loop->on_loop_arg)) {
+        return false;
+    }
 
-    while (loop->keep_running) {
-        /* Apply cross-thread resource ops before scheduling anything */
-        curl_resource_set_owner_thread(loop);
+    // Process submitted, cancelled and requeued requests
+    process_inbox_and_pending_requests(loop);
 
-        // Allow user-defined loop logic (e.g., dynamically enqueue requests)
-        if (loop->on_loop && !loop->on_loop(loop, loop->on_loop_arg)) {
-            break;
-        }
+    // Fire due timers and start ready requests
+    dispatch_ready_requests(loop);
 
-        // Process pending and cancelled requests
-        process_cancelled_and_pending_requests(loop);
+    // Check if we have active requests in the multi_handle
+    int still_running = 0;
+    if (loop->backend == CURL_EVENT_BACKEND_EPOLL) {
+        if (dispatch_io)
+            curl_event_epoll_wait(loop, 0);
+    } else if (loop->num_queued_requests > 0) {
+        curl_multi_perform(loop->multi_handle, &still_running);
+    }
 
-        // Move ready requests from inactive to active queue
-        move_inactive_requests_to_queue(loop);
+    // Drop attempts that lost a hedge race, then handle completions
+    settle_hedges(loop);
+    process_completed_requests(loop);
 
-        // Check if we have active requests in the multi_handle
-        int still_running = 0;
-        if (loop->num_queued_requests > 0) {
-            curl_multi_perform(loop->multi_handle, &still_running);
-        }
+    /* Drain again in case completions posted resource ops (cheap no-op if empty) */
+    curl_resource_inbox_drain(loop);
 
-        // Handle completed requests
-        process_completed_requests(loop);
+    if (loop->backend == CURL_EVENT_BACKEND_EPOLL)
+        still_running = loop->num_multi_requests;
 
-        /* Drain again in case completions posted resource ops (cheap no-op if empty) */
-        curl_resource_inbox_drain(loop);
+    // Let other threads see this iteration's counters
+    curl_event_stats_publish(loop);
 
-        // Check if we should exit: no running transfers, no pending requests
-        if (still_running == 0 &&
-            loop->pending_requests == NULL &&
-            macro_map_first(loop->queued_requests) == NULL &&
-            macro_map_first(loop->refresh_requests) == NULL &&
-            macro_map_first(loop->inactive_requests) == NULL) {
-            break;
-        }
+    // Check if we should exit: no running transfers, no pending requests
+    return loop->keep_running &&
+           (loop->persistent || !loop_is_idle(loop, still_running));
+}
+
+bool curl_event_loop_step(curl_event_loop_t *loop) {
+    if (!loop) return false;
+    return loop_iteration(loop, true);
+}
+
+int curl_event_loop_fd(curl_event_loop_t *loop) {
+    if (!loop) return -1;
+    if (loop->backend != CURL_EVENT_BACKEND_EPOLL &&
+        !curl_event_loop_set_backend(loop, CURL_EVENT_BACKEND_EPOLL))
+        return -1;
+    return loop->epoll_fd;
+}
+
+long curl_event_loop_next_timeout_ms(curl_event_loop_t *loop) {
+    if (!loop) return -1;
+    if (atomic_load_explicit(&loop->res_inbox.head, memory_order_relaxed))
+        return 0;
+    if (loop->pending_requests || loop->injected_requests ||
+        !mpsc_queue_empty(&loop->inbox))
+        return 0;
+    return calculate_next_timer_expiry(loop, -1);
+}
+
+/**
+ * Run the event loop until it is idle or stopped.
+ * The POLL backend calls curl_multi_perform + curl_multi_poll in a loop.
+ * The EPOLL backend lets curl_event_epoll_wait() dispatch only the ready
+ * sockets via curl_multi_socket_action; completions are picked up by the
+ * next iteration.  Both waits return early on curl_event_loop_wake().
+ */
+void curl_event_loop_run(curl_event_loop_t *loop) {
+    if (!loop) return;
 
-        // Calculate next wait time
-        long wait_timeout_ms = calculate_next_timer_expiry(loop, 200);
+    loop->keep_running = true;
+
+    while (loop_iteration(loop, loop->backend != CURL_EVENT_BACKEND_EPOLL)) {
+        // Calculate next wait time; on_loop still runs at least every 200ms
+        long wait_timeout_ms = curl_event_loop_next_timeout_ms(loop);
+        if (wait_timeout_ms < 0 || wait_timeout_ms > 200)
+            wait_timeout_ms = 200;
 
-        // Wait for I/O readiness or timeout
-        if (loop->num_multi_requests > 0) {
+        // Wait for I/O readiness, a wakeup or the timeout
+        if (loop->backend == CURL_EVENT_BACKEND_EPOLL) {
+            curl_event_epoll_wait(loop, wait_timeout_ms);
+        } else {
             int num_fds = 0;
-            CURLMcode mc = curl_multi_poll(loop->multi_handle, NULL, 0, wait_timeout_ms, &num_fds);
+            CURLMcode mc = curl_multi_poll(loop->multi_handle, NULL, 0, (int)wait_timeout_ms, &num_fds);
             if (mc != CURLM_OK) {
                 fprintf(stderr, "curl_multi_poll() failed: %s\n", curl_multi_strerror(mc));
             }
-        } else if (wait_timeout_ms > 0) {
-            usleep(wait_timeout_ms * 1000); // Sleep when idle to prevent CPU spinning
         }
     }
 }
@@ -546,6 +1858,7 @@ void curl_event_loop_run(curl_event_loop_t *loop) {
 void curl_event_loop_stop(curl_event_loop_t *loop) {
     if (!loop) return;
     loop->keep_running = false;
+    curl_event_loop_wake(loop);
 }
 
 curl_event_metrics_t curl_event_loop_get_metrics(const curl_event_loop_t *loop) {
@@ -553,7 +1866,16 @@ curl_event_metrics_t curl_event_loop_get_metrics(const curl_event_loop_t *loop)
         curl_event_metrics_t empty = {0};
         return empty;
     }
-    return loop->metrics;
+    if (!pthread_equal(loop->owner_thread, pthread_self())) {
+        curl_event_loop_t *l = (curl_event_loop_t *)loop;   /* lock only */
+        pthread_mutex_lock(&l->stats_lock);
+        curl_event_metrics_t m = loop->published;
+        pthread_mutex_unlock(&l->stats_lock);
+        return m;
+    }
+    curl_event_metrics_t m = loop->metrics;
+    m.total_requests = atomic_load_explicit(&loop->total_requests, memory_order_relaxed);
+    return m;
 }
 
 /* New: submit a prebuilt, pooled request without copying */
@@ -567,19 +1889,22 @@ bool curl_event_loop_submit(curl_event_loop_t *loop,
     }
 
     curl_event_loop_request_t *req = curl_wrap_from_public(req_pub);
+    if (req->group && req->group->loop != loop) {
+        fprintf(stderr, "[curl_event_loop_submit] Request group belongs to another loop.\n");
+        return false;
+    }
     req->request.loop = loop;
 
     uint64_t now = macro_now();
-    req->request.next_retry_at = now - ((int64_t)priority * 1000000000LL);
+    if (priority != 0)
+        req->request.priority = priority;   /* picks the lane */
+    req->request.next_retry_at = now;
     req->request.start_time = req->request.next_retry_at;
     req->request.request_start_time = req->request.next_retry_at;
 
-    pthread_mutex_lock(&loop->mutex);
-    req->is_pending = true;
-    req->next_pending = loop->pending_requests;
-    loop->pending_requests = req;
-    loop->metrics.total_requests++;
-    pthread_mutex_unlock(&loop->mutex);
+    atomic_store(&req->is_pending, true);
+    atomic_fetch_add_explicit(&loop->total_requests, 1, memory_order_relaxed);
+    curl_event_loop_post(loop, &req->submit_msg, LOOP_MSG_SUBMIT);
 
     return true;
 }
@@ -79,12 +79,26 @@ static bool default_calculate_retry_enhanced(curl_event_request_t *req) {
                                                req->max_backoff_delay_ms,
                                                req->full_jitter);
         uint64_t now = macro_now();
+        if (req->deadline) {
+            /* leave the retry at least half of what is left of the budget */
+            if (req->deadline <= now) return false;
+            uint64_t budget_ms = (req->deadline - now) / 1000000ull;
+            if (delay_ms > budget_ms / 2) delay_ms = budget_ms / 2;
+        }
         req->next_retry_at = now + (delay_ms * 1000000ull);
         return true;
     }
     return false;
 }
 
+const char *curl_event_strerror(CURLcode code) {
+    if (code == CURL_EVENT_E_DEADLINE)
+        return "Request deadline exceeded";
+    if (code == CURL_EVENT_E_CIRCUIT_OPEN)
+        return "Circuit breaker open";
+    return curl_easy_strerror(code);
+}
+
 static size_t default_on_write(void *data, size_t size, size_t nmemb, curl_event_request_t *req) {
     curl_sink_interface_t *sink = (curl_sink_interface_t *)req->sink_data;
     if(sink) {
@@ -178,12 +192,19 @@ curl_event_request_t *curl_event_request_init(size_t pool_size) {
 
     req->dep_head              = NULL;
     req->rate_limit            = NULL;
+    req->rate_key              = NULL;
     req->rate_limit_high_priority = false;
+    req->rate_limited_by       = NULL;
 
     req->connect_timeout       = 0;
     req->transfer_timeout      = 0;
     req->low_speed_limit       = 0;
     req->low_speed_time        = 0;
+    req->deadline              = 0;
+    req->hedge_delay_ms        = 0;
+    req->hedge_percentile      = 0.0;
+    req->coalesce              = false;
+    req->coalesce_key          = NULL;
 
     req->max_retries           = 0;
     req->backoff_factor        = 2.0;
@@ -218,16 +239,39 @@ curl_event_request_t *curl_event_request_init(size_t pool_size) {
     req->refresh_backoff_on_errors = true;
 
     /* Private wrapper flags */
-    wrap->content_length_found = false;
-    wrap->content_length       = -1;
+    wrap->response.content_length_found = false;
+    wrap->response.content_length       = -1;
     wrap->is_injected          = false;
     wrap->is_cancelled         = false;
-    wrap->is_pending           = false;
+    atomic_init(&wrap->is_pending, false);
+    atomic_init(&wrap->cancel_requested, false);
     wrap->deps_retained        = false;
     wrap->multi_handle         = NULL;
     wrap->easy_handle          = NULL;
-    wrap->next_cancelled       = NULL;
     wrap->next_pending         = NULL;
+    wrap->prev_pending         = NULL;
+    wrap->blocked_on           = NULL;
+    wrap->group                = NULL;
+    wrap->group_prev           = NULL;
+    wrap->group_next           = NULL;
+    wrap->group_linked         = false;
+    wrap->hedge_easy           = NULL;
+    wrap->hedge_winner         = NULL;
+    wrap->hedge_state          = HEDGE_IDLE;
+    wrap->hedge_start_time     = 0;
+    wrap->hedge_key            = NULL;
+    wrap->host_slot            = NULL;
+    memset(&wrap->rate_waiter, 0, sizeof(wrap->rate_waiter));
+    wrap->rate_slot            = false;
+    wrap->rate_granted         = false;
+    rate_manager_hints_init(&wrap->response.rate_hints);
+    wrap->host_key             = NULL;
+    wrap->flight               = NULL;
+    wrap->variant_key          = NULL;
+    wrap->cache_entry          = NULL;
+    wrap->cache_headers        = NULL;
+    wrap->cache_body           = NULL;
+    wrap->cache_capture        = false;
     wrap->bytes_downloaded     = 0;
 
     req->json_root              = NULL;
@@ -242,6 +286,10 @@ void curl_event_request_destroy_unsubmitted(curl_event_request_t *req_pub) {
     if (!req_pub) return;
     curl_event_loop_request_t *wrap = wrap_from_public(req_pub);
 
+    if (wrap->group) {
+        curl_event_group_release(wrap->group);
+        wrap->group = NULL;
+    }
     if (req_pub->headers) {
         curl_slist_free_all(req_pub->headers);
         req_pub->headers = NULL;
@@ -332,20 +380,23 @@ static bool setup_curl_handle(curl_event_loop_request_t *req, curl_event_loop_t
 static size_t write_thunk(void *ptr, size_t size, size_t nmemb, void *sink_data);
 static size_t header_callback(char *buffer, size_t size, size_t nitems, void *sink_data);
 
-curl_event_request_t *
-curl_event_request_submit(curl_event_loop_t *loop,
-                          curl_event_request_t *req_pub,
-                          int priority)
+bool curl_event_request_prepare_submit(curl_event_loop_t *loop,
+                                       curl_event_request_t *req_pub,
+                                       int priority)
 {
     if (!loop || !req_pub || !req_pub->url) {
         fprintf(stderr, "[curl_event_request_submit] Invalid arguments.\n");
-        return NULL;
+        return false;
     }
 
     curl_event_loop_request_t *wrap = wrap_from_public(req_pub);
     if (wrap->is_pending || wrap->multi_handle) {
         fprintf(stderr, "[curl_event_request_submit] Request already submitted.\n");
-        return NULL;
+        return false;
+    }
+    if (wrap->group && wrap->group->loop != loop) {
+        fprintf(stderr, "[curl_event_request_submit] Request group belongs to another loop.\n");
+        return false;
     }
 
     /* finalize some inferred defaults here */
@@ -362,19 +413,26 @@ curl_event_request_submit(curl_event_loop_t *loop,
     req_pub->start_time          = req_pub->next_retry_at;
     req_pub->request_start_time  = req_pub->next_retry_at;
 
-    int pri = (priority != 0) ? priority : req_pub->priority;
-    if (pri != 0) {
-        /* higher priority → sooner: subtract seconds in nanoseconds, clamp */
-        uint64_t adj = (uint64_t)((int64_t)pri > 0 ? (int64_t)pri : 0) * 1000000000ull;
-        if (adj < req_pub->next_retry_at) req_pub->next_retry_at -= adj;
-    }
+    /* priority picks the lane (see CURL_EVENT_PRIORITY_LANES) */
+    if (priority != 0)
+        req_pub->priority = priority;
 
-    pthread_mutex_lock(&loop->mutex);
-    wrap->is_pending    = true;
-    wrap->next_pending  = loop->pending_requests;
-    loop->pending_requests = wrap;
-    loop->metrics.total_requests++;
-    pthread_mutex_unlock(&loop->mutex);
+    atomic_store(&wrap->is_pending, true);
+    wrap->submit_msg.kind = LOOP_MSG_SUBMIT;
+    return true;
+}
+
+curl_event_request_t *
+curl_event_request_submit(curl_event_loop_t *loop,
+                          curl_event_request_t *req_pub,
+                          int priority)
+{
+    if (!curl_event_request_prepare_submit(loop, req_pub, priority))
+        return NULL;
+
+    curl_event_loop_request_t *wrap = wrap_from_public(req_pub);
+    atomic_fetch_add_explicit(&loop->total_requests, 1, memory_order_relaxed);
+    curl_event_loop_post(loop, &wrap->submit_msg, LOOP_MSG_SUBMIT);
 
     return req_pub;
 }
@@ -384,18 +442,37 @@ curl_event_request_submit(curl_event_loop_t *loop,
    (called from the loop; signatures unchanged)
    ──────────────────────────────────────────────────────────────────── */
 
+static void hedge_reset(curl_event_loop_request_t *req) {
+    curl_event_loop_t *loop = req->request.loop;
+    if (req->hedge_state == HEDGE_ARMED)
+        timer_wheel_remove(&loop->hedge_timers, &req->hedge_timer);
+    else if (req->hedge_state == HEDGE_SETTLING)
+        timer_list_unlink(&req->hedge_timer);
+    if (req->hedge_easy) {
+        curl_multi_remove_handle(loop->multi_handle, req->hedge_easy);
+        loop->num_multi_requests--;
+        curl_event_loop_easy_release(loop, req->hedge_easy);
+        req->hedge_easy = NULL;
+    }
+    req->hedge_winner = NULL;
+    req->hedge_state  = HEDGE_IDLE;
+}
+
 void curl_event_loop_request_cleanup(curl_event_loop_request_t *req) {
+    if (req->hedge_state != HEDGE_IDLE)
+        hedge_reset(req);
     if (req->easy_handle) {
         if (req->multi_handle) {
             curl_multi_remove_handle(req->multi_handle, req->easy_handle);
             req->request.loop->num_multi_requests--;
         }
-        curl_easy_cleanup(req->easy_handle);
+        curl_event_loop_easy_release(req->request.loop, req->easy_handle);
         req->easy_handle  = NULL;
         req->multi_handle = NULL;
     }
-    req->content_length_found = false;
-    req->content_length       = -1;
+    curl_event_cache_release(req);
+    req->response.content_length_found = false;
+    req->response.content_length       = -1;
     req->bytes_downloaded     = 0;
 }
 
@@ -405,11 +482,30 @@ void curl_event_request_destroy(curl_event_loop_request_t *req) {
     /* tear down libcurl handles */
     curl_event_loop_request_cleanup(req);
 
+    /* followers only exist while their leader is in flight (teardown) */
+    if (req->flight && req->flight->leader == req) {
+        curl_event_coalesce_forget(req->request.loop, req);
+        curl_event_loop_request_t *follower;
+        while ((follower = curl_event_coalesce_pop_follower(req)) != NULL)
+            curl_event_request_destroy(follower);
+    }
+
+    /* a ready request may hold a slot handed over by its host or key */
+    curl_event_host_release(req->request.loop, req);
+    curl_event_rate_release(req);
+    curl_event_breaker_release(req->request.loop, req);
+
     if (req->deps_retained) {
         curl_resource_release_request_deps(req->request.loop, &req->request);
         req->deps_retained = false;
     }
 
+    if (req->group) {
+        curl_event_group_unlink(req);
+        curl_event_group_release(req->group);
+        req->group = NULL;
+    }
+
     if (req->request.headers) {
         curl_slist_free_all(req->request.headers);
         req->request.headers = NULL;
@@ -432,7 +528,7 @@ void curl_event_request_destroy(curl_event_loop_request_t *req) {
 }
 
 /* Enforce max_download_size in body phase; call user write_cb if allowed */
-static size_t write_thunk(void *ptr, size_t size, size_t nmemb, void *sink_data) {
+static size_t deliver_body(void *ptr, size_t size, size_t nmemb, void *sink_data) {
     curl_event_request_t *pub = (curl_event_request_t *)sink_data;
     curl_event_loop_request_t *req = wrap_from_public(pub);
     size_t total = size * nmemb;
@@ -455,16 +551,96 @@ static size_t write_thunk(void *ptr, size_t size, size_t nmemb, void *sink_data)
     return pub->write_cb(ptr, size, nmemb, pub);
 }
 
-/* Robust header parser for Content-Length with limits */
-static size_t header_callback(char *buffer, size_t size, size_t nitems, void *sink_data) {
-    size_t total_size = size * nitems;
-    curl_event_loop_request_t *req = (curl_event_loop_request_t *)sink_data;
+/* Hedged attempts race for the sink: the first to deliver body bytes of
+   an answer (curl_event_request_answered) wins, taking over the headers
+   it parsed, and the loop removes the other once libcurl returns
+   (handles cannot be removed from inside a callback). */
+static void hedge_claim(curl_event_loop_request_t *req, CURL *easy) {
+    req->hedge_winner = easy;
+    req->hedge_state  = HEDGE_SETTLING;
+    if (easy == req->hedge_easy)
+        req->response = req->hedge_response;
+    timer_list_append(&req->request.loop->hedge_losers, &req->hedge_timer);
+}
+
+/* A coalescing leader hands each chunk it accepted to its followers */
+static size_t deliver_to_flight(void *ptr, size_t size, size_t nmemb,
+                                curl_event_loop_request_t *req) {
+    size_t n = deliver_body(ptr, size, nmemb, &req->request);
+    if (n == size * nmemb)
+        curl_event_cache_capture(req, ptr, n);
+    coalesce_flight_t *f = req->flight;
+    if (f && f->leader == req && n == size * nmemb) {
+        for (timer_node_t *t = f->followers.next; t != &f->followers; t = t->next) {
+            curl_event_loop_request_t *follower = curl_wrap_from_timer(t);
+            follower->response.content_length       = req->response.content_length;
+            follower->response.content_length_found = req->response.content_length_found;
+            deliver_body(ptr, size, nmemb, &follower->request);
+        }
+    }
+    return n;
+}
+
+size_t curl_event_loop_request_deliver(curl_event_loop_request_t *req,
+                                       const void *data, size_t len) {
+    return deliver_to_flight((void *)data, 1, len, req);
+}
+
+/* True if attempt `easy` may write to the sink.  Otherwise *ret is 0 to
+   abort an attempt that lost the race, or stays the chunk's length to drop
+   the body of one that is not an answer while the other keeps racing. */
+static bool hedge_may_deliver(curl_event_loop_request_t *req, CURL *easy, size_t *ret) {
+    if (req->hedge_state != HEDGE_RACING && req->hedge_state != HEDGE_SETTLING)
+        return true;
+    if (req->hedge_winner == easy)
+        return true;
+    if (req->hedge_winner) {
+        *ret = 0;
+        return false;
+    }
+    long http_code = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_code);
+    if (!curl_event_request_answered(req, http_code))
+        return false;
+    hedge_claim(req, easy);
+    return true;
+}
+
+static size_t write_thunk(void *ptr, size_t size, size_t nmemb, void *sink_data) {
+    curl_event_loop_request_t *req = wrap_from_public((curl_event_request_t *)sink_data);
+    size_t ret = size * nmemb;
+    if (!hedge_may_deliver(req, req->easy_handle, &ret))
+        return ret;
+    return deliver_to_flight(ptr, size, nmemb, req);
+}
+
+static size_t hedge_write_thunk(void *ptr, size_t size, size_t nmemb, void *sink_data) {
+    curl_event_loop_request_t *req = wrap_from_public((curl_event_request_t *)sink_data);
+    size_t ret = size * nmemb;
+    if (!hedge_may_deliver(req, req->hedge_easy, &ret))
+        return ret;
+    return deliver_to_flight(ptr, size, nmemb, req);
+}
+
+/* Robust header parser for Content-Length with limits; also feeds the
+   cache and the rate-limit hints */
+static size_t parse_header(curl_event_loop_request_t *req, attempt_response_t *r,
+                           char *buffer, size_t total_size) {
     char *line = (char *)aml_calloc(1, total_size + 1);
     if (!line) return total_size;
     memcpy(line, buffer, total_size);
     line[total_size] = '\0';
     rtrim_inplace(line);
 
+    if (req->cache_capture)
+        curl_event_cache_header(req, &r->cache_meta, line);
+    if (req->request.rate_key) {
+        if (strncmp(line, "HTTP/", 5) == 0)
+            rate_manager_hints_init(&r->rate_hints);   /* a new response */
+        else
+            rate_manager_parse_header(&r->rate_hints, line);
+    }
+
     /* Case-insensitive check for "Content-Length:" */
     const char *p = line;
     if (strncasecmp(p, "Content-Length", 14) == 0) {
@@ -477,8 +653,8 @@ static size_t header_callback(char *buffer, size_t size, size_t nitems, void *si
             cl = cl * 10 + (*p - '0');
             if (cl < 0) { cl = -1; break; }
         }
-        req->content_length_found = true;
-        req->content_length = cl;
+        r->content_length_found = true;
+        r->content_length = cl;
 
         if (cl > req->request.max_download_size && req->request.max_download_size > 0) {
             fprintf(stderr, "[curl_event_loop] Content-Length exceeds max_download_size (%ld > %ld)\n",
@@ -492,31 +668,47 @@ static size_t header_callback(char *buffer, size_t size, size_t nitems, void *si
     return total_size;
 }
 
-/* Sets up the easy handle based on the public request fields. */
-static bool setup_curl_handle(curl_event_loop_request_t *req, curl_event_loop_t *loop) {
-    req->easy_handle          = NULL;
-    req->content_length_found = false;
-    req->content_length       = -1;
-    req->bytes_downloaded     = 0;
-
-    if (req->request.on_prepare) {
-        if (!req->request.on_prepare(&req->request))
-            return false;
-    }
-
-    req->easy_handle = curl_easy_init();
-    if (!req->easy_handle) {
-        fprintf(stderr, "[setup_curl_handle] curl_easy_init failed.\n");
-        return false;
-    }
-
-    curl_easy_setopt(req->easy_handle, CURLOPT_URL, req->request.url);
-    curl_easy_setopt(req->easy_handle, CURLOPT_ACCEPT_ENCODING, "");
+static size_t header_callback(char *buffer, size_t size, size_t nitems, void *sink_data) {
+    curl_event_loop_request_t *req = (curl_event_loop_request_t *)sink_data;
+    if ((req->hedge_state == HEDGE_RACING || req->hedge_state == HEDGE_SETTLING) &&
+        req->hedge_winner == req->hedge_easy)
+        return size * nitems;   /* the hedge won */
+    return parse_header(req, &req->response, buffer, size * nitems);
+}
 
-    if (req->request.max_download_size > 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_HEADERFUNCTION, header_callback);
-        curl_easy_setopt(req->easy_handle, CURLOPT_HEADERDATA, req);
+/* Until it wins, a hedge keeps what it parsed apart from the primary's */
+static size_t hedge_header_callback(char *buffer, size_t size, size_t nitems, void *sink_data) {
+    curl_event_loop_request_t *req = (curl_event_loop_request_t *)sink_data;
+    attempt_response_t *r = &req->response;
+    if (req->hedge_state == HEDGE_RACING || req->hedge_state == HEDGE_SETTLING) {
+        if (!req->hedge_winner)
+            r = &req->hedge_response;
+        else if (req->hedge_winner != req->hedge_easy)
+            return size * nitems;   /* the primary won */
     }
+    return parse_header(req, r, buffer, size * nitems);
+}
+
+#if LIBCURL_VERSION_NUM >= 0x075000
+/* Runs once the connection is up, before the request is sent: the only
+   point where the TLS object for this attempt is guaranteed to be live. */
+static int prereq_callback(void *clientp, char *conn_primary_ip, char *conn_local_ip,
+                           int conn_primary_port, int conn_local_port) {
+    (void)conn_primary_ip; (void)conn_local_ip;
+    (void)conn_primary_port; (void)conn_local_port;
+    curl_event_loop_request_t *req = (curl_event_loop_request_t *)clientp;
+    req->tls_session_reused = curl_event_tls_session_reused(req->easy_handle);
+    return CURL_PREREQFUNC_OK;
+}
+#endif
+
+/* Options shared by the primary attempt and a hedge (see
+   curl_event_loop_request_hedge): everything derived from the public
+   request fields. */
+static void configure_easy(curl_event_loop_request_t *req, curl_event_loop_t *loop,
+                           CURL *easy) {
+    curl_easy_setopt(easy, CURLOPT_URL, req->request.url);
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
 
     /* If a JSON root exists and body not set, stringify now */
     if (req->request.json_root && !req->request.post_data) {
@@ -526,43 +718,56 @@ static bool setup_curl_handle(curl_event_loop_request_t *req, curl_event_loop_t
     const char *method = req->request.method ? req->request.method
                         : (req->request.post_data ? "POST" : "GET");
     if (strcasecmp(method, "POST") == 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_POST, 1L);
+        curl_easy_setopt(easy, CURLOPT_POST, 1L);
         if (req->request.post_data) {
-            curl_easy_setopt(req->easy_handle, CURLOPT_POSTFIELDS, req->request.post_data);
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, req->request.post_data);
         }
     } else if (strcasecmp(method, "PUT") == 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(easy, CURLOPT_UPLOAD, 1L);
         if (req->request.post_data) {
             /* For simple PUT with known buffer; libcurl will read from memory */
-            curl_easy_setopt(req->easy_handle, CURLOPT_POSTFIELDS, req->request.post_data);
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, req->request.post_data);
         }
     } else if (strcasecmp(method, "DELETE") == 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, "DELETE");
     } else if (strcasecmp(method, "PATCH") == 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_CUSTOMREQUEST, "PATCH");
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, "PATCH");
         if (req->request.post_data) {
-            curl_easy_setopt(req->easy_handle, CURLOPT_POSTFIELDS, req->request.post_data);
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, req->request.post_data);
         }
     } else {
         /* default GET */
     }
 
-    if (req->request.headers) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_HTTPHEADER, req->request.headers);
+    if (req->cache_headers) {
+        /* revalidating a cached response: headers plus validators */
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, req->cache_headers);
+    } else if (req->request.headers) {
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, req->request.headers);
     }
 
     /* Timeouts / speed limits */
     if (req->request.connect_timeout > 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_CONNECTTIMEOUT, req->request.connect_timeout);
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, req->request.connect_timeout);
     }
     if (req->request.transfer_timeout > 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_TIMEOUT, req->request.transfer_timeout);
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT, req->request.transfer_timeout);
+    }
+    if (req->request.deadline) {
+        /* the attempt may not outlive the deadline; dispatch already
+           dropped requests whose deadline has passed */
+        uint64_t now = macro_now();
+        long left_ms = req->request.deadline > now
+                     ? (long)((req->request.deadline - now + 999999ull) / 1000000ull) : 1;
+        if (req->request.transfer_timeout <= 0 ||
+            left_ms < req->request.transfer_timeout * 1000L)
+            curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, left_ms);
     }
     if (req->request.low_speed_limit > 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_LOW_SPEED_LIMIT, req->request.low_speed_limit);
+        curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, req->request.low_speed_limit);
     }
     if (req->request.low_speed_time > 0) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_LOW_SPEED_TIME, req->request.low_speed_time);
+        curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME, req->request.low_speed_time);
     }
 
     /* HTTP/3 selection: loop default unless overridden per request */
@@ -570,32 +775,76 @@ static bool setup_curl_handle(curl_event_loop_request_t *req, curl_event_loop_t
     if (req->request.http3_override == 0) use_http3 = false;
     if (req->request.http3_override == 1) use_http3 = true;
     if (use_http3) {
-        curl_easy_setopt(req->easy_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_3);
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_3);
     }
 
+    /* Wait for a TLS connection that may multiplex (ALPN h2) instead of
+       opening another; cleartext HTTP never negotiates h2 */
+    if (loop->multiplex && strncasecmp(req->request.url, "https://", 8) == 0)
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+
     /* Write thunk that enforces max_download_size then calls user cb */
-    curl_easy_setopt(req->easy_handle, CURLOPT_WRITEFUNCTION, write_thunk);
-    curl_easy_setopt(req->easy_handle, CURLOPT_WRITEDATA, &req->request);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_thunk);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &req->request);
 
     /* Back-pointer */
-    curl_easy_setopt(req->easy_handle, CURLOPT_PRIVATE, req);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, req);
+
+    /* Shared handle (see curl_event_loop_set_share_profile) */
+    curl_easy_setopt(easy, CURLOPT_SHARE, loop->shared_handle);
+}
+
+/* Sets up the easy handle based on the public request fields. */
+static bool setup_curl_handle(curl_event_loop_request_t *req, curl_event_loop_t *loop) {
+    req->easy_handle          = NULL;
+    req->response.content_length_found = false;
+    req->response.content_length       = -1;
+    req->bytes_downloaded     = 0;
+    req->tls_session_reused   = -1;
+
+    if (req->request.on_prepare) {
+        if (!req->request.on_prepare(&req->request))
+            return false;
+    }
+
+    req->easy_handle = curl_event_loop_easy_acquire(loop);
+    if (!req->easy_handle) {
+        fprintf(stderr, "[setup_curl_handle] curl_easy_init failed.\n");
+        return false;
+    }
 
-    /* Shared handle (DNS cache) */
-    curl_easy_setopt(req->easy_handle, CURLOPT_SHARE, loop->shared_handle);
+    curl_event_cache_prepare(loop, req);
+    configure_easy(req, loop, req->easy_handle);
+
+    /* Content-Length, cache and rate-limit headers; a hedge parses its
+       own (curl_event_loop_request_hedge) */
+    rate_manager_hints_init(&req->response.rate_hints);
+    if (req->request.max_download_size > 0 || req->cache_capture || req->request.rate_key) {
+        curl_easy_setopt(req->easy_handle, CURLOPT_HEADERFUNCTION, header_callback);
+        curl_easy_setopt(req->easy_handle, CURLOPT_HEADERDATA, req);
+    }
+
+#if LIBCURL_VERSION_NUM >= 0x075000
+    curl_easy_setopt(req->easy_handle, CURLOPT_PREREQFUNCTION, prereq_callback);
+    curl_easy_setopt(req->easy_handle, CURLOPT_PREREQDATA, req);
+#endif
     return true;
 }
 
 bool curl_event_loop_request_start(curl_event_loop_request_t *req) {
     curl_event_loop_t *loop = req->request.loop;
 
-    if (req->request.rate_limit) {
-        uint64_t next = rate_manager_start_request(
-            req->request.rate_limit, req->request.rate_limit_high_priority);
+    /* dispatch normally took the slot already */
+    if (req->request.rate_key && !req->rate_slot) {
+        uint64_t next = rate_key_acquire(
+            req->request.rate_key, req->request.rate_limit_high_priority, NULL);
         if (next) {
-            req->request.next_retry_at = next;
-            curl_event_request_insert(&loop->rate_limited_requests, req);
+            /* next is a delay, not a timestamp */
+            req->request.next_retry_at = macro_now() + next;
+            curl_event_loop_schedule(loop, req);
             return false;
         }
+        req->rate_slot = true;
     }
 
     if (!setup_curl_handle(req, loop)) {
@@ -610,9 +859,58 @@ bool curl_event_loop_request_start(curl_event_loop_request_t *req) {
     req->multi_handle = loop->multi_handle;
     curl_event_request_insert(&loop->queued_requests, req);
     loop->num_queued_requests++;
+    req->where = REQ_WHERE_ACTIVE;
     return true;
 }
 
+bool curl_event_loop_request_hedge(curl_event_loop_request_t *req) {
+    curl_event_loop_t *loop = req->request.loop;
+    CURL *easy = curl_event_loop_easy_acquire(loop);
+    if (!easy) return false;
+
+    configure_easy(req, loop, easy);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, hedge_write_thunk);
+    /* a hedge should not queue behind the attempt it races */
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 0L);
+    /* the status line resets the cache directives */
+    req->hedge_response.content_length_found = false;
+    req->hedge_response.content_length       = -1;
+    rate_manager_hints_init(&req->hedge_response.rate_hints);
+    if (req->request.max_download_size > 0 || req->cache_capture || req->request.rate_key) {
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, hedge_header_callback);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, req);
+    }
+    curl_multi_add_handle(loop->multi_handle, easy);
+    loop->num_multi_requests++;
+    req->hedge_easy       = easy;
+    req->hedge_winner     = NULL;
+    req->hedge_start_time = macro_now();
+    req->hedge_state      = HEDGE_RACING;
+    return true;
+}
+
+void curl_event_loop_request_settle_hedge(curl_event_loop_request_t *req, CURL *winner) {
+    curl_event_loop_t *loop = req->request.loop;
+    if (req->hedge_state == HEDGE_SETTLING)
+        timer_list_unlink(&req->hedge_timer);
+
+    CURL *loser = (winner == req->easy_handle) ? req->hedge_easy : req->easy_handle;
+    if (winner == req->hedge_easy) {
+        loop->metrics.hedges_won++;
+        if (req->hedge_winner != winner)   /* won without writing: adopt now */
+            req->response = req->hedge_response;
+    }
+    if (loser) {
+        curl_multi_remove_handle(loop->multi_handle, loser);
+        loop->num_multi_requests--;
+        curl_event_loop_easy_release(loop, loser);
+    }
+    req->easy_handle  = winner;
+    req->hedge_easy   = NULL;
+    req->hedge_winner = NULL;
+    req->hedge_state  = HEDGE_DONE;
+}
+
 void curl_event_request_apply_browser_profile(curl_event_request_t *r,
                                               const char *ua_opt,
                                               const char *al_opt)
@@ -662,17 +960,17 @@ double curl_event_request_time_spent_on_request(const curl_event_request_t *r) {
 
 long curl_event_request_content_length(curl_event_request_t *r) {
     curl_event_loop_request_t *req = wrap_from_public(r);
-    if (!req->content_length_found) {
+    if (!req->response.content_length_found) {
         curl_off_t content_length = 0;
         if (req->easy_handle) {
             curl_easy_getinfo(req->easy_handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length);
             if (content_length >= 0) {
-                req->content_length = (long)content_length;
+                req->response.content_length = (long)content_length;
             }
         }
-        req->content_length_found = true;
+        req->response.content_length_found = true;
     }
-    return req->content_length;
+    return req->response.content_length;
 }
 
 /* ────────────────────────────────────────────────────────────────────
@@ -764,7 +1062,9 @@ void curl_event_request_set_headerf(curl_event_request_t *req,
 /* Rate limiting */
 void curl_event_request_rate_limit(curl_event_request_t *req,
                                    const char *key, bool high_priority) {
-    req->rate_limit = aml_pool_strdup(req->pool, key);
+    // Resolved once here so the loop never looks the key up again
+    req->rate_key = rate_manager_key(key);
+    req->rate_limit = (char *)rate_key_name(req->rate_key);
     req->rate_limit_high_priority = high_priority;
 }
 
@@ -781,6 +1081,27 @@ void curl_event_request_low_speed(curl_event_request_t *req,
     req->low_speed_time  = time_secs;
 }
 
+/* Deadline */
+void curl_event_request_deadline(curl_event_request_t *req, uint64_t deadline_ns) {
+    req->deadline = deadline_ns;
+}
+void curl_event_request_deadline_in(curl_event_request_t *req, uint64_t budget_ms) {
+    req->deadline = macro_now() + budget_ms * 1000000ull;
+}
+
+/* Coalescing */
+void curl_event_request_coalesce(curl_event_request_t *req, const char *key) {
+    req->coalesce     = true;
+    req->coalesce_key = key ? aml_pool_strdup(req->pool, key) : NULL;
+}
+
+/* Hedging */
+void curl_event_request_hedge(curl_event_request_t *req,
+                              uint64_t delay_ms, double percentile) {
+    req->hedge_delay_ms   = delay_ms;
+    req->hedge_percentile = percentile > 1.0 ? 1.0 : percentile;
+}
+
 /* Retry policy (simple) */
 void curl_event_request_max_retries(curl_event_request_t *req, int max_retries) {
     req->max_retries = max_retries;
@@ -0,0 +1,270 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* pthread_setaffinity_np */
+#endif
+
+#include "a-curl-library/curl_event_runtime.h"
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+
+enum {
+    RUNTIME_RUNNING  = 0,
+    RUNTIME_DRAINING = 1,   /* shards exit once idle */
+    RUNTIME_STOPPING = 2    /* shards exit at the next iteration */
+};
+
+typedef struct runtime_shard_s {
+    struct curl_event_runtime_s *rt;
+    curl_event_loop_t *loop;
+    pthread_t thread;
+    size_t index;
+} runtime_shard_t;
+
+struct curl_event_runtime_s {
+    runtime_shard_t *shards;
+    size_t num_loops;
+    bool   pin_threads;
+    bool   started;
+    _Atomic int state;
+};
+
+/* Runs on each shard thread once per iteration */
+static bool runtime_on_loop(curl_event_loop_t *loop, void *arg) {
+    runtime_shard_t *shard = (runtime_shard_t *)arg;
+    int state = atomic_load_explicit(&shard->rt->state, memory_order_acquire);
+    if (state == RUNTIME_STOPPING)
+        return false;
+    if (state == RUNTIME_DRAINING)
+        loop->persistent = false;
+    return true;
+}
+
+static void *runtime_thread_main(void *arg) {
+    runtime_shard_t *shard = (runtime_shard_t *)arg;
+#ifdef __linux__
+    if (shard->rt->pin_threads) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        if (ncpu > 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET((int)(shard->index % (size_t)ncpu), &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+    }
+#endif
+    curl_event_loop_run(shard->loop);
+    return NULL;
+}
+
+curl_event_runtime_t *curl_event_runtime_init(size_t num_loops, bool pin_threads) {
+    if (num_loops == 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        num_loops = ncpu > 0 ? (size_t)ncpu : 1;
+    }
+
+    curl_event_runtime_t *rt = (curl_event_runtime_t *)aml_calloc(1, sizeof(*rt));
+    if (!rt) {
+        fprintf(stderr, "[curl_event_runtime_init] Memory allocation failed.\n");
+        return NULL;
+    }
+    rt->shards = (runtime_shard_t *)aml_calloc(num_loops, sizeof(runtime_shard_t));
+    if (!rt->shards) {
+        fprintf(stderr, "[curl_event_runtime_init] Memory allocation failed.\n");
+        aml_free(rt);
+        return NULL;
+    }
+    rt->pin_threads = pin_threads;
+    atomic_init(&rt->state, RUNTIME_RUNNING);
+
+    /* the shards share one descriptor table */
+    size_t budget = curl_event_fd_budget() / num_loops;
+    if (!budget) budget = 1;
+
+    for (size_t i = 0; i < num_loops; i++) {
+        runtime_shard_t *shard = &rt->shards[i];
+        shard->rt = rt;
+        shard->index = i;
+        shard->loop = curl_event_loop_init(runtime_on_loop, shard);
+        if (!shard->loop) {
+            rt->num_loops = i;
+            curl_event_runtime_destroy(rt);
+            return NULL;
+        }
+        shard->loop->persistent = true;
+        if (budget < shard->loop->max_concurrent_requests)
+            curl_event_loop_set_max_concurrent(shard->loop, budget);
+        curl_event_loop_set_connection_limits(shard->loop, -1, (long)budget, -1);
+    }
+    rt->num_loops = num_loops;
+    return rt;
+}
+
+bool curl_event_runtime_start(curl_event_runtime_t *rt) {
+    if (!rt || rt->started) return false;
+    atomic_store_explicit(&rt->state, RUNTIME_RUNNING, memory_order_release);
+    for (size_t i = 0; i < rt->num_loops; i++) {
+        runtime_shard_t *shard = &rt->shards[i];
+        shard->loop->persistent = true;
+        if (pthread_create(&shard->thread, NULL, runtime_thread_main, shard) != 0) {
+            fprintf(stderr, "[curl_event_runtime_start] pthread_create failed for shard %zu.\n", i);
+            atomic_store_explicit(&rt->state, RUNTIME_STOPPING, memory_order_release);
+            for (size_t j = 0; j < i; j++) {
+                curl_event_loop_wake(rt->shards[j].loop);
+                pthread_join(rt->shards[j].thread, NULL);
+            }
+            return false;
+        }
+    }
+    rt->started = true;
+    return true;
+}
+
+void curl_event_runtime_stop(curl_event_runtime_t *rt, bool drain) {
+    if (!rt || !rt->started) return;
+    atomic_store_explicit(&rt->state, drain ? RUNTIME_DRAINING : RUNTIME_STOPPING,
+                          memory_order_release);
+    for (size_t i = 0; i < rt->num_loops; i++)
+        curl_event_loop_wake(rt->shards[i].loop);
+    for (size_t i = 0; i < rt->num_loops; i++)
+        pthread_join(rt->shards[i].thread, NULL);
+    rt->started = false;
+}
+
+void curl_event_runtime_destroy(curl_event_runtime_t *rt) {
+    if (!rt) return;
+    curl_event_runtime_stop(rt, false);
+    for (size_t i = 0; i < rt->num_loops; i++)
+        curl_event_loop_destroy(rt->shards[i].loop);
+    aml_free(rt->shards);
+    aml_free(rt);
+}
+
+/* Host part of a URL: skip "scheme://" and userinfo, stop at port/path */
+static void url_host(const char *url, const char **host, size_t *len) {
+    const char *p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    const char *end = p + strcspn(p, "/?#");
+    const char *at = memchr(p, '@', (size_t)(end - p));
+    if (at) p = at + 1;
+    if (*p == '[') {                          /* IPv6 literal */
+        const char *rb = memchr(p, ']', (size_t)(end - p));
+        if (rb) end = rb + 1;
+    } else {
+        const char *colon = memchr(p, ':', (size_t)(end - p));
+        if (colon) end = colon;
+    }
+    *host = p;
+    *len = (size_t)(end - p);
+}
+
+/* FNV-1a; case-insensitive so hosts route the same regardless of case */
+static uint64_t shard_hash(const char *s, size_t len) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 'A' && c <= 'Z') c = (unsigned char)(c + ('a' - 'A'));
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+size_t curl_event_runtime_shard_for(const curl_event_runtime_t *rt,
+                                    const curl_event_request_t *req)
+{
+    if (!rt || !req || rt->num_loops <= 1) return 0;
+    /* a group's members all run on the loop it was made for */
+    const curl_event_group_t *group = curl_wrap_from_public_const(req)->group;
+    if (group) {
+        for (size_t i = 0; i < rt->num_loops; i++)
+            if (rt->shards[i].loop == group->loop)
+                return i;
+    }
+    uint64_t h;
+    if (req->rate_limit) {
+        h = shard_hash(req->rate_limit, strlen(req->rate_limit));
+    } else if (req->url) {
+        const char *host; size_t len;
+        url_host(req->url, &host, &len);
+        h = shard_hash(host, len);
+    } else {
+        h = 0;
+    }
+    return (size_t)(h % rt->num_loops);
+}
+
+curl_event_request_t *
+curl_event_runtime_submit(curl_event_runtime_t *rt,
+                          curl_event_request_t *req,
+                          int priority)
+{
+    if (!rt || !req) {
+        fprintf(stderr, "[curl_event_runtime_submit] Invalid arguments.\n");
+        return NULL;
+    }
+    curl_event_loop_t *loop = rt->shards[curl_event_runtime_shard_for(rt, req)].loop;
+    /* submit posts to the shard inbox and wakes it if idle */
+    return curl_event_request_submit(loop, req, priority);
+}
+
+size_t curl_event_runtime_num_loops(const curl_event_runtime_t *rt) {
+    return rt ? rt->num_loops : 0;
+}
+
+curl_event_loop_t *curl_event_runtime_loop(curl_event_runtime_t *rt, size_t idx) {
+    if (!rt || idx >= rt->num_loops) return NULL;
+    return rt->shards[idx].loop;
+}
+
+curl_event_metrics_t curl_event_runtime_get_metrics(const curl_event_runtime_t *rt) {
+    curl_event_metrics_t total = {0};
+    if (!rt) return total;
+    for (size_t i = 0; i < rt->num_loops; i++) {
+        curl_event_metrics_t m = curl_event_loop_get_metrics(rt->shards[i].loop);
+        total.total_requests     += m.total_requests;
+        total.completed_requests += m.completed_requests;
+        total.failed_requests    += m.failed_requests;
+        total.retried_requests   += m.retried_requests;
+        total.retries_denied     += m.retries_denied;
+        total.expired_requests   += m.expired_requests;
+        total.hedges_fired       += m.hedges_fired;
+        total.hedges_won         += m.hedges_won;
+        total.coalesced_requests += m.coalesced_requests;
+        total.host_parked        += m.host_parked;
+        total.cache_hits += m.cache_hits;
+        total.cache_misses += m.cache_misses;
+        total.cache_revalidations += m.cache_revalidations;
+        total.cache_evictions += m.cache_evictions;
+        total.cache_disk_hits += m.cache_disk_hits;
+        total.easy_handle_hits   += m.easy_handle_hits;
+        total.easy_handle_misses += m.easy_handle_misses;
+        if (m.easy_handle_high_water > total.easy_handle_high_water)
+            total.easy_handle_high_water = m.easy_handle_high_water;
+        total.connections_new    += m.connections_new;
+        total.connections_reused += m.connections_reused;
+        total.tls_handshakes     += m.tls_handshakes;
+        total.tls_resumed        += m.tls_resumed;
+        total.breakers_open      += m.breakers_open;
+        total.breaker_trips      += m.breaker_trips;
+        total.breaker_half_opens += m.breaker_half_opens;
+        total.breaker_recoveries += m.breaker_recoveries;
+        total.breaker_probes     += m.breaker_probes;
+        total.breaker_rejected   += m.breaker_rejected;
+        total.breaker_parked     += m.breaker_parked;
+        for (int l = 0; l < CURL_EVENT_PRIORITY_LANES; l++) {
+            total.lanes[l].depth         += m.lanes[l].depth;
+            total.lanes[l].dispatched    += m.lanes[l].dispatched;
+            total.lanes[l].promoted      += m.lanes[l].promoted;
+            total.lanes[l].wait_ns_total += m.lanes[l].wait_ns_total;
+            if (m.lanes[l].wait_ns_max > total.lanes[l].wait_ns_max)
+                total.lanes[l].wait_ns_max = m.lanes[l].wait_ns_max;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* RTLD_DEFAULT */
+#endif
+
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+
+static void share_lock(CURL *handle, curl_lock_data data,
+                       curl_lock_access access, void *userptr)
+{
+    (void)handle; (void)access;
+    curl_event_share_t *share = (curl_event_share_t *)userptr;
+    if ((unsigned)data < CURL_LOCK_DATA_LAST)
+        pthread_mutex_lock(&share->locks[data]);
+}
+
+static void share_unlock(CURL *handle, curl_lock_data data, void *userptr)
+{
+    (void)handle;
+    curl_event_share_t *share = (curl_event_share_t *)userptr;
+    if ((unsigned)data < CURL_LOCK_DATA_LAST)
+        pthread_mutex_unlock(&share->locks[data]);
+}
+
+static bool share_enable(CURLSH *sh, curl_lock_data data, const char *name) {
+    CURLSHcode rc = curl_share_setopt(sh, CURLSHOPT_SHARE, data);
+    if (rc != CURLSHE_OK) {
+        fprintf(stderr, "[curl_event_share_init] cannot share %s: %s\n",
+                name, curl_share_strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+curl_event_share_t *curl_event_share_init(unsigned flags) {
+    curl_event_share_t *share = (curl_event_share_t *)aml_calloc(1, sizeof(*share));
+    if (!share) {
+        fprintf(stderr, "[curl_event_share_init] Memory allocation failed.\n");
+        return NULL;
+    }
+    share->sh = curl_share_init();
+    if (!share->sh) {
+        fprintf(stderr, "[curl_event_share_init] curl_share_init failed.\n");
+        aml_free(share);
+        return NULL;
+    }
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+        pthread_mutex_init(&share->locks[i], NULL);
+    share->flags = flags;
+    atomic_init(&share->refcnt, 1);
+    share->num_loops = 0;
+
+    curl_share_setopt(share->sh, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(share->sh, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(share->sh, CURLSHOPT_USERDATA, share);
+
+    bool ok = true;
+    if (flags & CURL_EVENT_SHARE_DNS)
+        ok = ok && share_enable(share->sh, CURL_LOCK_DATA_DNS, "DNS");
+    if (flags & CURL_EVENT_SHARE_SSL_SESSION)
+        ok = ok && share_enable(share->sh, CURL_LOCK_DATA_SSL_SESSION, "SSL_SESSION");
+    if (flags & CURL_EVENT_SHARE_CONNECT) {
+#if LIBCURL_VERSION_NUM >= 0x073900
+        ok = ok && share_enable(share->sh, CURL_LOCK_DATA_CONNECT, "CONNECT");
+#else
+        fprintf(stderr, "[curl_event_share_init] CONNECT sharing needs libcurl >= 7.57.0\n");
+        ok = false;
+#endif
+    }
+    if (flags & CURL_EVENT_SHARE_PSL) {
+#if LIBCURL_VERSION_NUM >= 0x073d00
+        ok = ok && share_enable(share->sh, CURL_LOCK_DATA_PSL, "PSL");
+#else
+        fprintf(stderr, "[curl_event_share_init] PSL sharing needs libcurl >= 7.61.0\n");
+        ok = false;
+#endif
+    }
+    if (!ok) {
+        curl_event_share_release(share);
+        return NULL;
+    }
+    return share;
+}
+
+unsigned curl_event_share_flags(const curl_event_share_t *share) {
+    return share ? share->flags : 0;
+}
+
+void curl_event_share_retain(curl_event_share_t *share) {
+    atomic_fetch_add_explicit(&share->refcnt, 1, memory_order_relaxed);
+}
+
+void curl_event_share_release(curl_event_share_t *share) {
+    if (!share) return;
+    if (atomic_fetch_sub_explicit(&share->refcnt, 1, memory_order_acq_rel) != 1)
+        return;
+    curl_share_cleanup(share->sh);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+        pthread_mutex_destroy(&share->locks[i]);
+    aml_free(share);
+}
+
+/* ────────────────────────────────────────────────────────────────────
+   TLS resumption probe
+
+   libcurl does not report whether a handshake resumed a session, so for
+   OpenSSL-family backends we ask the SSL object directly.  The symbol is
+   looked up at runtime to avoid a link-time dependency on libssl.
+   ──────────────────────────────────────────────────────────────────── */
+typedef int (*ssl_session_reused_fn)(const void *ssl);
+
+static ssl_session_reused_fn ssl_session_reused;
+static pthread_once_t ssl_session_reused_once = PTHREAD_ONCE_INIT;
+
+static void resolve_ssl_session_reused(void) {
+    /* POSIX-sanctioned way to turn a data pointer into a function pointer */
+    *(void **)(&ssl_session_reused) = dlsym(RTLD_DEFAULT, "SSL_session_reused");
+}
+
+int curl_event_tls_session_reused(CURL *easy) {
+    struct curl_tlssessioninfo *info = NULL;
+    if (curl_easy_getinfo(easy, CURLINFO_TLS_SSL_PTR, &info) != CURLE_OK ||
+        !info || !info->internals || info->backend != CURLSSLBACKEND_OPENSSL)
+        return -1;
+    pthread_once(&ssl_session_reused_once, resolve_ssl_session_reused);
+    if (!ssl_session_reused) return -1;
+    return ssl_session_reused(info->internals) ? 1 : 0;
+}
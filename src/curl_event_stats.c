@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/curl_event_priv.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Per-key statistics.  The loop thread records every finished network
+   attempt under stats_lock (once per attempt, uncontended unless someone
+   is reading); readers on any thread summarize under the same lock.
+   Entries live until the loop is destroyed, so their keys stay valid. */
+
+typedef struct {
+    macro_map_t    node;
+    const char    *key;             /* stored after the struct */
+    uint64_t       attempts;
+    uint64_t       bytes_sent;
+    uint64_t       bytes_received;
+    uint64_t       status[6];
+    latency_hist_t phases[CURL_EVENT_PHASES];
+} key_stats_t;
+
+static inline int compare_key_stats(const key_stats_t *a, const key_stats_t *b) {
+    return strcmp(a->key, b->key);
+}
+static inline int compare_key_stats_string(const char *a, const key_stats_t *b) {
+    return strcmp(a, b->key);
+}
+static inline
+macro_map_insert(key_stats_insert, key_stats_t, compare_key_stats);
+static inline
+macro_map_find_kv(key_stats_find, char, key_stats_t, compare_key_stats_string);
+
+static key_stats_t *key_stats_get(macro_map_t **root, const char *key) {
+    key_stats_t *k = key_stats_find(*root, key);
+    if (k) return k;
+    size_t len = strlen(key);
+    k = (key_stats_t *)aml_calloc(1, sizeof(*k) + len + 1);
+    if (!k) return NULL;
+    memcpy((char *)(k + 1), key, len + 1);
+    k->key = (const char *)(k + 1);
+    key_stats_insert(root, k);
+    return k;
+}
+
+static void key_stats_add(key_stats_t *k, const int64_t *us, curl_off_t up,
+                          curl_off_t down, int status) {
+    k->attempts++;
+    k->bytes_sent += (uint64_t)up;
+    k->bytes_received += (uint64_t)down;
+    k->status[status]++;
+    for (int p = 0; p < CURL_EVENT_PHASES; p++)
+        if (us[p] >= 0)
+            latency_hist_record(&k->phases[p], (uint64_t)us[p]);
+}
+
+void curl_event_stats_record(curl_event_loop_t *loop, curl_event_loop_request_t *req,
+                             const char *host_key, CURL *easy, long http_code) {
+    curl_off_t dns = 0, connect = 0, tls = 0, pre = 0, first = 0, total = 0;
+    curl_off_t up = 0, down = 0;
+    curl_easy_getinfo(easy, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME_T, &tls);
+    curl_easy_getinfo(easy, CURLINFO_PRETRANSFER_TIME_T, &pre);
+    curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME_T, &first);
+    curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(easy, CURLINFO_SIZE_UPLOAD_T, &up);
+    curl_easy_getinfo(easy, CURLINFO_SIZE_DOWNLOAD_T, &down);
+
+    /* libcurl's times run from the start of the attempt; -1 = not measured */
+    int64_t us[CURL_EVENT_PHASES];
+    us[CURL_EVENT_PHASE_TOTAL] = total;
+    us[CURL_EVENT_PHASE_QUEUE] = req->request.request_start_time >= req->ready_at
+        ? (int64_t)((req->request.request_start_time - req->ready_at) / 1000ull) : -1;
+    us[CURL_EVENT_PHASE_DNS] = dns > 0 ? dns : -1;
+    us[CURL_EVENT_PHASE_CONNECT] = connect > 0 ? connect - dns : -1;
+    us[CURL_EVENT_PHASE_TLS] = tls > 0 ? tls - connect : -1;
+    us[CURL_EVENT_PHASE_TTFB] = first > 0 ? first - pre : -1;
+    us[CURL_EVENT_PHASE_TRANSFER] = first > 0 ? total - first : -1;
+
+    int status = http_code >= 100 && http_code < 600 ? (int)(http_code / 100) : 0;
+
+    pthread_mutex_lock(&loop->stats_lock);
+    key_stats_t *k;
+    if (req->request.rate_limit &&
+        (k = key_stats_get(&loop->key_stats[CURL_EVENT_STATS_RATE_KEY], req->request.rate_limit)))
+        key_stats_add(k, us, up, down, status);
+    if ((k = key_stats_get(&loop->key_stats[CURL_EVENT_STATS_HOST], host_key)))
+        key_stats_add(k, us, up, down, status);
+    pthread_mutex_unlock(&loop->stats_lock);
+}
+
+void curl_event_stats_publish(curl_event_loop_t *loop) {
+    pthread_mutex_lock(&loop->stats_lock);
+    loop->published = loop->metrics;
+    loop->published.total_requests =
+        atomic_load_explicit(&loop->total_requests, memory_order_relaxed);
+    pthread_mutex_unlock(&loop->stats_lock);
+}
+
+void curl_event_stats_destroy(curl_event_loop_t *loop) {
+    for (int kind = 0; kind < 2; kind++) {
+        macro_map_t *k;
+        while ((k = macro_map_first(loop->key_stats[kind])) != NULL) {
+            macro_map_erase(&loop->key_stats[kind], k);
+            aml_free(k);
+        }
+    }
+    pthread_mutex_destroy(&loop->stats_lock);
+}
+
+static void summarize(const key_stats_t *k, curl_event_key_stats_t *out) {
+    out->attempts = k->attempts;
+    out->bytes_sent = k->bytes_sent;
+    out->bytes_received = k->bytes_received;
+    memcpy(out->status, k->status, sizeof(out->status));
+    for (int p = 0; p < CURL_EVENT_PHASES; p++) {
+        const latency_hist_t *h = &k->phases[p];
+        curl_event_latency_t *l = &out->phases[p];
+        l->count = h->count;
+        l->mean_us = h->count ? h->sum / h->count : 0;
+        l->p50_us = latency_hist_percentile(h, 0.5);
+        l->p90_us = latency_hist_percentile(h, 0.9);
+        l->p99_us = latency_hist_percentile(h, 0.99);
+        l->p999_us = latency_hist_percentile(h, 0.999);
+        l->max_us = h->max;
+    }
+}
+
+static bool valid_kind(curl_event_stats_kind_t kind) {
+    return kind == CURL_EVENT_STATS_RATE_KEY || kind == CURL_EVENT_STATS_HOST;
+}
+
+bool curl_event_loop_get_key_stats(curl_event_loop_t *loop, curl_event_stats_kind_t kind,
+                                   const char *key, curl_event_key_stats_t *out) {
+    if (!loop || !key || !out || !valid_kind(kind)) return false;
+    pthread_mutex_lock(&loop->stats_lock);
+    key_stats_t *k = key_stats_find(loop->key_stats[kind], key);
+    if (k) summarize(k, out);
+    pthread_mutex_unlock(&loop->stats_lock);
+    return k != NULL;
+}
+
+typedef struct {
+    const char *key;
+    curl_event_key_stats_t stats;
+} key_stats_snapshot_t;
+
+size_t curl_event_loop_foreach_key_stats(curl_event_loop_t *loop, curl_event_stats_kind_t kind,
+                                         curl_event_on_key_stats_t each, void *arg) {
+    if (!loop || !each || !valid_kind(kind)) return 0;
+
+    pthread_mutex_lock(&loop->stats_lock);
+    size_t n = 0;
+    for (macro_map_t *m = macro_map_first(loop->key_stats[kind]); m; m = macro_map_next(m))
+        n++;
+    key_stats_snapshot_t *snap = n ? (key_stats_snapshot_t *)aml_malloc(n * sizeof(*snap)) : NULL;
+    if (n && !snap) {
+        pthread_mutex_unlock(&loop->stats_lock);
+        fprintf(stderr, "[curl_event_loop_foreach_key_stats] Memory allocation failed.\n");
+        return 0;
+    }
+    size_t i = 0;
+    for (macro_map_t *m = macro_map_first(loop->key_stats[kind]); m; m = macro_map_next(m), i++) {
+        snap[i].key = ((key_stats_t *)m)->key;
+        summarize((key_stats_t *)m, &snap[i].stats);
+    }
+    pthread_mutex_unlock(&loop->stats_lock);
+
+    for (i = 0; i < n; i++)
+        each(snap[i].key, &snap[i].stats, arg);
+    aml_free(snap);
+    return n;
+}
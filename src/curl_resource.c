@@ -28,7 +28,8 @@ typedef struct curl_event_res_s {
     bool   failed;                  /* publish(NULL) sets this              */
     bool   auto_release_owner;      /* auto-drop owner when refcnt returns to 1 */
 
-    /* list of requests waiting on this resource                           */
+    /* list of requests waiting on this resource (doubly linked through
+       next_pending / prev_pending so a cancel can unlink in O(1))         */
     struct curl_event_loop_request_s *blocked_head;
     struct curl_event_loop_request_s *blocked_tail;
 } curl_event_res_t;
@@ -72,6 +73,9 @@ static inline void assert_loop_thread(struct curl_event_loop_s *loop) {
 static inline void requeue_pending(struct curl_event_loop_s *loop,
                                    struct curl_event_loop_request_s *req)
 {
+    req->blocked_on        = NULL;
+    req->prev_pending      = NULL;
+    req->where             = REQ_WHERE_NONE;
     req->next_pending      = loop->pending_requests;
     loop->pending_requests = req;
 }
@@ -98,6 +102,9 @@ static inline void block_request_on_res(struct curl_event_loop_s *loop,
 {
     (void)loop; /* not used here, but kept for parity */
     req->next_pending = NULL;
+    req->prev_pending = node->blocked_tail;
+    req->blocked_on   = node;
+    req->where        = REQ_WHERE_BLOCKED;
     if (node->blocked_tail) {
         node->blocked_tail->next_pending = req;
         node->blocked_tail = req;
@@ -106,6 +113,19 @@ static inline void block_request_on_res(struct curl_event_loop_s *loop,
     }
 }
 
+/* Detach a whole blocked list; requests are no longer BLOCKED */
+static struct curl_event_loop_request_s *detach_blocked(curl_event_res_t *node)
+{
+    struct curl_event_loop_request_s *head = node->blocked_head;
+    node->blocked_head = node->blocked_tail = NULL;
+    for (struct curl_event_loop_request_s *r = head; r; r = r->next_pending) {
+        r->prev_pending = NULL;
+        r->blocked_on   = NULL;
+        r->where        = REQ_WHERE_NONE;
+    }
+    return head;
+}
+
 /* ──────────────────────────────────────────────────────────────────────
    Cross‑thread inbox (MPSC Treiber stack)
    ────────────────────────────────────────────────────────────────────── */
@@ -130,8 +150,9 @@ static _Atomic uint64_t g_next_id = 1;
 
 void curl_resource_set_owner_thread(struct curl_event_loop_s *loop)
 {
+    /* Only records the thread: ops already posted to the inbox stay queued
+       until the next curl_resource_inbox_drain(). */
     loop->owner_thread = pthread_self();
-    atomic_store_explicit(&loop->res_inbox.head, NULL, memory_order_relaxed);
 }
 
 /* Drain the inbox on the loop thread */
@@ -263,8 +284,7 @@ void curl_event_res_publish(struct curl_event_loop_s *loop,
     n->failed  = (payload == NULL);
 
     /* Detach blocked list */
-    struct curl_event_loop_request_s *head = n->blocked_head;
-    n->blocked_head = n->blocked_tail = NULL;
+    struct curl_event_loop_request_s *head = detach_blocked(n);
 
     /* Requeue or fast‑fail dependents */
     while (head) {
@@ -350,6 +370,8 @@ void curl_event_loop_wake(curl_event_loop_t *loop) {
     if (!loop) return;
     /* libcurl >= 7.68: wakes a thread blocked in curl_multi_poll/select */
     curl_multi_wakeup(loop->multi_handle);
+    if (loop->backend == CURL_EVENT_BACKEND_EPOLL)
+        curl_event_epoll_wake(loop);
 }
 
 curl_event_res_id
@@ -411,6 +433,21 @@ bool curl_resource_block_on_id(struct curl_event_loop_s         *loop,
     return false;
 }
 
+void curl_resource_unblock(struct curl_event_loop_s         *loop,
+                           struct curl_event_loop_request_s *req)
+{
+    assert_loop_thread(loop);
+    curl_event_res_t *node = (curl_event_res_t *)req->blocked_on;
+    if (!node) return;
+    if (req->prev_pending) req->prev_pending->next_pending = req->next_pending;
+    else                   node->blocked_head = req->next_pending;
+    if (req->next_pending) req->next_pending->prev_pending = req->prev_pending;
+    else                   node->blocked_tail = req->prev_pending;
+    req->next_pending = req->prev_pending = NULL;
+    req->blocked_on = NULL;
+    req->where = REQ_WHERE_NONE;
+}
+
 bool curl_resource_check_and_block_list(struct curl_event_loop_s         *loop,
                                         struct curl_event_loop_request_s *req,
                                         struct curl_res_dep_s            *head)
@@ -451,8 +488,7 @@ void curl_resource_destroy_all(struct curl_event_loop_s *loop)
         /* Detach any blocked list (no need to hold the loop mutex here as
            we’re on the loop thread during teardown and no one else is
            mutating the resources structure anymore). */
-        curl_event_loop_request_t *head = res->blocked_head;
-        res->blocked_head = res->blocked_tail = NULL;
+        curl_event_loop_request_t *head = detach_blocked(res);
 
         /* Fail/cancel all blocked requests cleanly. */
         while (head) {
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/latency_histogram.h"
+
+#include <string.h>
+
+size_t latency_hist_index(uint64_t value) {
+    if (value < LATENCY_HIST_SUB)
+        return (size_t)value;
+    unsigned e = 63u - (unsigned)__builtin_clzll(value);   /* >= SUB_BITS */
+    if (e >= LATENCY_HIST_MAX_EXP)
+        return LATENCY_HIST_BUCKETS - 1;
+    size_t sub = (size_t)(value >> (e - LATENCY_HIST_SUB_BITS)) & (LATENCY_HIST_SUB - 1);
+    return LATENCY_HIST_SUB + (size_t)(e - LATENCY_HIST_SUB_BITS) * LATENCY_HIST_SUB + sub;
+}
+
+uint64_t latency_hist_bucket_low(size_t index) {
+    if (index < LATENCY_HIST_SUB)
+        return index;
+    size_t i = index - LATENCY_HIST_SUB;
+    unsigned shift = (unsigned)(i / LATENCY_HIST_SUB);
+    return (uint64_t)(LATENCY_HIST_SUB + i % LATENCY_HIST_SUB) << shift;
+}
+
+uint64_t latency_hist_bucket_high(size_t index) {
+    if (index < LATENCY_HIST_SUB)
+        return index;
+    if (index >= LATENCY_HIST_BUCKETS - 1)
+        return UINT64_MAX;
+    unsigned shift = (unsigned)((index - LATENCY_HIST_SUB) / LATENCY_HIST_SUB);
+    return latency_hist_bucket_low(index) + ((uint64_t)1 << shift) - 1;
+}
+
+void latency_hist_reset(latency_hist_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+void latency_hist_record(latency_hist_t *h, uint64_t value) {
+    h->buckets[latency_hist_index(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value > h->max) h->max = value;
+}
+
+void latency_hist_merge(latency_hist_t *dst, const latency_hist_t *src) {
+    for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++)
+        dst->buckets[i] += src->buckets[i];
+    dst->count += src->count;
+    dst->sum   += src->sum;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+uint64_t latency_hist_percentile(const latency_hist_t *h, double p) {
+    if (!h->count) return 0;
+    if (p < 0.0) p = 0.0;
+    if (p > 1.0) p = 1.0;
+    /* rank of the sample we want, 1-based */
+    uint64_t rank = (uint64_t)(p * (double)h->count + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t high = latency_hist_bucket_high(i);
+            return high < h->max ? high : h->max;
+        }
+    }
+    return h->max;
+}
@@ -3,231 +3,960 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "a-curl-library/rate_manager.h"
+#include "a-curl-library/impl/rate_manager_shm.h"
 #include "the-macro-library/macro_time.h"
-#include "the-macro-library/macro_map.h"
 #include "a-memory-library/aml_alloc.h"
 
+#include <curl/curl.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <pthread.h>
 #include <string.h>
+#include <strings.h>
 #include <math.h>
+#include <time.h>
 #include <unistd.h>
 
+/* Adaptive concurrency (rate_manager_set_adaptive) */
+#define ADAPTIVE_WINDOW_NS   (30ull * 1000000000ull)  /* RTT baseline window */
+#define ADAPTIVE_TOLERANCE   2.0    /* RTT over baseline that counts as queueing */
+#define ADAPTIVE_EWMA        0.2    /* weight of a new RTT sample */
+#define ADAPTIVE_OVERLOAD    0.5    /* cut on 429 / 5xx / timeout */
+#define ADAPTIVE_INFLATION   0.9    /* cut on latency inflation */
+/* How long a high-priority request that was told to wait keeps normal
+   requests off the bucket past its own wait */
+#define HP_GRACE_NS          (50ull * 1000000ull)
+
+/* FIFO of rate_manager_waiter_t */
 typedef struct {
-    macro_map_t node;
+    rate_manager_waiter_t *head;
+    rate_manager_waiter_t *tail;
+} waiter_list_t;
+
+/* One interned key.  Each key has its own lock and its own cache lines,
+   so loops working different keys never touch the same memory. */
+struct rate_key_s {
+    _Alignas(64) pthread_mutex_t mutex;
+    rate_key_t *next;               /* hash chain */
+    uint64_t hash;
     char *key;
-    int max_concurrent;
-    double max_rps;
-    int current_requests;
-    int high_priority_requests;
-    double tokens;
-    uint64_t last_refill;
-    uint64_t last_success;
-    int backoff_seconds;
-} rate_limit_t;
+    rate_key_t *parent;             /* rate_manager_set_parent */
+    uint64_t limiting;              /* times this key made a request wait */
+
+    /* quota state: `local`, or a slot of the shared segment */
+    rate_bucket_t *b;
+    rate_shm_slot_t *shm_slot;
+    rate_bucket_t local;
+
+    /* requests waiting for a concurrency slot, high priority first */
+    waiter_list_t hp_waiters;
+    waiter_list_t waiters;
+
+    /* adaptive concurrency: limit grows by ~1 per RTT while the RTT stays
+       near rtt_min, and is cut multiplicatively (at most once per RTT) on
+       overload or inflation */
+    bool adaptive;
+    int min_limit;
+    int max_limit;
+    double limit;
+    uint64_t rtt_min;               /* baseline: lowest RTT of the last window */
+    uint64_t window_min;            /* lowest RTT of the current window */
+    uint64_t window_start;
+    double rtt;                     /* EWMA of recent RTTs (ns) */
+    uint64_t last_cut;
+};
+
+#define RATE_KEYS_INITIAL_BUCKETS 64
+
+/* The table only maps names to keys; once a caller holds a rate_key_t the
+   table lock is never taken again.  Keys live until rate_manager_destroy. */
+typedef struct {
+    pthread_rwlock_t lock;
+    rate_key_t **buckets;
+    size_t num_buckets;             /* power of two */
+    size_t num_keys;
+    rate_shm_t *shm;                /* rate_manager_use_shared */
+} rate_manager_t;
+
+static rate_manager_t *g_rate_manager = NULL;
 
-static inline
-int compare_rate_limit(const rate_limit_t *a, const rate_limit_t *b) {
-    return strcmp(a->key, b->key);
+/* FNV-1a */
+static uint64_t key_hash(const char *key) {
+    uint64_t h = 1469598103934665603ull;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ull;
+    }
+    return h;
 }
 
-static inline
-int compare_rate_limit_string(const char *a, const rate_limit_t *b) {
-    return strcmp(a, b->key);
+static rate_key_t *key_lookup(const char *key, uint64_t h) {
+    rate_key_t *k = g_rate_manager->buckets[h & (g_rate_manager->num_buckets - 1)];
+    while (k && (k->hash != h || strcmp(k->key, key)))
+        k = k->next;
+    return k;
 }
 
-static inline
-macro_map_insert(rate_limit_insert, rate_limit_t, compare_rate_limit);
+/* Double the table once it averages one key per bucket (write lock held) */
+static void keys_grow(void) {
+    size_t n = g_rate_manager->num_buckets * 2;
+    rate_key_t **buckets = (rate_key_t **)aml_calloc(n, sizeof(*buckets));
+    for (size_t i = 0; i < g_rate_manager->num_buckets; i++) {
+        rate_key_t *k = g_rate_manager->buckets[i];
+        while (k) {
+            rate_key_t *next = k->next;
+            k->next = buckets[k->hash & (n - 1)];
+            buckets[k->hash & (n - 1)] = k;
+            k = next;
+        }
+    }
+    aml_free(g_rate_manager->buckets);
+    g_rate_manager->buckets = buckets;
+    g_rate_manager->num_buckets = n;
+}
 
-static inline
-macro_map_find_kv(rate_limit_find, char, rate_limit_t, compare_rate_limit_string);
+/* Existing key or NULL; used by the string API, which never creates keys */
+static rate_key_t *rate_manager_find(const char *key) {
+    if (!g_rate_manager || !key)
+        return NULL;
+    uint64_t h = key_hash(key);
+    pthread_rwlock_rdlock(&g_rate_manager->lock);
+    rate_key_t *k = key_lookup(key, h);
+    pthread_rwlock_unlock(&g_rate_manager->lock);
+    return k;
+}
 
-typedef struct {
-    pthread_mutex_t mutex;
-    macro_map_t *limits;
-} rate_manager_t;
+/* The tightest of max_rps and what the server advertised; <= 0 means no
+   rate limit */
+static double effective_rps(const rate_key_t *limit, uint64_t now) {
+    double rps = limit->b->max_rps;
+    if (limit->b->policy_rps > 0 && (rps <= 0 || limit->b->policy_rps < rps))
+        rps = limit->b->policy_rps;
+    if (now < limit->b->quota_until && (rps <= 0 || limit->b->quota_rps < rps))
+        rps = limit->b->quota_rps;
+    return rps;
+}
 
-static rate_manager_t *g_rate_manager = NULL;
+/* Refill the shared token bucket; max_rps <= 0 means no rate limit.
+   The bucket holds at least one token, so a fractional max_rps works. */
+static void refill_tokens(rate_key_t *limit, uint64_t now) {
+    double rps = effective_rps(limit, now);
+    if (rps <= 0) {
+        limit->b->tokens = 1.0;
+    } else {
+        double elapsed = macro_time_diff(now, limit->b->last_refill);
+        limit->b->tokens = fmin(fmax(rps, 1.0), limit->b->tokens + elapsed * rps);
+    }
+    limit->b->last_refill = now;
+}
+
+/* max_concurrent, or the adaptive limit; <= 0 means no limit */
+static bool has_free_slot(const rate_key_t *limit) {
+    int cap = limit->adaptive ? (int)limit->limit : limit->b->max_concurrent;
+    return cap <= 0 || limit->b->current_requests < cap;
+}
+
+/* has_free_slot, after reclaiming the slots of dead processes when a
+   shared key is full */
+static bool slot_free(rate_key_t *limit, uint64_t now) {
+    if (has_free_slot(limit))
+        return true;
+    return limit->shm_slot && rate_shm_reap(limit->shm_slot, now) && has_free_slot(limit);
+}
+
+static void take_slot(rate_key_t *limit) {
+    limit->b->current_requests++;
+    if (limit->shm_slot)
+        rate_shm_hold(limit->shm_slot, 1);
+}
+
+static void give_slot(rate_key_t *limit) {
+    if (limit->b->current_requests > 0)
+        limit->b->current_requests--;
+    if (limit->shm_slot)
+        rate_shm_hold(limit->shm_slot, -1);
+}
+
+/* Polling hint for callers that cannot queue: about one completion */
+static uint64_t slot_wait(const rate_key_t *limit) {
+    uint64_t wait = limit->adaptive && limit->rtt > 0
+                  ? (uint64_t)(limit->rtt / limit->limit) : 10000000ull;
+    if (wait < 1000000ull) wait = 1000000ull;
+    if (wait > 100000000ull) wait = 100000000ull;
+    return wait;
+}
+
+/* Nanoseconds until a token is available to this caller, or 0.  A high-
+   priority caller that has to wait keeps normal callers off the bucket
+   for that long (plus HP_GRACE_NS), so it gets the next token. */
+static uint64_t token_wait(rate_key_t *limit, bool high_priority, uint64_t now) {
+    uint64_t wait = limit->b->tokens >= 1 ? 0
+                  : (uint64_t)((1.0 - limit->b->tokens) / effective_rps(limit, now) * 1e9);
+    if (high_priority) {
+        if (wait && now + wait + HP_GRACE_NS > limit->b->hp_waiting_until)
+            limit->b->hp_waiting_until = now + wait + HP_GRACE_NS;
+        return wait;
+    }
+    if (!wait && now < limit->b->hp_waiting_until)
+        wait = limit->b->hp_waiting_until - now;
+    return wait;
+}
+
+/* queued_on is read without the key's lock by rate_key_cancel_wait */
+static void waiter_push(rate_key_t *limit, rate_manager_waiter_t *w) {
+    waiter_list_t *l = w->high_priority ? &limit->hp_waiters : &limit->waiters;
+    w->next = NULL;
+    w->prev = l->tail;
+    if (l->tail) l->tail->next = w;
+    else         l->head = w;
+    l->tail = w;
+    w->queued = true;
+    __atomic_store_n(&w->queued_on, limit, __ATOMIC_RELEASE);
+}
+
+static void waiter_unlink(waiter_list_t *l, rate_manager_waiter_t *w) {
+    if (w->prev) w->prev->next = w->next;
+    else         l->head = w->next;
+    if (w->next) w->next->prev = w->prev;
+    else         l->tail = w->prev;
+    w->prev = w->next = NULL;
+    w->queued = false;
+    __atomic_store_n(&w->queued_on, NULL, __ATOMIC_RELEASE);
+}
+
+/* Hand free slots to waiters, high priority first.  The slot is counted
+   and a token taken (the bucket may go into debt) before on_wake runs.
+   A waiter on a nested key needs every level at once, which cannot be
+   taken from here: it is woken to try again instead, and the slot stays
+   reserved for it (counted in current_requests) until it acquires again
+   or gives the reservation back. */
+static void grant_waiters(rate_key_t *limit, uint64_t now) {
+    if (now < limit->b->paused_until)
+        return;
+    refill_tokens(limit, now);
+    while (slot_free(limit, now)) {
+        waiter_list_t *l = limit->hp_waiters.head ? &limit->hp_waiters : &limit->waiters;
+        rate_manager_waiter_t *w = l->head;
+        if (!w) break;
+        waiter_unlink(l, w);
+        if (w->chain) {
+            limit->b->current_requests++;
+            w->reserved_on = limit;
+            w->on_wake(w, false);
+            continue;
+        }
+        take_slot(limit);
+        limit->b->tokens -= 1.0;
+        w->on_wake(w, true);
+    }
+}
+
+/* After a 429 every waiter tries again, and finds the key paused */
+static void wake_waiters(rate_key_t *limit) {
+    waiter_list_t *lists[2] = { &limit->hp_waiters, &limit->waiters };
+    for (int i = 0; i < 2; i++) {
+        rate_manager_waiter_t *w;
+        while ((w = lists[i]->head) != NULL) {
+            waiter_unlink(lists[i], w);
+            w->on_wake(w, false);
+        }
+    }
+}
+
+/* key, then its ancestors; at most RATE_MANAGER_MAX_DEPTH */
+static int key_chain(rate_key_t *key, rate_key_t **chain) {
+    int n = 0;
+    for (rate_key_t *k = key; k && n < RATE_MANAGER_MAX_DEPTH;
+         k = __atomic_load_n(&k->parent, __ATOMIC_ACQUIRE))
+        chain[n++] = k;
+    return n;
+}
+
+/* The key's own lock (waiters, adaptive state), then its shared slot's */
+static void lock_key(rate_key_t *limit) {
+    pthread_mutex_lock(&limit->mutex);
+    if (limit->shm_slot)
+        rate_shm_lock(limit->shm_slot);
+}
+
+static void unlock_key(rate_key_t *limit) {
+    if (limit->shm_slot)
+        rate_shm_unlock(limit->shm_slot);
+    pthread_mutex_unlock(&limit->mutex);
+}
+
+/* Gives the slot grant_waiters held for a woken chain waiter to the next
+   waiter on that level */
+static void release_reservation(rate_manager_waiter_t *waiter) {
+    rate_key_t *limit = waiter->reserved_on;
+    if (!limit)
+        return;
+    lock_key(limit);
+    waiter->reserved_on = NULL;
+    if (limit->b->current_requests > 0)
+        limit->b->current_requests--;
+    grant_waiters(limit, macro_now());
+    unlock_key(limit);
+}
+
+/* Lock a key that has a limit; NULL (unlocked) means no limit applies */
+static rate_key_t *lock_configured(rate_key_t *limit) {
+    if (!limit)
+        return NULL;
+    lock_key(limit);
+    if (!limit->b->configured) {
+        unlock_key(limit);
+        return NULL;
+    }
+    return limit;
+}
+
+/* Root first: an ancestor is always locked before its descendants */
+static void lock_chain(rate_key_t **chain, int n) {
+    for (int i = n - 1; i >= 0; i--)
+        lock_key(chain[i]);
+}
+
+static void unlock_chain(rate_key_t **chain, int n) {
+    for (int i = 0; i < n; i++)
+        unlock_key(chain[i]);
+}
+
+/* Nanoseconds before this key admits a request: a 429 pause, a full
+   concurrency limit (a polling hint; *full is set) or an empty bucket.
+   0 if it admits one now. */
+static uint64_t admit_wait(rate_key_t *limit, bool high_priority, uint64_t now, bool *full) {
+    *full = false;
+    if (now < limit->b->paused_until)
+        return limit->b->paused_until - now;
+    if (!slot_free(limit, now)) {
+        *full = true;
+        return slot_wait(limit);
+    }
+    refill_tokens(limit, now);
+    return token_wait(limit, high_priority, now);
+}
+
+/* The longest admit_wait over a locked chain; *neck is the level it came
+   from.  Levels without a limit are skipped. */
+static uint64_t chain_wait(rate_key_t **chain, int n, bool high_priority, uint64_t now,
+                           rate_key_t **neck, bool *full) {
+    uint64_t wait = 0;
+    *neck = NULL;
+    *full = false;
+    for (int i = n - 1; i >= 0; i--) {
+        if (!chain[i]->b->configured)
+            continue;
+        bool level_full;
+        uint64_t w = admit_wait(chain[i], high_priority, now, &level_full);
+        if (w > wait) {
+            wait = w;
+            *neck = chain[i];
+            *full = level_full;
+        }
+    }
+    return wait;
+}
 
 void rate_manager_init(void) {
     if(g_rate_manager)
         return;
 
     g_rate_manager = (rate_manager_t *)aml_calloc(1, sizeof(rate_manager_t));
-    pthread_mutex_init(&g_rate_manager->mutex, NULL);
-    g_rate_manager->limits = NULL;
+    pthread_rwlock_init(&g_rate_manager->lock, NULL);
+    g_rate_manager->num_buckets = RATE_KEYS_INITIAL_BUCKETS;
+    g_rate_manager->buckets =
+        (rate_key_t **)aml_calloc(RATE_KEYS_INITIAL_BUCKETS, sizeof(rate_key_t *));
 
     atexit(rate_manager_destroy);
 }
 
-void rate_manager_set_limit(const char *key, int max_concurrent, double max_rps) {
+rate_key_t *rate_manager_key(const char *key) {
+    if (!key)
+        return NULL;
     if(!g_rate_manager)
         rate_manager_init();
 
-    pthread_mutex_lock(&g_rate_manager->mutex);
-
-    rate_limit_t *limit = rate_limit_find(g_rate_manager->limits, key);
-    if (!limit) {
-        limit = (rate_limit_t *)aml_calloc(1, sizeof(rate_limit_t));
-        limit->key = aml_strdup(key);
-        rate_limit_insert(&g_rate_manager->limits, limit);
+    rate_key_t *k = rate_manager_find(key);
+    if (k)
+        return k;
+
+    uint64_t h = key_hash(key);
+    pthread_rwlock_wrlock(&g_rate_manager->lock);
+    k = key_lookup(key, h);     /* another thread may have added it */
+    if (!k) {
+        // aligned_alloc rather than aml_calloc: the 64-byte alignment is
+        // what keeps neighbouring keys off each other's cache lines
+        k = (rate_key_t *)aligned_alloc(_Alignof(rate_key_t), sizeof(rate_key_t));
+        if (!k) {
+            pthread_rwlock_unlock(&g_rate_manager->lock);
+            fprintf(stderr, "[rate_manager_key] Memory allocation failed.\n");
+            return NULL;
+        }
+        memset(k, 0, sizeof(*k));
+        pthread_mutex_init(&k->mutex, NULL);
+        k->b = &k->local;
+        if (g_rate_manager->shm) {
+            k->shm_slot = rate_shm_slot(g_rate_manager->shm, key);
+            if (k->shm_slot)
+                k->b = rate_shm_bucket(k->shm_slot);
+            else
+                fprintf(stderr, "[rate_manager_key] No shared slot for \"%s\" (too long, or "
+                                "the segment is full); its limit is per process.\n", key);
+        }
+        k->hash = h;
+        k->key = aml_strdup(key);
+        if (g_rate_manager->num_keys >= g_rate_manager->num_buckets)
+            keys_grow();
+        size_t b = h & (g_rate_manager->num_buckets - 1);
+        k->next = g_rate_manager->buckets[b];
+        g_rate_manager->buckets[b] = k;
+        g_rate_manager->num_keys++;
     }
+    pthread_rwlock_unlock(&g_rate_manager->lock);
+    return k;
+}
 
-    limit->max_concurrent = max_concurrent;
-    limit->max_rps = max_rps;
-    limit->tokens = max_rps;
-    limit->last_refill = macro_now();
-    limit->last_success = macro_now();
-    limit->backoff_seconds = 1;
+bool rate_manager_use_shared(const char *name, size_t max_keys) {
+    if (!name)
+        return false;
+    if(!g_rate_manager)
+        rate_manager_init();
 
-    pthread_mutex_unlock(&g_rate_manager->mutex);
+    pthread_rwlock_wrlock(&g_rate_manager->lock);
+    bool ok = false;
+    if (g_rate_manager->num_keys || g_rate_manager->shm) {
+        fprintf(stderr, "[rate_manager_use_shared] Call before any key is used.\n");
+    } else {
+        g_rate_manager->shm = rate_shm_open(name, max_keys ? max_keys : RATE_MANAGER_SHARED_KEYS);
+        ok = g_rate_manager->shm != NULL;
+    }
+    pthread_rwlock_unlock(&g_rate_manager->lock);
+    return ok;
 }
 
-uint64_t rate_manager_can_proceed(const char *key, bool high_priority) {
-    if (!g_rate_manager)
-        return 0;
+bool rate_manager_unlink_shared(const char *name) {
+    return name && rate_shm_unlink(name);
+}
 
-    pthread_mutex_lock(&g_rate_manager->mutex);
-    rate_limit_t *limit = rate_limit_find(g_rate_manager->limits, key);
-    if (!limit) {
-        pthread_mutex_unlock(&g_rate_manager->mutex);
-        return 0; // No rate limit exists, proceed immediately
+bool rate_manager_set_parent(const char *key, const char *parent) {
+    rate_key_t *child = rate_manager_key(key);
+    rate_key_t *up = parent ? rate_manager_key(parent) : NULL;
+    if (!child || (parent && !up))
+        return false;
+
+    // The table lock serializes changes to the tree
+    pthread_rwlock_wrlock(&g_rate_manager->lock);
+    int levels = 1;
+    bool ok = true;
+    for (rate_key_t *k = up; k && ok; k = k->parent, levels++) {
+        if (k == child) {
+            fprintf(stderr, "[rate_manager_set_parent] \"%s\" is below \"%s\".\n", parent, key);
+            ok = false;
+        } else if (levels >= RATE_MANAGER_MAX_DEPTH) {
+            fprintf(stderr, "[rate_manager_set_parent] More than %d levels.\n",
+                    RATE_MANAGER_MAX_DEPTH);
+            ok = false;
+        }
     }
+    if (ok)
+        __atomic_store_n(&child->parent, up, __ATOMIC_RELEASE);
+    pthread_rwlock_unlock(&g_rate_manager->lock);
+    return ok;
+}
+
+bool rate_manager_get_stats(const char *key, rate_manager_stats_t *out) {
+    if (!out)
+        return false;
+    rate_key_t *limit = lock_configured(rate_manager_find(key));
+    if (!limit)
+        return false;
 
     uint64_t now = macro_now();
-    double elapsed = macro_time_diff(now, limit->last_refill);
+    refill_tokens(limit, now);
+    out->in_flight = limit->b->current_requests;
+    out->max_concurrent = limit->adaptive ? (int)limit->limit : limit->b->max_concurrent;
+    out->rps = fmax(effective_rps(limit, now), 0);
+    out->tokens = limit->b->tokens;
+    out->paused_ns = now < limit->b->paused_until ? limit->b->paused_until - now : 0;
+    out->limiting = limit->limiting;
+    unlock_key(limit);
+    return true;
+}
 
-    // Refill shared token bucket
-    limit->tokens = fmin(limit->max_rps, limit->tokens + elapsed * limit->max_rps);
-    limit->last_refill = now;
+const char *rate_key_name(const rate_key_t *key) {
+    return key ? key->key : NULL;
+}
 
-    // If a high-priority request is waiting, it gets first access
-    if (high_priority) {
-        if (limit->tokens >= 1) {
-            pthread_mutex_unlock(&g_rate_manager->mutex);
-            return 0; // Can proceed immediately
+static void configure(rate_key_t *limit, int max_concurrent, double max_rps) {
+    // A shared bucket that another process set up the same way keeps its
+    // tokens and pause; every process configures its keys at startup
+    bool keep = limit->shm_slot && limit->b->configured &&
+                limit->b->max_concurrent == max_concurrent && limit->b->max_rps == max_rps;
+    limit->b->configured = true;
+    limit->b->max_concurrent = max_concurrent;
+    limit->b->max_rps = max_rps;
+    limit->adaptive = false;
+    if (keep)
+        return;
+    limit->b->tokens = max_rps;
+    limit->b->last_refill = macro_now();
+    limit->b->last_success = macro_now();
+    limit->b->backoff_seconds = 1;
+    limit->b->policy_rps = 0;
+    limit->b->quota_until = 0;
+}
+
+void rate_manager_set_limit(const char *key, int max_concurrent, double max_rps) {
+    rate_key_t *limit = rate_manager_key(key);
+    if (!limit)
+        return;
+
+    lock_key(limit);
+    configure(limit, max_concurrent, max_rps);
+    grant_waiters(limit, macro_now());   /* the limit may have grown */
+    unlock_key(limit);
+}
+
+void rate_manager_set_adaptive(const char *key, int min_concurrent,
+                               int max_concurrent, double max_rps) {
+    rate_key_t *limit = rate_manager_key(key);
+    if (!limit)
+        return;
+    if (min_concurrent < 1) min_concurrent = 1;
+    if (max_concurrent < min_concurrent) max_concurrent = min_concurrent;
+
+    lock_key(limit);
+    configure(limit, max_concurrent, max_rps);
+    limit->adaptive = true;
+    limit->min_limit = min_concurrent;
+    limit->max_limit = max_concurrent;
+    limit->limit = min_concurrent;
+    limit->rtt_min = 0;
+    limit->window_min = 0;
+    limit->window_start = macro_now();
+    limit->rtt = 0;
+    limit->last_cut = 0;
+    grant_waiters(limit, macro_now());
+    unlock_key(limit);
+}
+
+void rate_key_request_sample(rate_key_t *key, uint64_t latency_ns, bool overloaded) {
+    rate_key_t *limit = lock_configured(key);
+    if (!limit)
+        return;
+    if (!limit->adaptive) {
+        unlock_key(limit);
+        return;
+    }
+
+    uint64_t now = macro_now();
+    double cut = 1.0;
+    if (overloaded) {
+        cut = ADAPTIVE_OVERLOAD;
+    } else {
+        // The baseline is the lowest RTT of the previous window, so it
+        // follows the upstream when its capacity changes
+        if (now - limit->window_start >= ADAPTIVE_WINDOW_NS) {
+            if (limit->window_min) limit->rtt_min = limit->window_min;
+            limit->window_min = 0;
+            limit->window_start = now;
         }
-        // Not enough tokens, but should take precedence when available
-        limit->high_priority_requests++;
-        double wait_time_ns = (1.0 - limit->tokens) / limit->max_rps * 1e9;
-        pthread_mutex_unlock(&g_rate_manager->mutex);
-        return (uint64_t)wait_time_ns;
+        if (!limit->window_min || latency_ns < limit->window_min)
+            limit->window_min = latency_ns;
+        if (!limit->rtt_min || latency_ns < limit->rtt_min)
+            limit->rtt_min = latency_ns;
+        limit->rtt = limit->rtt > 0
+                   ? limit->rtt + ADAPTIVE_EWMA * ((double)latency_ns - limit->rtt)
+                   : (double)latency_ns;
+
+        if (limit->rtt > ADAPTIVE_TOLERANCE * (double)limit->rtt_min)
+            cut = ADAPTIVE_INFLATION;
+        else if (2 * limit->b->current_requests >= (int)limit->limit)
+            limit->limit += 1.0 / limit->limit;   /* only while the limit is used */
     }
 
-    // Normal requests are blocked if there are pending high-priority requests
-    if (limit->tokens >= 1 && limit->high_priority_requests == 0) {
-        pthread_mutex_unlock(&g_rate_manager->mutex);
-        return 0; // Normal request can proceed immediately
+    // One cut per RTT: the samples that follow still reflect the old load
+    if (cut < 1.0 && (double)(now - limit->last_cut) >= limit->rtt) {
+        limit->limit *= cut;
+        limit->last_cut = now;
     }
+    if (limit->limit < limit->min_limit) limit->limit = limit->min_limit;
+    if (limit->limit > limit->max_limit) limit->limit = limit->max_limit;
+    grant_waiters(limit, now);
+    unlock_key(limit);
+}
 
-    // Normal requests must wait if high-priority requests are pending
-    double wait_time_ns = (1.0 - limit->tokens) / limit->max_rps * 1e9;
-    pthread_mutex_unlock(&g_rate_manager->mutex);
-    return (uint64_t)wait_time_ns;
+void rate_manager_request_sample(const char *key, uint64_t latency_ns, bool overloaded) {
+    rate_key_request_sample(rate_manager_find(key), latency_ns, overloaded);
 }
 
-uint64_t rate_manager_start_request(const char *key, bool high_priority) {
-    if (!g_rate_manager)
-        return 0;
+bool rate_manager_get_adaptive(const char *key, rate_manager_adaptive_t *out) {
+    if (!out)
+        return false;
+
+    rate_key_t *limit = lock_configured(rate_manager_find(key));
+    if (!limit)
+        return false;
+    bool found = limit->adaptive;
+    if (found) {
+        out->limit = (int)limit->limit;
+        out->in_flight = limit->b->current_requests;
+        out->rtt_min_ns = limit->rtt_min;
+        out->rtt_ns = (uint64_t)limit->rtt;
+        out->gradient = limit->rtt > 0 ? (double)limit->rtt_min / limit->rtt : 1.0;
+    }
+    unlock_key(limit);
+    return found;
+}
 
-    pthread_mutex_lock(&g_rate_manager->mutex);
-    rate_limit_t *limit = rate_limit_find(g_rate_manager->limits, key);
-    if (!limit) {
-        pthread_mutex_unlock(&g_rate_manager->mutex);
+uint64_t rate_key_can_proceed(rate_key_t *key, bool high_priority) {
+    if (!key)
+        return 0; // No rate limit exists, proceed immediately
+
+    rate_key_t *chain[RATE_MANAGER_MAX_DEPTH], *neck;
+    bool full;
+    int n = key_chain(key, chain);
+    lock_chain(chain, n);
+    uint64_t wait = chain_wait(chain, n, high_priority, macro_now(), &neck, &full);
+    unlock_chain(chain, n);
+    return wait;
+}
+
+uint64_t rate_manager_can_proceed(const char *key, bool high_priority) {
+    return rate_key_can_proceed(rate_manager_find(key), high_priority);
+}
+
+uint64_t rate_key_acquire(rate_key_t *key, bool high_priority,
+                          rate_manager_waiter_t *waiter) {
+    if (!key)
         return 0; // No rate limit exists, proceed immediately
-    }
 
+    // Every level admits the request, or none is charged
+    rate_key_t *chain[RATE_MANAGER_MAX_DEPTH], *neck;
+    bool full;
+    int n = key_chain(key, chain);
+    rate_key_t *reserved = waiter ? waiter->reserved_on : NULL;
+    for (int i = 0; reserved && i < n; i++)
+        if (chain[i] == reserved) reserved = NULL;
+    if (reserved)
+        release_reservation(waiter);    /* the tree changed since */
+    lock_chain(chain, n);
+    // A slot reserved by grant_waiters is freed and retaken under the same
+    // locks, so nothing can take it in between
+    reserved = waiter ? waiter->reserved_on : NULL;
+    if (reserved) {
+        reserved->b->current_requests--;
+        waiter->reserved_on = NULL;
+    }
     uint64_t now = macro_now();
-    double elapsed = macro_time_diff(now, limit->last_refill);
-
-    // Refill shared token bucket
-    limit->tokens = fmin(limit->max_rps, limit->tokens + elapsed * limit->max_rps);
-    limit->last_refill = now;
-
-    // Ensure high-priority requests get served first
-    if (high_priority || (limit->high_priority_requests == 0 && limit->tokens >= 1)) {
-        if (limit->tokens >= 1) {
-            limit->tokens -= 1.0;
-            limit->current_requests++;
-            if (high_priority && limit->high_priority_requests > 0) {
-                limit->high_priority_requests--; // Reduce pending high-priority count
-            }
-            pthread_mutex_unlock(&g_rate_manager->mutex);
-            return 0; // Request can proceed immediately
+    uint64_t wait = chain_wait(chain, n, high_priority, now, &neck, &full);
+    if (!wait) {
+        for (int i = 0; i < n; i++) {
+            rate_key_t *limit = chain[i];
+            if (!limit->b->configured)
+                continue;
+            limit->b->tokens -= 1.0;
+            take_slot(limit);
+            if (high_priority)
+                limit->b->hp_waiting_until = 0;
+        }
+    } else {
+        neck->limiting++;
+        if (waiter)
+            waiter->limited_by = neck;
+        // At a concurrency limit: queue for the next slot, or poll.  A
+        // slot freed by another process wakes no one here, so shared keys
+        // always poll.
+        if (full && waiter && !neck->shm_slot) {
+            waiter->high_priority = high_priority;
+            waiter->chain = n > 1;
+            waiter_push(neck, waiter);
+            wait = RATE_MANAGER_QUEUED;
         }
+        // The reserved slot was not used: it belongs to the next waiter
+        if (reserved)
+            grant_waiters(reserved, now);
     }
+    unlock_chain(chain, n);
+    return wait;
+}
 
-    // Otherwise, wait for next available token
-    double wait_time_ns = (1.0 - limit->tokens) / limit->max_rps * 1e9;
-    pthread_mutex_unlock(&g_rate_manager->mutex);
-    return (uint64_t)wait_time_ns;
+uint64_t rate_manager_acquire(const char *key, bool high_priority,
+                              rate_manager_waiter_t *waiter) {
+    return rate_key_acquire(rate_manager_find(key), high_priority, waiter);
 }
 
-void rate_manager_request_done(const char *key) {
-    if(!g_rate_manager)
-        return;
+uint64_t rate_manager_start_request(const char *key, bool high_priority) {
+    return rate_key_acquire(rate_manager_find(key), high_priority, NULL);
+}
 
-    pthread_mutex_lock(&g_rate_manager->mutex);
-    rate_limit_t *limit = rate_limit_find(g_rate_manager->limits, key);
-    if (limit) {
-        if (limit->current_requests > 0) {
-            limit->current_requests--;
-        }
-        limit->last_success = macro_now();
-        limit->backoff_seconds = 1;  // Reset backoff on success
+bool rate_key_cancel_wait(rate_key_t *key, rate_manager_waiter_t *waiter) {
+    (void)key;  /* the waiter may be queued on one of its ancestors */
+    rate_key_t *on = __atomic_load_n(&waiter->queued_on, __ATOMIC_ACQUIRE);
+    if (!on)
+        return false;
+
+    // Not lock_configured: a waiter stays queued on its key regardless
+    pthread_mutex_lock(&on->mutex);
+    bool removed = false;
+    if (waiter->queued && waiter->queued_on == on) {
+        waiter_unlink(waiter->high_priority ? &on->hp_waiters : &on->waiters, waiter);
+        removed = true;
     }
-    pthread_mutex_unlock(&g_rate_manager->mutex);
+    pthread_mutex_unlock(&on->mutex);
+    return removed;
 }
 
-int rate_manager_handle_429(const char *key) {
-    if(!g_rate_manager)
-        return 0;
+bool rate_manager_cancel_wait(const char *key, rate_manager_waiter_t *waiter) {
+    return rate_key_cancel_wait(rate_manager_find(key), waiter);
+}
 
-    pthread_mutex_lock(&g_rate_manager->mutex);
-    rate_limit_t *limit = rate_limit_find(g_rate_manager->limits, key);
-    if (!limit) {
-        pthread_mutex_unlock(&g_rate_manager->mutex);
-        return 0;
+void rate_manager_release_reservation(rate_manager_waiter_t *waiter) {
+    if (waiter)
+        release_reservation(waiter);
+}
+
+/* Gives back the slot req took on each ancestor of key */
+static void release_ancestors(rate_key_t *key, bool success) {
+    rate_key_t *chain[RATE_MANAGER_MAX_DEPTH];
+    int n = key_chain(key, chain);
+    for (int i = 1; i < n; i++) {
+        rate_key_t *limit = lock_configured(chain[i]);
+        if (!limit)
+            continue;
+        give_slot(limit);
+        uint64_t now = macro_now();
+        if (success) {
+            limit->b->last_success = now;
+            limit->b->backoff_seconds = 1;
+        }
+        grant_waiters(limit, now);
+        unlock_key(limit);
     }
+}
 
-    // Decrement current request count since the request finished (but was rate limited)
-    if (limit->current_requests > 0) {
-        limit->current_requests--;
+void rate_key_request_done(rate_key_t *key) {
+    if (!key)
+        return;
+    rate_key_t *limit = lock_configured(key);
+    if (limit) {
+        give_slot(limit);
+        limit->b->last_success = macro_now();
+        limit->b->backoff_seconds = 1;  // Reset backoff on success
+        grant_waiters(limit, limit->b->last_success);
+        unlock_key(limit);
     }
+    release_ancestors(key, true);
+}
+
+void rate_manager_request_done(const char *key) {
+    rate_key_request_done(rate_manager_find(key));
+}
+
+/* Pause the key until `until`; queued waiters go away to wait it out */
+static void pause_key(rate_key_t *limit, uint64_t until) {
+    if (until > limit->b->paused_until)
+        limit->b->paused_until = until;
+    wake_waiters(limit);
+}
+
+/* Server-side wait from a throttled response: Retry-After, or an exhausted
+   quota's reset.  -1 if the response did not say. */
+static int64_t hinted_wait(const rate_manager_hints_t *h) {
+    if (!h) return -1;
+    if (h->retry_after_ns >= 0) return h->retry_after_ns;
+    if (h->remaining == 0 && h->reset_ns >= 0) return h->reset_ns;
+    return -1;
+}
+
+static void apply_hints(rate_key_t *limit, const rate_manager_hints_t *h, uint64_t now) {
+    if (h->quota > 0 && h->window_ns > 0)
+        limit->b->policy_rps = (double)h->quota / ((double)h->window_ns / 1e9);
+    if (h->remaining > 0 && h->reset_ns > 0) {
+        // Spread what is left over the rest of the window
+        limit->b->quota_rps = (double)h->remaining / ((double)h->reset_ns / 1e9);
+        limit->b->quota_until = now + (uint64_t)h->reset_ns;
+        if (limit->b->tokens > h->remaining)
+            limit->b->tokens = (double)h->remaining;
+    }
+}
+
+void rate_key_apply_hints(rate_key_t *key, const rate_manager_hints_t *hints) {
+    if (!hints)
+        return;
+    rate_key_t *limit = lock_configured(key);
+    if (!limit)
+        return;
 
     uint64_t now = macro_now();
-    double time_since_last_success = macro_time_diff(now, limit->last_success);
+    apply_hints(limit, hints, now);
+    int64_t wait = hinted_wait(hints);
+    if (wait > 0)
+        pause_key(limit, now + (uint64_t)wait);
+    unlock_key(limit);
+}
+
+int rate_key_handle_429(rate_key_t *key, const rate_manager_hints_t *hints) {
+    if (!key)
+        return 0;
+    // The response cannot say which level was exceeded: the key the request
+    // named backs off, and its ancestors just get their slots back
+    release_ancestors(key, false);
+    rate_key_t *limit = lock_configured(key);
+    if (!limit)
+        return 0;
 
-    // Adjust backoff behavior for rate-limited responses
-    if (time_since_last_success < 2) {
-        limit->backoff_seconds = 1;  // Reset backoff if a recent success was seen
+    // Decrement current request count since the request finished (but was rate limited)
+    give_slot(limit);
+
+    uint64_t now = macro_now();
+    if (hints)
+        apply_hints(limit, hints, now);
+
+    int64_t wait = hinted_wait(hints);
+    int backoff;
+    if (wait >= 0) {
+        // The server said when to come back: no sooner, and no later
+        backoff = (int)((wait + 999999999) / 1000000000);
+        limit->b->paused_until = now + (uint64_t)wait;
+        wake_waiters(limit);
     } else {
-        limit->backoff_seconds = fmin(limit->backoff_seconds * 2, 60);
+        double time_since_last_success = macro_time_diff(now, limit->b->last_success);
+
+        // Adjust backoff behavior for rate-limited responses
+        if (time_since_last_success < 2) {
+            limit->b->backoff_seconds = 1;  // Reset backoff if a recent success was seen
+        } else {
+            limit->b->backoff_seconds = fmin(limit->b->backoff_seconds * 2, 60);
+        }
+
+        // The whole key backs off: new requests wait out the pause, and the
+        // freed slot is not handed on until it ends
+        backoff = limit->b->backoff_seconds;
+        pause_key(limit, now + (uint64_t)backoff * 1000000000ull);
     }
 
-    pthread_mutex_unlock(&g_rate_manager->mutex);
-    return limit->backoff_seconds;
+    unlock_key(limit);
+    return backoff;
+}
+
+int rate_manager_handle_429(const char *key) {
+    return rate_key_handle_429(rate_manager_find(key), NULL);
+}
+
+/* ────────────────────────────────────────────────────────────────────
+   Response headers
+   ──────────────────────────────────────────────────────────────────── */
+
+void rate_manager_hints_init(rate_manager_hints_t *hints) {
+    hints->retry_after_ns = -1;
+    hints->remaining      = -1;
+    hints->reset_ns       = -1;
+    hints->quota          = -1;
+    hints->window_ns      = -1;
+}
+
+static bool header_is(const char *line, size_t n, const char *name) {
+    return strlen(name) == n && strncasecmp(line, name, n) == 0;
+}
+
+static int64_t seconds_to_ns(double secs) {
+    return secs > 0 ? (int64_t)(secs * 1e9) : 0;
+}
+
+/* Reset as delta seconds, or as a Unix time in seconds or milliseconds
+   (values that large cannot be deltas) */
+static int64_t reset_delay(const char *v) {
+    if (!isdigit((unsigned char)*v))
+        return -1;
+    double d = strtod(v, NULL);
+    if (d >= 1e12) d /= 1000.0;
+    if (d >= 1e9)  d -= (double)time(NULL);
+    return seconds_to_ns(d);
+}
+
+/* `name=<number>` parameter of the first item of a structured header
+   (`"default";q=100;w=60` or `100;w=60`); -1 if absent */
+static double item_param(const char *v, const char *name) {
+    size_t n = strlen(name);
+    const char *end = strchr(v, ',');
+    for (const char *p = strchr(v, ';'); p && (!end || p < end); p = strchr(p + 1, ';')) {
+        const char *q = p + 1;
+        while (isspace((unsigned char)*q)) q++;
+        if (strncasecmp(q, name, n) == 0 && q[n] == '=')
+            return isdigit((unsigned char)q[n + 1]) ? strtod(q + n + 1, NULL) : -1;
+    }
+    return -1;
+}
+
+bool rate_manager_parse_header(rate_manager_hints_t *hints, const char *line) {
+    const char *colon = strchr(line, ':');
+    if (!colon)
+        return false;
+    size_t n = (size_t)(colon - line);
+    const char *v = colon + 1;
+    while (isspace((unsigned char)*v)) v++;
+
+    if (header_is(line, n, "Retry-After")) {
+        // delay-seconds or an HTTP-date
+        if (isdigit((unsigned char)*v)) {
+            hints->retry_after_ns = seconds_to_ns(strtod(v, NULL));
+        } else {
+            time_t t = curl_getdate(v, NULL);
+            if (t == -1) return false;
+            hints->retry_after_ns = seconds_to_ns(difftime(t, time(NULL)));
+        }
+    } else if (header_is(line, n, "X-RateLimit-Remaining") ||
+               header_is(line, n, "RateLimit-Remaining")) {
+        if (!isdigit((unsigned char)*v)) return false;
+        hints->remaining = strtol(v, NULL, 10);
+    } else if (header_is(line, n, "X-RateLimit-Reset") ||
+               header_is(line, n, "RateLimit-Reset")) {
+        hints->reset_ns = reset_delay(v);
+    } else if (header_is(line, n, "X-RateLimit-Limit") ||
+               header_is(line, n, "RateLimit-Limit") ||
+               header_is(line, n, "RateLimit-Policy")) {
+        // `100`, `100;w=60` or `"default";q=100;w=60`
+        double q = isdigit((unsigned char)*v) ? strtod(v, NULL) : item_param(v, "q");
+        double w = item_param(v, "w");
+        if (q >= 0) hints->quota = (long)q;
+        if (w > 0)  hints->window_ns = seconds_to_ns(w);
+    } else if (header_is(line, n, "RateLimit")) {
+        // `"default";r=0;t=30`
+        double r = item_param(v, "r");
+        double t = item_param(v, "t");
+        if (r >= 0) hints->remaining = (long)r;
+        if (t >= 0) hints->reset_ns = seconds_to_ns(t);
+    } else {
+        return false;
+    }
+    return true;
 }
 
 void rate_manager_destroy(void) {
     if (!g_rate_manager) return;
 
-    pthread_mutex_lock(&g_rate_manager->mutex);
-
-    // Iterate over the rate limits map and free each entry
-    macro_map_t *node = macro_map_first(g_rate_manager->limits);
-    while (node) {
-        rate_limit_t *limit = (rate_limit_t *)node;
-        macro_map_erase(&g_rate_manager->limits, node);
-        aml_free(limit->key);
-        aml_free(limit);
-        node = macro_map_first(g_rate_manager->limits);
+    pthread_rwlock_wrlock(&g_rate_manager->lock);
+
+    // Free every interned key; handles are invalid from here on
+    for (size_t i = 0; i < g_rate_manager->num_buckets; i++) {
+        rate_key_t *k = g_rate_manager->buckets[i];
+        while (k) {
+            rate_key_t *next = k->next;
+            pthread_mutex_destroy(&k->mutex);
+            aml_free(k->key);
+            free(k);
+            k = next;
+        }
     }
+    aml_free(g_rate_manager->buckets);
+    rate_shm_close(g_rate_manager->shm);
 
-    pthread_mutex_unlock(&g_rate_manager->mutex);
-    pthread_mutex_destroy(&g_rate_manager->mutex);
+    pthread_rwlock_unlock(&g_rate_manager->lock);
+    pthread_rwlock_destroy(&g_rate_manager->lock);
     aml_free(g_rate_manager);
     g_rate_manager = NULL;
 }
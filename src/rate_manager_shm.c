@@ -0,0 +1,273 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/rate_manager_shm.h"
+#include "a-memory-library/aml_alloc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Layout:
+
+   header     magic (set last, by the creator), size, max_keys and the lock
+              that serializes claiming slots
+   slots[]    open-addressing table by key hash; a slot's name never
+              changes once claimed */
+
+#define RATE_SHM_MAGIC    0x31306d7472636c61ull    /* "alcrtm01" */
+#define RATE_SHM_OWNERS   32
+#define RATE_SHM_REAP_NS  1000000000ull
+#define RATE_SHM_OPEN_TRIES 200                   /* x 5 ms for the creator */
+
+typedef struct {
+    _Atomic uint64_t magic;
+    uint64_t size;
+    uint64_t max_keys;
+    pthread_mutex_t lock;
+} shm_header_t;
+
+typedef struct {
+    int32_t pid;                    /* 0 if free */
+    int32_t held;
+} shm_owner_t;
+
+struct rate_shm_slot_s {
+    _Alignas(64) pthread_mutex_t mutex;
+    bool used;
+    char name[RATE_SHM_NAME_MAX];
+    uint64_t last_reap;             /* 0 forces the next rate_shm_reap */
+    shm_owner_t owners[RATE_SHM_OWNERS];
+    rate_bucket_t bucket;
+};
+
+struct rate_shm_s {
+    shm_header_t *header;
+    rate_shm_slot_t *slots;
+    size_t size;
+};
+
+/* Robust and process-shared: a process that dies holding it cannot wedge
+   the others */
+static void init_mutex(pthread_mutex_t *m) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(m, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/* Returns true if the previous owner died holding the lock */
+static bool lock_mutex(pthread_mutex_t *m) {
+    if (pthread_mutex_lock(m) == EOWNERDEAD) {
+        pthread_mutex_consistent(m);
+        return true;
+    }
+    return false;
+}
+
+/* shm_open wants a leading slash */
+static void shm_path(const char *name, char *out, size_t len) {
+    snprintf(out, len, "%s%s", name[0] == '/' ? "" : "/", name);
+}
+
+static size_t key_slot(const char *key, size_t max_keys) {
+    uint64_t h = 1469598103934665603ull;    /* FNV-1a */
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ull;
+    }
+    return (size_t)(h % max_keys);
+}
+
+static rate_shm_t *create(int fd, size_t max_keys) {
+    size_t size = sizeof(shm_header_t) + max_keys * sizeof(rate_shm_slot_t);
+    if (ftruncate(fd, (off_t)size) != 0)
+        return NULL;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+
+    shm_header_t *h = (shm_header_t *)base;
+    rate_shm_slot_t *slots = (rate_shm_slot_t *)(h + 1);
+    h->size = size;
+    h->max_keys = max_keys;
+    init_mutex(&h->lock);
+    for (size_t i = 0; i < max_keys; i++)
+        init_mutex(&slots[i].mutex);
+    atomic_store_explicit(&h->magic, RATE_SHM_MAGIC, memory_order_release);
+
+    rate_shm_t *shm = (rate_shm_t *)aml_calloc(1, sizeof(*shm));
+    if (!shm) {
+        fprintf(stderr, "[rate_shm_open] Memory allocation failed.\n");
+        munmap(base, size);
+        errno = ENOMEM;
+        return NULL;
+    }
+    shm->header = h;
+    shm->slots = slots;
+    shm->size = size;
+    return shm;
+}
+
+/* Someone else created it: wait for the header, then map all of it.  A
+   creator that died before setting the magic leaves a segment that never
+   becomes ready; only unlinking it clears that. */
+static rate_shm_t *attach(int fd) {
+    for (int i = 0; i < RATE_SHM_OPEN_TRIES; i++) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(shm_header_t)) {
+            shm_header_t *h = (shm_header_t *)mmap(NULL, sizeof(shm_header_t), PROT_READ,
+                                                   MAP_SHARED, fd, 0);
+            if (h == MAP_FAILED)
+                return NULL;
+            bool ready = atomic_load_explicit(&h->magic, memory_order_acquire) == RATE_SHM_MAGIC;
+            size_t size = (size_t)h->size;
+            munmap(h, sizeof(shm_header_t));
+            if (ready) {
+                void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (base == MAP_FAILED)
+                    return NULL;
+                rate_shm_t *shm = (rate_shm_t *)aml_calloc(1, sizeof(*shm));
+                if (!shm) {
+                    fprintf(stderr, "[rate_shm_open] Memory allocation failed.\n");
+                    munmap(base, size);
+                    errno = ENOMEM;
+                    return NULL;
+                }
+                shm->header = (shm_header_t *)base;
+                shm->slots = (rate_shm_slot_t *)(shm->header + 1);
+                shm->size = size;
+                return shm;
+            }
+        }
+        usleep(5000);
+    }
+    errno = ETIMEDOUT;
+    return NULL;
+}
+
+rate_shm_t *rate_shm_open(const char *name, size_t max_keys) {
+    char path[256];
+    shm_path(name, path, sizeof(path));
+
+    rate_shm_t *shm = NULL;
+    int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        shm = create(fd, max_keys);
+        if (!shm)
+            shm_unlink(path);
+    } else if (errno == EEXIST && (fd = shm_open(path, O_RDWR, 0600)) >= 0) {
+        shm = attach(fd);
+    }
+    if (!shm && errno == ETIMEDOUT)
+        fprintf(stderr, "[rate_shm_open] %s was never initialized; its creator may have "
+                        "died.  Remove it with rate_manager_unlink_shared.\n", path);
+    else if (!shm && errno != ENOMEM)
+        fprintf(stderr, "[rate_shm_open] %s: %s\n", path, strerror(errno));
+    if (fd >= 0)
+        close(fd);
+    return shm;
+}
+
+void rate_shm_close(rate_shm_t *shm) {
+    if (!shm) return;
+    munmap(shm->header, shm->size);
+    aml_free(shm);
+}
+
+bool rate_shm_unlink(const char *name) {
+    char path[256];
+    shm_path(name, path, sizeof(path));
+    return shm_unlink(path) == 0;
+}
+
+rate_shm_slot_t *rate_shm_slot(rate_shm_t *shm, const char *key) {
+    if (strlen(key) >= RATE_SHM_NAME_MAX)
+        return NULL;
+
+    size_t n = (size_t)shm->header->max_keys;
+    size_t i = key_slot(key, n);
+    rate_shm_slot_t *found = NULL;
+    lock_mutex(&shm->header->lock);
+    for (size_t probe = 0; probe < n; probe++, i = (i + 1) % n) {
+        rate_shm_slot_t *s = &shm->slots[i];
+        if (!s->used) {
+            strcpy(s->name, key);
+            s->used = true;
+            found = s;
+            break;
+        }
+        if (strcmp(s->name, key) == 0) {
+            found = s;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shm->header->lock);
+    return found;
+}
+
+rate_bucket_t *rate_shm_bucket(rate_shm_slot_t *slot) {
+    return &slot->bucket;
+}
+
+void rate_shm_lock(rate_shm_slot_t *slot) {
+    if (lock_mutex(&slot->mutex))
+        slot->last_reap = 0;    /* its owner died: look for its slots now */
+}
+
+void rate_shm_unlock(rate_shm_slot_t *slot) {
+    pthread_mutex_unlock(&slot->mutex);
+}
+
+void rate_shm_hold(rate_shm_slot_t *slot, int delta) {
+    int32_t pid = (int32_t)getpid();
+    shm_owner_t *free_owner = NULL;
+    for (int i = 0; i < RATE_SHM_OWNERS; i++) {
+        shm_owner_t *o = &slot->owners[i];
+        if (o->pid == pid) {
+            o->held += delta;
+            if (o->held <= 0) {
+                o->pid = 0;
+                o->held = 0;
+            }
+            return;
+        }
+        if (!o->pid && !free_owner)
+            free_owner = o;
+    }
+    // With more processes than owner entries, the rest go untracked
+    if (delta > 0 && free_owner) {
+        free_owner->pid = pid;
+        free_owner->held = delta;
+    }
+}
+
+bool rate_shm_reap(rate_shm_slot_t *slot, uint64_t now) {
+    if (slot->last_reap && now - slot->last_reap < RATE_SHM_REAP_NS)
+        return false;
+    slot->last_reap = now;
+
+    bool freed = false;
+    for (int i = 0; i < RATE_SHM_OWNERS; i++) {
+        shm_owner_t *o = &slot->owners[i];
+        if (!o->pid || kill(o->pid, 0) == 0 || errno != ESRCH)
+            continue;
+        slot->bucket.current_requests -= o->held;
+        if (slot->bucket.current_requests < 0)
+            slot->bucket.current_requests = 0;
+        o->pid = 0;
+        o->held = 0;
+        freed = true;
+    }
+    return freed;
+}
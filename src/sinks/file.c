@@ -46,7 +46,7 @@ void file_failure(CURLcode result, long http_code, curl_sink_interface_t *interf
 
     // Trigger the callback with failure details
     if (file->callback) {
-        const char *error_msg = curl_easy_strerror(result);
+        const char *error_msg = curl_event_strerror(result);
         file->callback(file->filename, false, result, http_code, error_msg, file->callback_arg, req);
     }
 }
@@ -42,7 +42,7 @@ void memory_failure(CURLcode result, long http_code, curl_sink_interface_t *inte
     memory_sink_t *mem = (memory_sink_t *)interface;
     fprintf(stderr, "[memory_sink] Download failed (CURLcode: %d, HTTP code: %ld).\n", result, http_code);
 
-    const char *error_msg = curl_easy_strerror(result);
+    const char *error_msg = curl_event_strerror(result);
     mem->callback(aml_buffer_data(mem->buffer), aml_buffer_length(mem->buffer), false, result, http_code, error_msg,
                   mem->callback_arg, req);
 
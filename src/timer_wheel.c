@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-curl-library/impl/timer_wheel.h"
+
+/* Level l holds timers whose distance from `now` is < 2^(8*(l+1)) ms and
+   hashes them by bits [8l, 8l+8) of the absolute expiry.  A level-l slot is
+   cascaded into lower levels when `now` reaches a multiple of 2^(8l) whose
+   level-l index matches that slot. */
+
+#define LEVEL_SHIFT(l) ((unsigned)(l) * TIMER_WHEEL_BITS)
+#define OVERFLOW_SPAN  (1ull << LEVEL_SHIFT(TIMER_WHEEL_LEVELS))
+
+static inline void bit_set(uint64_t *bm, unsigned i)   { bm[i >> 6] |=  (1ull << (i & 63)); }
+static inline void bit_clear(uint64_t *bm, unsigned i) { bm[i >> 6] &= ~(1ull << (i & 63)); }
+
+/* First set bit in [from, TIMER_WHEEL_SLOTS), or -1 */
+static int bitmap_next(const uint64_t *bm, unsigned from) {
+    if (from >= TIMER_WHEEL_SLOTS) return -1;
+    unsigned word = from >> 6;
+    uint64_t bits = bm[word] & (~0ull << (from & 63));
+    for (;;) {
+        if (bits) return (int)(word * 64 + (unsigned)__builtin_ctzll(bits));
+        if (++word == TIMER_WHEEL_SLOTS / 64) return -1;
+        bits = bm[word];
+    }
+}
+
+void timer_wheel_init(timer_wheel_t *w, uint64_t now_ms) {
+    w->now = now_ms;
+    w->count = 0;
+    for (unsigned l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for (unsigned s = 0; s < TIMER_WHEEL_SLOTS; s++)
+            timer_list_init(&w->slots[l][s]);
+        for (unsigned i = 0; i < TIMER_WHEEL_SLOTS / 64; i++)
+            w->bitmap[l][i] = 0;
+    }
+    timer_list_init(&w->overflow);
+}
+
+static void place(timer_wheel_t *w, timer_node_t *n) {
+    uint64_t delta = n->expires - w->now;
+    for (unsigned l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        if (delta < (1ull << LEVEL_SHIFT(l + 1))) {
+            unsigned s = (unsigned)(n->expires >> LEVEL_SHIFT(l)) & TIMER_WHEEL_MASK;
+            timer_list_append(&w->slots[l][s], n);
+            bit_set(w->bitmap[l], s);
+            return;
+        }
+    }
+    timer_list_append(&w->overflow, n);
+}
+
+void timer_wheel_insert(timer_wheel_t *w, timer_node_t *n, uint64_t expires_ms) {
+    n->expires = expires_ms < w->now ? w->now : expires_ms;
+    place(w, n);
+    w->count++;
+}
+
+void timer_wheel_remove(timer_wheel_t *w, timer_node_t *n) {
+    if (!timer_node_linked(n)) return;
+    /* Last node in its slot: the neighbour on both sides is the slot head */
+    if (n->next == n->prev) {
+        timer_node_t *head = n->next;
+        timer_node_t *first = &w->slots[0][0];
+        if (head >= first && head < first + TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS) {
+            size_t idx = (size_t)(head - first);
+            bit_clear(w->bitmap[idx / TIMER_WHEEL_SLOTS], (unsigned)(idx % TIMER_WHEEL_SLOTS));
+        }
+    }
+    timer_list_unlink(n);
+    w->count--;
+}
+
+/* Re-place every timer of one list relative to the current tick */
+static void replace_list(timer_wheel_t *w, timer_node_t *head) {
+    timer_node_t tmp;
+    if (timer_list_empty(head)) return;
+    /* move the whole chain to tmp so place() may append back to head */
+    tmp.next = head->next;
+    tmp.prev = head->prev;
+    tmp.next->prev = &tmp;
+    tmp.prev->next = &tmp;
+    timer_list_init(head);
+    while (!timer_list_empty(&tmp)) {
+        timer_node_t *n = tmp.next;
+        timer_list_unlink(n);
+        place(w, n);
+    }
+}
+
+/* t is a multiple of 256: pull down every level whose boundary it is,
+   highest first so re-placed timers land in slots still to be processed. */
+static void cascade(timer_wheel_t *w, uint64_t t) {
+    if ((t & (OVERFLOW_SPAN - 1)) == 0)
+        replace_list(w, &w->overflow);
+    for (unsigned l = TIMER_WHEEL_LEVELS - 1; l >= 1; l--) {
+        if (t & ((1ull << LEVEL_SHIFT(l)) - 1)) continue;
+        unsigned s = (unsigned)(t >> LEVEL_SHIFT(l)) & TIMER_WHEEL_MASK;
+        bit_clear(w->bitmap[l], s);
+        replace_list(w, &w->slots[l][s]);
+    }
+}
+
+size_t timer_wheel_advance(timer_wheel_t *w, uint64_t now_ms, timer_node_t *expired) {
+    size_t moved = 0;
+    while (w->now <= now_ms) {
+        if (w->count == 0) {
+            w->now = now_ms + 1;
+            break;
+        }
+        uint64_t t = w->now;
+        unsigned s = (unsigned)t & TIMER_WHEEL_MASK;
+        if (s == 0)
+            cascade(w, t);
+
+        timer_node_t *head = &w->slots[0][s];
+        while (!timer_list_empty(head)) {
+            timer_node_t *n = head->next;
+            timer_list_unlink(n);
+            timer_list_append(expired, n);
+            w->count--;
+            moved++;
+        }
+        bit_clear(w->bitmap[0], s);
+
+        /* Jump to the next occupied level-0 slot, but never past a 256 ms
+           boundary (cascades must run) or past now_ms. */
+        int nx = bitmap_next(w->bitmap[0], s + 1);
+        uint64_t next = nx >= 0 ? (t & ~(uint64_t)TIMER_WHEEL_MASK) + (unsigned)nx
+                                : (t | TIMER_WHEEL_MASK) + 1;
+        w->now = next <= now_ms ? next : now_ms + 1;
+    }
+    return moved;
+}
+
+uint64_t timer_wheel_next_expiry(const timer_wheel_t *w) {
+    if (w->count == 0) return UINT64_MAX;
+
+    uint64_t best = UINT64_MAX;
+    for (unsigned l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        unsigned shift = LEVEL_SHIFT(l);
+        uint64_t base = (w->now >> shift) << shift;     /* start of current level-l slot */
+        unsigned cur = (unsigned)(w->now >> shift) & TIMER_WHEEL_MASK;
+        /* The current slot is still due at `base` only if no tick of it has
+           been processed yet (always true at level 0). */
+        unsigned from = (l == 0 || w->now == base) ? cur : cur + 1;
+
+        int j = bitmap_next(w->bitmap[l], from);
+        uint64_t when;
+        if (j >= 0) {
+            when = base + ((uint64_t)((unsigned)j - cur) << shift);
+            /* before the next 256 ms boundary nothing can cascade in */
+            if (l == 0) return when;
+        } else {
+            j = bitmap_next(w->bitmap[l], 0);
+            if (j < 0 || (unsigned)j >= from) continue;
+            when = base + ((uint64_t)(TIMER_WHEEL_SLOTS - cur + (unsigned)j) << shift);
+        }
+        if (when < best) best = when;
+    }
+    if (!timer_list_empty(&w->overflow)) {
+        uint64_t when = (w->now | (OVERFLOW_SPAN - 1)) + 1;
+        if (when < best) best = when;
+    }
+    return best;
+}
+
+size_t timer_wheel_drain(timer_wheel_t *w, timer_node_t *out) {
+    size_t moved = 0;
+    for (unsigned l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for (unsigned s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+            timer_node_t *head = &w->slots[l][s];
+            while (!timer_list_empty(head)) {
+                timer_node_t *n = head->next;
+                timer_list_unlink(n);
+                timer_list_append(out, n);
+                moved++;
+            }
+        }
+        for (unsigned i = 0; i < TIMER_WHEEL_SLOTS / 64; i++)
+            w->bitmap[l][i] = 0;
+    }
+    while (!timer_list_empty(&w->overflow)) {
+        timer_node_t *n = w->overflow.next;
+        timer_list_unlink(n);
+        timer_list_append(out, n);
+        moved++;
+    }
+    w->count = 0;
+    return moved;
+}
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+/* Fixtures shared by the event loop tests (one test program per file, so
+   everything here is static) */
+
+#ifndef LOOP_FIXTURES_H
+#define LOOP_FIXTURES_H
+
+#include "a-curl-library/curl_event_request.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------------ */
+/* file:// requests: no network, finished counts every completion      */
+
+static atomic_int finished;
+
+static inline int count_complete(CURL *easy, struct curl_event_request_s *req) {
+    (void)easy; (void)req; atomic_fetch_add(&finished, 1); return 0;
+}
+/* file:// has no HTTP status, so the loop reports it through on_failure */
+static inline int count_failure(CURL *easy, CURLcode res, long http,
+                                struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http; (void)req; atomic_fetch_add(&finished, 1); return 0;
+}
+static inline size_t noop_write(void *p, size_t s, size_t n, struct curl_event_request_s *req) {
+    (void)p; (void)req; return s*n;
+}
+
+/* A request for url that counts in `finished` when it ends */
+static inline curl_event_request_t *counted_request(const char *url) {
+    curl_event_request_t *req = curl_event_request_init(0);
+    curl_event_request_url(req, url);
+    curl_event_request_on_complete(req, count_complete);
+    curl_event_request_on_failure(req, count_failure);
+    curl_event_request_on_write(req, noop_write);
+    return req;
+}
+
+/* ------------------------------------------------------------------ */
+/* Loopback HTTP server on 127.0.0.1:loopback_port.  Each connection is
+   served on its own thread: the request is read once and handed to the
+   test's respond callback, which writes the reply; the connection is
+   closed afterwards. */
+
+typedef void (*loopback_respond_cb)(int fd, const char *request);
+
+static int loopback_listen_fd = -1;
+static int loopback_port = 0;
+static loopback_respond_cb loopback_respond = NULL;
+
+static inline void loopback_send(int fd, const char *data) {
+    send(fd, data, strlen(data), MSG_NOSIGNAL);
+}
+
+static inline void *loopback_serve_conn(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    char buf[2048];
+    ssize_t n = recv(fd, buf, sizeof(buf) - 1, 0);
+    if (n > 0) {
+        buf[n] = 0;
+        loopback_respond(fd, buf);
+    }
+    close(fd);
+    return NULL;
+}
+
+static inline void *loopback_serve(void *arg) {
+    (void)arg;
+    for (;;) {
+        int fd = accept(loopback_listen_fd, NULL, NULL);
+        if (fd < 0) return NULL;
+        pthread_t t;
+        pthread_create(&t, NULL, loopback_serve_conn, (void *)(intptr_t)fd);
+        pthread_detach(t);
+    }
+}
+
+static inline bool loopback_start(loopback_respond_cb respond) {
+    loopback_respond = respond;
+    loopback_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (loopback_listen_fd < 0) return false;
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(a);
+    if (bind(loopback_listen_fd, (struct sockaddr *)&a, len) != 0 ||
+        listen(loopback_listen_fd, 16) != 0 ||
+        getsockname(loopback_listen_fd, (struct sockaddr *)&a, &len) != 0)
+        return false;
+    loopback_port = ntohs(a.sin_port);
+    pthread_t t;
+    pthread_create(&t, NULL, loopback_serve, NULL);
+    pthread_detach(t);
+    return true;
+}
+
+#endif /* LOOP_FIXTURES_H */
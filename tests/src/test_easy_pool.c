@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+static void submit_batch(curl_event_loop_t *loop, int n) {
+    for (int i = 0; i < n; i++) {
+        curl_event_request_submitp(loop, counted_request("file:///dev/null"));
+    }
+}
+
+MACRO_TEST(easy_pool_reuses_handles) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    finished = 0;
+
+    /* first batch starts together: every handle is new */
+    submit_batch(loop, 10);
+    curl_event_loop_run(loop);
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT(finished, 10);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_misses, 10);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_hits, 0);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_high_water, 10);
+
+    /* second batch is served entirely from the pool */
+    submit_batch(loop, 10);
+    curl_event_loop_run(loop);
+    m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT(finished, 20);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_misses, 10);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_hits, 10);
+
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(easy_pool_cap) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    finished = 0;
+
+    curl_event_loop_set_easy_pool_size(loop, 4);
+    submit_batch(loop, 10);
+    curl_event_loop_run(loop);
+    submit_batch(loop, 10);
+    curl_event_loop_run(loop);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_hits, 4);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_misses, 16);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_high_water, 4);
+
+    /* pooling disabled */
+    curl_event_loop_set_easy_pool_size(loop, 0);
+    submit_batch(loop, 3);
+    curl_event_loop_run(loop);
+    m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.easy_handle_misses, 19);
+
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, easy_pool_reuses_handles);
+    MACRO_ADD(tests, easy_pool_cap);
+    macro_run_all("a-curl-library/easy_pool", tests, test_count);
+    return 0;
+}
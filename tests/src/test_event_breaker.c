@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Loopback HTTP server answering 503 until `healthy` is set, then "hello" */
+static int healthy = 0;
+static int served = 0;
+
+static void respond(int fd, const char *request) {
+    (void)request;
+    __atomic_add_fetch(&served, 1, __ATOMIC_SEQ_CST);
+    loopback_send(fd, __atomic_load_n(&healthy, __ATOMIC_SEQ_CST)
+        ? "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nConnection: close\r\n\r\nhello"
+        : "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+          "Connection: close\r\n\r\n");
+}
+
+static int num_ok = 0;
+static int num_failed = 0;
+static int num_open = 0;    /* failed with CURL_EVENT_E_CIRCUIT_OPEN */
+
+static int done(CURL *easy, struct curl_event_request_s *req) {
+    (void)easy; (void)req;
+    num_ok++;
+    return 0;
+}
+
+static int failed(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)http; (void)req;
+    if (res == CURL_EVENT_E_CIRCUIT_OPEN) num_open++;
+    else num_failed++;
+    return 0;
+}
+
+static void submit(curl_event_loop_t *loop, int n) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", loopback_port);
+    for (int i = 0; i < n; i++) {
+        curl_event_request_t *req = curl_event_request_build_get(url, NULL, done);
+        curl_event_request_on_failure(req, failed);
+        curl_event_request_submitp(loop, req);
+    }
+}
+
+static void reset(int up) {
+    num_ok = num_failed = num_open = 0;
+    __atomic_store_n(&healthy, up, __ATOMIC_SEQ_CST);
+}
+
+static char key[32];
+
+MACRO_TEST(breaker_fails_fast_then_probes) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_breaker_config_t cfg = { .consecutive_failures = 2, .open_ms = 200 };
+    MACRO_ASSERT_TRUE(curl_event_loop_set_breaker(loop, &cfg));
+
+    reset(0);
+    submit(loop, 2);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_failed, 2);
+    MACRO_ASSERT_EQ_INT(curl_event_loop_breaker_state(loop, key), CURL_EVENT_BREAKER_OPEN);
+
+    /* open: no transfer */
+    int before = __atomic_load_n(&served, __ATOMIC_SEQ_CST);
+    submit(loop, 1);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_open, 1);
+    MACRO_ASSERT_EQ_INT(__atomic_load_n(&served, __ATOMIC_SEQ_CST), before);
+
+    /* half-open: the first request probes, the second still fails fast */
+    reset(1);
+    usleep(250 * 1000);
+    submit(loop, 2);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_ok, 1);
+    MACRO_ASSERT_EQ_INT(num_open, 1);
+    MACRO_ASSERT_EQ_INT(curl_event_loop_breaker_state(loop, key), CURL_EVENT_BREAKER_CLOSED);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.breaker_trips, 1);
+    MACRO_ASSERT_EQ_INT((int)m.breaker_half_opens, 1);
+    MACRO_ASSERT_EQ_INT((int)m.breaker_recoveries, 1);
+    MACRO_ASSERT_EQ_INT((int)m.breaker_probes, 1);
+    MACRO_ASSERT_EQ_INT((int)m.breaker_rejected, 2);
+    MACRO_ASSERT_EQ_INT((int)m.breakers_open, 0);
+    curl_event_loop_destroy(loop);
+}
+
+static int transitions[8];
+static int num_transitions = 0;
+
+static void on_change(const char *k, curl_event_breaker_state_t from,
+                      curl_event_breaker_state_t to, void *arg) {
+    (void)k; (void)from; (void)arg;
+    if (num_transitions < 8) transitions[num_transitions++] = to;
+}
+
+MACRO_TEST(breaker_parks_until_recovered) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_breaker_config_t cfg = {
+        .failure_rate = 0.5, .min_requests = 2, .open_ms = 200, .park = true,
+        .on_change = on_change
+    };
+    MACRO_ASSERT_TRUE(curl_event_loop_set_breaker(loop, &cfg));
+
+    reset(0);
+    submit(loop, 2);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_failed, 2);
+
+    /* parked, not failed: the probe closes the breaker and the rest follow */
+    reset(1);
+    submit(loop, 3);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_ok, 3);
+    MACRO_ASSERT_EQ_INT(num_open, 0);
+
+    MACRO_ASSERT_EQ_INT(num_transitions, 3);
+    MACRO_ASSERT_EQ_INT(transitions[0], CURL_EVENT_BREAKER_OPEN);
+    MACRO_ASSERT_EQ_INT(transitions[1], CURL_EVENT_BREAKER_HALF_OPEN);
+    MACRO_ASSERT_EQ_INT(transitions[2], CURL_EVENT_BREAKER_CLOSED);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).breaker_parked, 3);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    if (!loopback_start(respond)) {
+        fprintf(stderr, "loopback server unavailable; skipping\n");
+        return 0;
+    }
+    snprintf(key, sizeof(key), "127.0.0.1:%d", loopback_port);
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, breaker_fails_fast_then_probes);
+    MACRO_ADD(tests, breaker_parks_until_recovered);
+    macro_run_all("a-curl-library/event_breaker", tests, test_count);
+    return 0;
+}
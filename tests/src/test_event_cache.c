@@ -0,0 +1,239 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+#include "a-curl-library/sinks/memory.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Loopback HTTP server:
+     /fresh     max-age=60, body "fresh"
+     /tagged    no-cache + ETag "v1"; 304 when If-None-Match matches
+     /big/N     max-age=60, 400 byte body
+     /huge/N    max-age=60, 30000 byte body
+   and counts the requests that reached it. */
+static int hits_200 = 0;
+static int hits_304 = 0;
+
+static void respond(int fd, const char *req) {
+    char head[256];
+    static char big[30001];
+    const char *extra = "Cache-Control: max-age=60\r\n";
+    const char *body = "fresh";
+    if (strncmp(req, "GET /tagged", 11) == 0) {
+        extra = "Cache-Control: no-cache\r\nETag: \"v1\"\r\n";
+        body = "tagged";
+    } else if (strncmp(req, "GET /big", 8) == 0 || strncmp(req, "GET /huge", 9) == 0) {
+        size_t n = req[5] == 'b' ? 400 : 30000;
+        memset(big, 'x', n);
+        big[n] = '\0';
+        body = big;
+    }
+    if (strstr(req, "If-None-Match: \"v1\"")) {
+        __atomic_add_fetch(&hits_304, 1, __ATOMIC_SEQ_CST);
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 304 Not Modified\r\n%sConnection: close\r\n\r\n", extra);
+        loopback_send(fd, head);
+    } else {
+        __atomic_add_fetch(&hits_200, 1, __ATOMIC_SEQ_CST);
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 200 OK\r\n%sContent-Length: %zu\r\n"
+                 "Connection: close\r\n\r\n", extra, strlen(body));
+        loopback_send(fd, head);
+        loopback_send(fd, body);
+    }
+}
+
+/* fetched through a memory sink, so cache hits exercise init/write/complete */
+static char got[32768];
+static size_t got_len = 0;
+static bool got_ok = false;
+
+static void on_body(char *data, size_t length, bool success, CURLcode result,
+                    long http_code, const char *error_msg, void *arg,
+                    curl_event_request_t *req) {
+    (void)result; (void)http_code; (void)error_msg; (void)arg; (void)req;
+    got_len = length < sizeof(got) - 1 ? length : sizeof(got) - 1;
+    memcpy(got, data, got_len);
+    got[got_len] = '\0';
+    got_ok = success;
+}
+
+static void fetch(curl_event_loop_t *loop, const char *path) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d%s", loopback_port, path);
+    curl_event_request_t *req = curl_event_request_init(0);
+    curl_event_request_url(req, url);
+    memory_sink(req, on_body, NULL);
+    got_len = 0;
+    got_ok = false;
+    curl_event_request_submitp(loop, req);
+    curl_event_loop_run(loop);
+}
+
+static void reset(void) {
+    hits_200 = hits_304 = 0;
+}
+
+MACRO_TEST(cache_serves_fresh_response_without_network) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_cache(loop, 1 << 20));
+    reset();
+
+    fetch(loop, "/fresh");
+    MACRO_ASSERT_TRUE(got_ok && strcmp(got, "fresh") == 0);
+    fetch(loop, "/fresh");
+    MACRO_ASSERT_TRUE(got_ok && strcmp(got, "fresh") == 0);
+
+    MACRO_ASSERT_EQ_INT(hits_200, 1);
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.cache_hits, 1);
+    MACRO_ASSERT_EQ_INT((int)m.cache_misses, 1);
+    MACRO_ASSERT_EQ_INT((int)m.completed_requests, 2);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(cache_revalidates_with_etag) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_cache(loop, 1 << 20));
+    reset();
+
+    fetch(loop, "/tagged");
+    fetch(loop, "/tagged");
+    MACRO_ASSERT_TRUE(got_ok && strcmp(got, "tagged") == 0);
+
+    MACRO_ASSERT_EQ_INT(hits_200, 1);
+    MACRO_ASSERT_EQ_INT(hits_304, 1);
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.cache_revalidations, 1);
+    MACRO_ASSERT_EQ_INT((int)m.cache_hits, 1);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(cache_evicts_least_recently_used) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_cache(loop, 1200));   /* two bodies */
+    reset();
+
+    fetch(loop, "/big/1");
+    fetch(loop, "/big/2");
+    fetch(loop, "/big/1");          /* hit: /big/2 is now the oldest */
+    fetch(loop, "/big/3");          /* evicts /big/2 */
+    MACRO_ASSERT_EQ_INT(hits_200, 3);
+    fetch(loop, "/big/1");
+    MACRO_ASSERT_EQ_INT(hits_200, 3);
+    fetch(loop, "/big/2");
+    MACRO_ASSERT_EQ_INT(hits_200, 4);
+    MACRO_ASSERT_EQ_INT((int)got_len, 400);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.cache_hits, 2);
+    MACRO_ASSERT_TRUE(m.cache_evictions >= 1);
+    curl_event_loop_destroy(loop);
+}
+
+static int count_segments(const char *dir) {
+    int n = 0;
+    DIR *dp = opendir(dir);
+    struct dirent *de;
+    while (dp && (de = readdir(dp)) != NULL)
+        n += strncmp(de->d_name, "seg-", 4) == 0;
+    if (dp) closedir(dp);
+    return n;
+}
+
+static void remove_dir(const char *dir) {
+    char path[512];
+    DIR *dp = opendir(dir);
+    struct dirent *de;
+    while (dp && (de = readdir(dp)) != NULL) {
+        if (de->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+        unlink(path);
+    }
+    if (dp) closedir(dp);
+    rmdir(dir);
+}
+
+MACRO_TEST(disk_cache_survives_restart) {
+    char dir[] = "/tmp/curl_event_cache_XXXXXX";
+    MACRO_ASSERT_TRUE(mkdtemp(dir) != NULL);
+    reset();
+
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_disk_cache(loop, dir, 1 << 20));
+    /* one loop per directory */
+    curl_event_loop_t *other = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(!curl_event_loop_set_disk_cache(other, dir, 1 << 20));
+    curl_event_loop_destroy(other);
+    fetch(loop, "/fresh");
+    fetch(loop, "/tagged");
+    curl_event_loop_destroy(loop);
+    MACRO_ASSERT_EQ_INT(hits_200, 2);
+
+    loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_disk_cache(loop, dir, 1 << 20));
+    fetch(loop, "/fresh");
+    MACRO_ASSERT_TRUE(got_ok && strcmp(got, "fresh") == 0);
+    fetch(loop, "/tagged");         /* stale on disk: revalidated */
+    MACRO_ASSERT_TRUE(got_ok && strcmp(got, "tagged") == 0);
+    MACRO_ASSERT_EQ_INT(hits_200, 2);
+    MACRO_ASSERT_EQ_INT(hits_304, 1);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.cache_hits, 2);
+    MACRO_ASSERT_EQ_INT((int)m.cache_disk_hits, 1);
+    curl_event_loop_destroy(loop);
+    remove_dir(dir);
+}
+
+MACRO_TEST(disk_cache_drops_oldest_segment) {
+    char dir[] = "/tmp/curl_event_cache_XXXXXX";
+    MACRO_ASSERT_TRUE(mkdtemp(dir) != NULL);
+    reset();
+
+    /* 64 KiB segments (the minimum) holding two bodies each */
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_disk_cache(loop, dir, 128 * 1024));
+    char path[32];
+    for (int i = 1; i <= 6; i++) {
+        snprintf(path, sizeof(path), "/huge/%d", i);
+        fetch(loop, path);
+    }
+    MACRO_ASSERT_EQ_INT(hits_200, 6);
+    MACRO_ASSERT_TRUE(count_segments(dir) <= 3);
+
+    fetch(loop, "/huge/6");
+    MACRO_ASSERT_EQ_INT((int)got_len, 30000);
+    MACRO_ASSERT_EQ_INT(hits_200, 6);
+    fetch(loop, "/huge/1");         /* went with the first segment */
+    MACRO_ASSERT_EQ_INT(hits_200, 7);
+    curl_event_loop_destroy(loop);
+    remove_dir(dir);
+}
+
+int main(void) {
+    if (!loopback_start(respond)) {
+        fprintf(stderr, "loopback server unavailable; skipping\n");
+        return 0;
+    }
+    macro_test_case tests[8];
+    size_t test_count = 0;
+    MACRO_ADD(tests, cache_serves_fresh_response_without_network);
+    MACRO_ADD(tests, cache_revalidates_with_etag);
+    MACRO_ADD(tests, cache_evicts_least_recently_used);
+    MACRO_ADD(tests, disk_cache_survives_restart);
+    MACRO_ADD(tests, disk_cache_drops_oldest_segment);
+    macro_run_all("a-curl-library/event_cache", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Loopback HTTP server answering "hello" after 300 ms, counting connections */
+static int connections = 0;
+
+static void respond(int fd, const char *request) {
+    (void)request;
+    __atomic_add_fetch(&connections, 1, __ATOMIC_SEQ_CST);
+    usleep(300 * 1000);
+    loopback_send(fd, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n"
+                      "Connection: close\r\n\r\nhello");
+}
+
+#define N 5
+static char bodies[N][16];
+static size_t lens[N];
+static int completed[N];
+
+static size_t collect(void *p, size_t s, size_t n, struct curl_event_request_s *req) {
+    int id = (int)(intptr_t)req->plugin_data;
+    size_t len = s * n;
+    if (lens[id] + len < sizeof(bodies[id])) {
+        memcpy(bodies[id] + lens[id], p, len);
+        lens[id] += len;
+    }
+    return len;
+}
+static int done(CURL *easy, struct curl_event_request_s *req) {
+    (void)easy;
+    completed[(int)(intptr_t)req->plugin_data]++;
+    return 0;
+}
+
+static curl_event_request_t *make(int id, const char *auth) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/hot", loopback_port);
+    curl_event_request_t *req = curl_event_request_build_get(url, collect, done);
+    if (auth) curl_event_request_set_header(req, "Authorization", auth);
+    curl_event_request_coalesce(req, NULL);
+    req->plugin_data = (void *)(intptr_t)id;
+    return req;
+}
+
+static void reset(void) {
+    memset(bodies, 0, sizeof(bodies));
+    memset(lens, 0, sizeof(lens));
+    memset(completed, 0, sizeof(completed));
+    connections = 0;
+}
+
+MACRO_TEST(coalesce_identical_gets_share_one_transfer) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    reset();
+
+    curl_event_request_t *reqs[N];
+    for (int i = 0; i < N; i++)
+        reqs[i] = curl_event_request_submitp(loop, make(i, i == N - 1 ? "Bearer other" : NULL));
+    curl_event_loop_step(loop);
+    MACRO_ASSERT_TRUE(curl_event_loop_cancel(loop, reqs[2]));   /* a follower */
+    curl_event_loop_run(loop);
+
+    /* #4 has a different Authorization header, so its own transfer */
+    MACRO_ASSERT_EQ_INT(connections, 2);
+    for (int i = 0; i < N; i++) {
+        if (i == 2) {
+            MACRO_ASSERT_EQ_INT(completed[i], 0);
+            MACRO_ASSERT_EQ_INT((int)lens[i], 0);
+            continue;
+        }
+        MACRO_ASSERT_EQ_INT(completed[i], 1);
+        MACRO_ASSERT_TRUE(strcmp(bodies[i], "hello") == 0);
+    }
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).coalesced_requests, 3);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(coalesce_cancelled_leader_hands_off) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    reset();
+
+    curl_event_request_t *reqs[3];
+    for (int i = 0; i < 3; i++)
+        reqs[i] = curl_event_request_submitp(loop, make(i, NULL));
+    curl_event_loop_step(loop);
+    MACRO_ASSERT_TRUE(curl_event_loop_cancel(loop, reqs[0]));  /* the leader */
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_EQ_INT(completed[0], 0);
+    MACRO_ASSERT_EQ_INT(completed[1], 1);
+    MACRO_ASSERT_EQ_INT(completed[2], 1);
+    MACRO_ASSERT_TRUE(strcmp(bodies[1], "hello") == 0 && strcmp(bodies[2], "hello") == 0);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    if (!loopback_start(respond)) {
+        fprintf(stderr, "loopback server unavailable; skipping\n");
+        return 0;
+    }
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, coalesce_identical_gets_share_one_transfer);
+    MACRO_ADD(tests, coalesce_cancelled_leader_hands_off);
+    macro_run_all("a-curl-library/event_coalesce", tests, test_count);
+    return 0;
+}
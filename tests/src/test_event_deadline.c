@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "the-macro-library/macro_time.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <string.h>
+
+static int order[16];
+static CURLcode codes[16];
+static int num_done = 0;
+
+/* file:// has no HTTP status, so the loop reports it through on_failure */
+static int record(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)http;
+    codes[num_done] = res;
+    order[num_done++] = (int)(intptr_t)req->plugin_data;
+    return -1;   /* let on_retry decide */
+}
+/* asks for a retry in 5 s, far past the deadline */
+static int retry_later(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    record(easy, res, http, req);
+    return res == CURL_EVENT_E_DEADLINE ? -1 : 5;
+}
+
+static curl_event_request_t *make(int id, const char *url, uint64_t deadline) {
+    curl_event_request_t *req = curl_event_request_init(0);
+    curl_event_request_url(req, url);
+    curl_event_request_on_failure(req, record);
+    curl_event_request_on_write(req, noop_write);
+    curl_event_request_deadline(req, deadline);
+    req->plugin_data = (void *)(intptr_t)id;
+    return req;
+}
+
+MACRO_TEST(deadline_orders_lane_edf) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 1);
+    num_done = 0;
+
+    uint64_t now = macro_now();
+    curl_event_request_submitp(loop, make(0, "file:///dev/null", 0));
+    curl_event_request_submitp(loop, make(1, "file:///dev/null", now + 9000000000ull));
+    curl_event_request_submitp(loop, make(2, "file:///dev/null", now + 3000000000ull));
+    curl_event_request_submitp(loop, make(3, "file:///dev/null", now + 6000000000ull));
+    curl_event_loop_run(loop);
+
+    int expect[4] = { 2, 3, 1, 0 };   /* no deadline runs last */
+    MACRO_ASSERT_EQ_INT(num_done, 4);
+    for (int i = 0; i < 4; i++)
+        MACRO_ASSERT_EQ_INT(order[i], expect[i]);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(deadline_drops_stale_requests) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    num_done = 0;
+
+    curl_event_request_submitp(loop, make(0, "file:///dev/null", macro_now() - 1));
+    /* waits on the timer for a retry that falls after its deadline */
+    curl_event_request_t *late = make(1, "file:///nonexistent/a-curl-library",
+                                      macro_now() + 200000000ull);
+    curl_event_request_on_failure(late, retry_later);
+    curl_event_request_submitp(loop, late);
+
+    uint64_t start = macro_now();
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_TRUE(macro_time_diff(macro_now(), start) < 1.0);
+    MACRO_ASSERT_EQ_INT(num_done, 3);
+    MACRO_ASSERT_EQ_INT(order[0], 0);
+    MACRO_ASSERT_EQ_INT((int)codes[0], (int)CURL_EVENT_E_DEADLINE);
+    MACRO_ASSERT_TRUE(codes[1] != CURLE_OK && codes[1] != CURL_EVENT_E_DEADLINE);
+    MACRO_ASSERT_EQ_INT((int)codes[2], (int)CURL_EVENT_E_DEADLINE);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).expired_requests, 2);
+    MACRO_ASSERT_TRUE(strstr(curl_event_strerror(CURL_EVENT_E_DEADLINE), "deadline") != NULL);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(deadline_clamps_retry_backoff) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    num_done = 0;
+
+    /* every attempt fails; a 10 s minimum backoff must not outlive 300 ms */
+    curl_event_request_t *req = make(0, "file:///nonexistent/a-curl-library", 0);
+    curl_event_request_deadline_in(req, 300);
+    curl_event_request_enable_retries(req, 5, 2.0, 10000, 0, false);
+    curl_event_request_submitp(loop, req);
+
+    uint64_t start = macro_now();
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_TRUE(macro_time_diff(macro_now(), start) < 2.0);
+    MACRO_ASSERT_TRUE(num_done >= 2);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, deadline_orders_lane_edf);
+    MACRO_ADD(tests, deadline_drops_stale_requests);
+    MACRO_ADD(tests, deadline_clamps_retry_backoff);
+    macro_run_all("a-curl-library/event_deadline", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "a-curl-library/curl_event_group.h"
+#include "a-curl-library/curl_resource.h"
+#include "a-curl-library/rate_manager.h"
+/* inspects the ready lanes and the timer wheel */
+#include "a-curl-library/impl/curl_event_priv.h"
+
+static int num_destroyed = 0;
+static int num_done = 0;
+
+static void count_destroy(void *p) { (void)p; num_destroyed++; }
+static int count_done(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http; (void)req;
+    num_done++;
+    return 0;
+}
+static size_t noop_write(void *p, size_t s, size_t n, struct curl_event_request_s *req) {
+    (void)p; (void)req; return s*n;
+}
+
+static curl_event_request_t *make(curl_event_group_t *group) {
+    curl_event_request_t *req = curl_event_request_init(0);
+    curl_event_request_url(req, "file:///dev/null");
+    curl_event_request_on_failure(req, count_done);
+    curl_event_request_on_write(req, noop_write);
+    req->plugin_data = &num_destroyed;
+    req->plugin_data_cleanup = count_destroy;
+    if (group) MACRO_ASSERT_TRUE(curl_event_request_group(req, group));
+    return req;
+}
+
+MACRO_TEST(group_cancel_ready_and_blocked) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 0);   /* keep everything in the lanes */
+    num_destroyed = num_done = 0;
+
+    curl_event_group_t *group = curl_event_group_init(loop);
+    curl_event_res_id rid = curl_event_res_declare(loop);   /* never published */
+
+    for (int i = 0; i < 3; i++)
+        curl_event_request_submitp(loop, make(group));
+    for (int i = 0; i < 2; i++) {
+        curl_event_request_t *req = make(group);
+        curl_event_request_depend(req, rid);
+        curl_event_request_submitp(loop, req);
+    }
+    curl_event_request_t *other = make(NULL);
+    curl_event_request_submitp(loop, other);
+
+    curl_event_loop_step(loop);
+    MACRO_ASSERT_EQ_INT((int)curl_event_group_size(group), 5);
+    MACRO_ASSERT_EQ_INT((int)loop->num_ready_requests, 4);
+
+    MACRO_ASSERT_TRUE(curl_event_group_cancel(group));
+    MACRO_ASSERT_TRUE(!curl_event_group_cancel(group));
+    curl_event_loop_step(loop);
+
+    MACRO_ASSERT_EQ_INT((int)curl_event_group_size(group), 0);
+    MACRO_ASSERT_EQ_INT(num_destroyed, 5);
+    MACRO_ASSERT_EQ_INT((int)loop->num_ready_requests, 1);
+
+    /* the ungrouped request still runs */
+    curl_event_loop_set_max_concurrent(loop, 1);
+    curl_event_res_release(loop, rid);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_done, 1);
+
+    curl_event_group_release(group);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(group_cancel_is_sticky) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    num_destroyed = num_done = 0;
+
+    curl_event_group_t *group = curl_event_group_init(loop);
+    curl_event_group_cancel(group);
+    MACRO_ASSERT_TRUE(curl_event_group_cancelled(group));
+
+    curl_event_request_submitp(loop, make(group));
+    curl_event_request_submitp(loop, make(group));
+    curl_event_group_release(group);     /* members keep the group alive */
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_EQ_INT(num_done, 0);
+    MACRO_ASSERT_EQ_INT(num_destroyed, 2);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(group_cancel_rate_limited_and_individual) {
+    rate_manager_init();
+    rate_manager_set_limit("group-test", 4, 1.0);   /* one token, then ~1 s */
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    num_destroyed = num_done = 0;
+
+    curl_event_group_t *group = curl_event_group_init(loop);
+    curl_event_request_t *reqs[4];
+    for (int i = 0; i < 4; i++) {
+        reqs[i] = make(group);
+        curl_event_request_rate_limit(reqs[i], "group-test", false);
+        curl_event_request_submitp(loop, reqs[i]);
+    }
+    curl_event_loop_step(loop);
+    /* the first takes the token; the rest wait on the timer wheel */
+    MACRO_ASSERT_EQ_INT((int)timer_wheel_count(&loop->timers), 3);
+
+    /* an individual cancel queued ahead of the group cancel wins the race */
+    MACRO_ASSERT_TRUE(curl_event_loop_cancel(loop, reqs[2]));
+    MACRO_ASSERT_TRUE(curl_event_group_cancel(group));
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_EQ_INT((int)curl_event_group_size(group), 0);
+    MACRO_ASSERT_EQ_INT((int)timer_wheel_count(&loop->timers), 0);
+    MACRO_ASSERT_EQ_INT(num_destroyed, 4);
+    MACRO_ASSERT_TRUE(num_done <= 1);
+
+    curl_event_group_release(group);
+    curl_event_loop_destroy(loop);
+    rate_manager_destroy();
+}
+
+static int count_list(timer_node_t *head) {
+    int n = 0;
+    for (timer_node_t *t = head->next; t != head; t = t->next) n++;
+    return n;
+}
+
+MACRO_TEST(group_cancel_queued_on_rate_key) {
+    rate_manager_init();
+    rate_manager_set_limit("group-q", 1, 0);   /* one at a time, no rps limit */
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    num_destroyed = num_done = 0;
+
+    curl_event_group_t *group = curl_event_group_init(loop);
+    for (int i = 0; i < 4; i++) {
+        curl_event_request_t *req = make(i < 3 ? group : NULL);
+        curl_event_request_rate_limit(req, "group-q", false);
+        curl_event_request_submitp(loop, req);
+    }
+    curl_event_loop_step(loop);
+    /* the first takes the key's slot; the rest queue for it */
+    MACRO_ASSERT_EQ_INT(count_list(&loop->rate_waiting), 3);
+
+    /* the slot passes to the ungrouped request once the group is gone */
+    MACRO_ASSERT_TRUE(curl_event_group_cancel(group));
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_EQ_INT(count_list(&loop->rate_waiting), 0);
+    MACRO_ASSERT_EQ_INT(num_destroyed, 4);
+    MACRO_ASSERT_TRUE(num_done >= 1 && num_done <= 2);
+
+    curl_event_group_release(group);
+    curl_event_loop_destroy(loop);
+    rate_manager_destroy();
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, group_cancel_ready_and_blocked);
+    MACRO_ADD(tests, group_cancel_is_sticky);
+    MACRO_ADD(tests, group_cancel_rate_limited_and_individual);
+    MACRO_ADD(tests, group_cancel_queued_on_rate_key);
+    macro_run_all("a-curl-library/event_group", tests, test_count);
+    return 0;
+}
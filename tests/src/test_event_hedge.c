@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "the-macro-library/macro_time.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Loopback HTTP server: the first `slow_left` requests are answered after
+   2 s with body "slow", then `fail_left` answer 503 "err" after 300 ms;
+   later ones answer "fast" after fast_ms. */
+static int slow_left = 0;
+static int fail_left = 0;
+static int fast_ms = 0;
+
+static void respond(int fd, const char *request) {
+    (void)request;
+    char buf[256];
+    bool slow = __atomic_fetch_sub(&slow_left, 1, __ATOMIC_SEQ_CST) > 0;
+    bool fail = !slow && __atomic_fetch_sub(&fail_left, 1, __ATOMIC_SEQ_CST) > 0;
+    usleep((slow ? 2000 : fail ? 300 : fast_ms) * 1000);
+    const char *body = slow ? "slow" : fail ? "err" : "fast";
+    snprintf(buf, sizeof(buf),
+             "HTTP/1.1 %s\r\nContent-Length: %zu\r\n"
+             "Cache-Control: max-age=60\r\nConnection: close\r\n\r\n%s",
+             fail ? "503 Service Unavailable" : "200 OK", strlen(body), body);
+    loopback_send(fd, buf);
+}
+
+static char body[64];
+static size_t body_len = 0;
+static int num_done = 0;
+static int num_failed = 0;
+
+static size_t collect(void *p, size_t s, size_t n, struct curl_event_request_s *req) {
+    (void)req;
+    size_t len = s * n;
+    if (body_len + len < sizeof(body)) {
+        memcpy(body + body_len, p, len);
+        body_len += len;
+    }
+    return len;
+}
+static int done(CURL *easy, struct curl_event_request_s *req) {
+    (void)easy; (void)req;
+    num_done++;
+    return 0;
+}
+
+static int failed(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http; (void)req;
+    num_failed++;
+    return 0;
+}
+
+static void run_one(curl_event_loop_t *loop, uint64_t hedge_ms) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", loopback_port);
+    curl_event_request_t *req = curl_event_request_build_get(url, collect, done);
+    curl_event_request_on_failure(req, failed);
+    curl_event_request_hedge(req, hedge_ms, 0.0);
+    body_len = 0;
+    memset(body, 0, sizeof(body));
+    curl_event_request_submitp(loop, req);
+    curl_event_loop_run(loop);
+}
+
+MACRO_TEST(hedge_beats_slow_primary) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_hedge_ratio(loop, 1.0);
+    num_done = 0;
+    slow_left = 1;
+
+    uint64_t start = macro_now();
+    run_one(loop, 100);
+    MACRO_ASSERT_TRUE(macro_time_diff(macro_now(), start) < 1.5);
+
+    MACRO_ASSERT_EQ_INT(num_done, 1);
+    MACRO_ASSERT_TRUE(strcmp(body, "fast") == 0);   /* only the winner wrote */
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.hedges_fired, 1);
+    MACRO_ASSERT_EQ_INT((int)m.hedges_won, 1);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(hedge_not_fired_for_fast_primary_or_without_credit) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_hedge_ratio(loop, 1.0);
+    num_done = 0;
+    slow_left = 0;
+    run_one(loop, 1000);
+    MACRO_ASSERT_TRUE(strcmp(body, "fast") == 0);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).hedges_fired, 0);
+
+    /* ratio 0: a slow primary is left alone */
+    curl_event_loop_set_hedge_ratio(loop, 0.0);
+    slow_left = 1;
+    run_one(loop, 50);
+    MACRO_ASSERT_EQ_INT(num_done, 2);
+    MACRO_ASSERT_TRUE(strcmp(body, "slow") == 0);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).hedges_fired, 0);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(hedge_error_does_not_win) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_hedge_ratio(loop, 1.0);
+    num_done = num_failed = 0;
+    slow_left = 0;
+    fail_left = 1;
+    fast_ms = 400;
+
+    /* the primary's 503 body arrives first; the hedge's 200 still wins */
+    run_one(loop, 50);
+    MACRO_ASSERT_EQ_INT(num_done, 1);
+    MACRO_ASSERT_EQ_INT(num_failed, 0);
+    MACRO_ASSERT_TRUE(strcmp(body, "fast") == 0);
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.hedges_fired, 1);
+    MACRO_ASSERT_EQ_INT((int)m.hedges_won, 1);
+    fast_ms = 0;
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(hedge_winner_headers_are_used) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_hedge_ratio(loop, 1.0);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_cache(loop, 1 << 20));
+    num_done = num_failed = 0;
+    slow_left = 1;
+
+    /* the hedge's response is stored with its own Cache-Control */
+    run_one(loop, 100);
+    MACRO_ASSERT_TRUE(strcmp(body, "fast") == 0);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).hedges_won, 1);
+    run_one(loop, 100);
+    MACRO_ASSERT_EQ_INT(num_done, 2);
+    MACRO_ASSERT_TRUE(strcmp(body, "fast") == 0);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).cache_hits, 1);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    if (!loopback_start(respond)) {
+        fprintf(stderr, "loopback server unavailable; skipping\n");
+        return 0;
+    }
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, hedge_beats_slow_primary);
+    MACRO_ADD(tests, hedge_not_fired_for_fast_primary_or_without_credit);
+    MACRO_ADD(tests, hedge_error_does_not_win);
+    MACRO_ADD(tests, hedge_winner_headers_are_used);
+    macro_run_all("a-curl-library/event_hedge", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Loopback HTTP server answering "hello" after 200 ms, tracking the most
+   requests it served at once */
+static int serving = 0;
+static int peak = 0;
+
+static void respond(int fd, const char *request) {
+    (void)request;
+    int now = __atomic_add_fetch(&serving, 1, __ATOMIC_SEQ_CST);
+    int seen = __atomic_load_n(&peak, __ATOMIC_SEQ_CST);
+    while (now > seen &&
+           !__atomic_compare_exchange_n(&peak, &seen, now, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        ;
+    usleep(200 * 1000);
+    __atomic_sub_fetch(&serving, 1, __ATOMIC_SEQ_CST);
+    loopback_send(fd, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n"
+                      "Connection: close\r\n\r\nhello");
+}
+
+#define N 5
+static int order[N];
+static int num_done = 0;
+
+static int done(CURL *easy, struct curl_event_request_s *req) {
+    (void)easy;
+    order[num_done++] = (int)(intptr_t)req->plugin_data;
+    return 0;
+}
+
+/* Two authorities for the same server: 127.0.0.1:port and localhost:port */
+static curl_event_request_t *make(int id, const char *host) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://%s:%d/slow", host, loopback_port);
+    curl_event_request_t *req = curl_event_request_build_get(url, NULL, done);
+    req->plugin_data = (void *)(intptr_t)id;
+    return req;
+}
+
+MACRO_TEST(host_cap_parks_without_blocking_other_hosts) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_host_requests(loop, 1);
+
+    /* four for one host ahead of one for another, all in the same lane */
+    curl_event_request_t *reqs[N];
+    for (int i = 0; i < N - 1; i++)
+        reqs[i] = curl_event_request_submitp(loop, make(i, "127.0.0.1"));
+    reqs[N - 1] = curl_event_request_submitp(loop, make(N - 1, "localhost"));
+    curl_event_loop_step(loop);
+    MACRO_ASSERT_TRUE(curl_event_loop_cancel(loop, reqs[2]));   /* parked */
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_EQ_INT(num_done, N - 1);
+    /* the other host's request ran next to the first, not after all four */
+    MACRO_ASSERT_TRUE(order[0] == N - 1 || order[1] == N - 1);
+    MACRO_ASSERT_EQ_INT(peak, 2);
+    /* the first host's requests ran one at a time, in order */
+    int seq[N], n = 0;
+    for (int i = 0; i < num_done; i++)
+        if (order[i] != N - 1) seq[n++] = order[i];
+    MACRO_ASSERT_EQ_INT(n, 3);
+    MACRO_ASSERT_EQ_INT(seq[0], 0);
+    MACRO_ASSERT_EQ_INT(seq[1], 1);
+    MACRO_ASSERT_EQ_INT(seq[2], 3);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).host_parked, 3);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    if (!loopback_start(respond)) {
+        fprintf(stderr, "loopback server unavailable; skipping\n");
+        return 0;
+    }
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, host_cap_parks_without_blocking_other_hosts);
+    macro_run_all("a-curl-library/event_host_limit", tests, test_count);
+    return 0;
+}
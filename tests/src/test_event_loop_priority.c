@@ -7,7 +7,9 @@
 #include "a-curl-library/curl_event_request.h"
 #include "the-macro-library/macro_time.h"
 
-MACRO_TEST(submit_priority_affects_next_retry_at) {
+#include <unistd.h>
+
+MACRO_TEST(submit_priority_sets_lane) {
     curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
     MACRO_ASSERT_TRUE(loop != NULL);
 
@@ -18,11 +20,14 @@ MACRO_TEST(submit_priority_affects_next_retry_at) {
     curl_event_request_url(high, "file:///dev/null");
 
     // Submit with different priorities
+    uint64_t before = macro_now();
     curl_event_loop_submit(loop, low, 0);
     curl_event_loop_submit(loop, high, 5); // higher = sooner
 
-    // Higher priority should have an earlier (smaller) next_retry_at
-    MACRO_ASSERT_TRUE(high->next_retry_at < low->next_retry_at);
+    // Priority no longer shifts the retry clock; it picks a lane
+    MACRO_ASSERT_TRUE(high->next_retry_at >= before);
+    MACRO_ASSERT_EQ_INT(high->priority, 5);
+    MACRO_ASSERT_EQ_INT(low->priority, 0);
 
     // Metrics incremented
     curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
@@ -31,10 +36,134 @@ MACRO_TEST(submit_priority_affects_next_retry_at) {
     curl_event_loop_destroy(loop);
 }
 
+static int order[8];
+static int num_done = 0;
+
+static int record(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http;
+    order[num_done++] = req->priority;
+    return 0;
+}
+static size_t noop_write(void *p, size_t s, size_t n, struct curl_event_request_s *req) {
+    (void)p; (void)req; return s*n;
+}
+
+static void submit(curl_event_loop_t *loop, int priority) {
+    curl_event_request_t *req = curl_event_request_init(0);
+    curl_event_request_url(req, "file:///dev/null");
+    curl_event_request_on_failure(req, record);
+    curl_event_request_on_write(req, noop_write);
+    curl_event_request_submit(loop, req, priority);
+}
+
+MACRO_TEST(strict_lanes_start_highest_first) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 1);
+    num_done = 0;
+
+    submit(loop, 1);
+    submit(loop, 3);
+    submit(loop, 0);
+    submit(loop, 2);
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_EQ_INT(num_done, 4);
+    MACRO_ASSERT_EQ_INT(order[0], 3);
+    MACRO_ASSERT_EQ_INT(order[1], 2);
+    MACRO_ASSERT_EQ_INT(order[2], 1);
+    MACRO_ASSERT_EQ_INT(order[3], 0);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    for (int l = 0; l < CURL_EVENT_PRIORITY_LANES; l++) {
+        MACRO_ASSERT_EQ_INT((int)m.lanes[l].dispatched, 1);
+        MACRO_ASSERT_EQ_INT((int)m.lanes[l].depth, 0);
+    }
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(weighted_lanes_share_slots) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 1);
+    unsigned weights[CURL_EVENT_PRIORITY_LANES] = { 1, 1, 1, 2 };
+    curl_event_loop_set_dispatch(loop, CURL_EVENT_DISPATCH_WEIGHTED, weights);
+    num_done = 0;
+
+    for (int i = 0; i < 3; i++) submit(loop, 3);
+    for (int i = 0; i < 3; i++) submit(loop, 0);
+    curl_event_loop_run(loop);
+
+    /* two from the top lane, then one from the bottom lane, repeat */
+    int expect[6] = { 3, 3, 0, 3, 0, 0 };
+    MACRO_ASSERT_EQ_INT(num_done, 6);
+    for (int i = 0; i < 6; i++)
+        MACRO_ASSERT_EQ_INT(order[i], expect[i]);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(aging_promotes_waiting_requests) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 0);   /* nothing may start yet */
+    curl_event_loop_set_priority_aging(loop, 1);
+    num_done = 0;
+
+    submit(loop, 0);
+    curl_event_loop_step(loop);
+    usleep(3000);
+    curl_event_loop_step(loop);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.lanes[0].promoted, 1);
+    MACRO_ASSERT_EQ_INT((int)m.lanes[0].depth, 0);
+    MACRO_ASSERT_EQ_INT((int)m.lanes[1].depth, 1);
+
+    curl_event_loop_set_max_concurrent(loop, 1);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_done, 1);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(aging_looks_past_young_deadlines) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 0);
+    curl_event_loop_set_priority_aging(loop, 1);
+    num_done = 0;
+
+    submit(loop, 0);
+    curl_event_loop_step(loop);
+    usleep(3000);
+
+    /* a new deadline request sorts ahead of the old one in the lane */
+    curl_event_request_t *req = curl_event_request_init(0);
+    curl_event_request_url(req, "file:///dev/null");
+    curl_event_request_on_failure(req, record);
+    curl_event_request_on_write(req, noop_write);
+    curl_event_request_deadline_in(req, 60000);
+    curl_event_request_submit(loop, req, 0);
+    curl_event_loop_step(loop);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.lanes[0].promoted, 1);
+    MACRO_ASSERT_EQ_INT((int)m.lanes[0].depth, 1);
+    MACRO_ASSERT_EQ_INT((int)m.lanes[1].depth, 1);
+
+    curl_event_loop_set_max_concurrent(loop, 1);
+    curl_event_loop_run(loop);
+    MACRO_ASSERT_EQ_INT(num_done, 2);
+    curl_event_loop_destroy(loop);
+}
+
 int main(void) {
-    macro_test_case tests[4];
+    macro_test_case tests[8];
     size_t test_count = 0;
-    MACRO_ADD(tests, submit_priority_affects_next_retry_at);
+    MACRO_ADD(tests, submit_priority_sets_lane);
+    MACRO_ADD(tests, strict_lanes_start_highest_first);
+    MACRO_ADD(tests, weighted_lanes_share_slots);
+    MACRO_ADD(tests, aging_promotes_waiting_requests);
+    MACRO_ADD(tests, aging_looks_past_young_deadlines);
     macro_run_all("a-curl-library/event_loop_priority", tests, test_count);
     return 0;
 }
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <poll.h>
+
+MACRO_TEST(event_loop_step_driven_by_fd) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+
+    int fd = curl_event_loop_fd(loop);
+    MACRO_ASSERT_TRUE(fd >= 0);
+
+    /* nothing scheduled yet */
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_next_timeout_ms(loop), -1);
+
+    finished = 0;
+    for (int i = 0; i < 4; i++)
+        curl_event_request_submitp(loop, counted_request("file:///dev/null"));
+
+    /* a submit is ready work */
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_next_timeout_ms(loop), 0);
+
+    int iterations = 0;
+    while (curl_event_loop_step(loop) && iterations++ < 1000) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        poll(&pfd, 1, (int)curl_event_loop_next_timeout_ms(loop));
+    }
+    MACRO_ASSERT_EQ_INT(finished, 4);
+
+    /* idle again: stepping is a cheap no-op */
+    MACRO_ASSERT_TRUE(!curl_event_loop_step(loop));
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_next_timeout_ms(loop), -1);
+
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(event_loop_step_stop) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+
+    int fd = curl_event_loop_fd(loop);
+    MACRO_ASSERT_TRUE(fd >= 0);
+
+    finished = 0;
+    curl_event_request_submitp(loop, counted_request("file:///dev/null"));
+    curl_event_loop_stop(loop);
+
+    /* stop() wakes the fd and the next step reports the loop is done */
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    MACRO_ASSERT_EQ_INT(poll(&pfd, 1, 1000), 1);
+    MACRO_ASSERT_TRUE(!curl_event_loop_step(loop));
+
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, event_loop_step_driven_by_fd);
+    MACRO_ADD(tests, event_loop_step_stop);
+    macro_run_all("a-curl-library/event_loop_step", tests, test_count);
+    return 0;
+}
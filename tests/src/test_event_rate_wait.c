@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+#include "a-curl-library/rate_manager.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static curl_event_request_t *file_request(const char *key) {
+    curl_event_request_t *req = counted_request("file:///dev/null");
+    curl_event_request_rate_limit(req, key, false);
+    return req;
+}
+
+static void step_until(curl_event_loop_t *loop, int fd, int want) {
+    for (int i = 0; i < 1000 && finished < want; i++) {
+        curl_event_loop_step(loop);
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        poll(&pfd, 1, 10);
+    }
+}
+
+MACRO_TEST(event_rate_woken_chain_waiter_cancelled) {
+    rate_manager_init();
+    rate_manager_set_limit("account", /*max_concurrent*/1, /*max_rps*/0);
+    MACRO_ASSERT_TRUE(rate_manager_set_parent("model-a", "account"));
+    MACRO_ASSERT_TRUE(rate_manager_set_parent("model-b", "account"));
+
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    int fd = curl_event_loop_fd(loop);
+    MACRO_ASSERT_TRUE(fd >= 0);
+
+    /* the account's only slot is held outside the loop */
+    finished = 0;
+    MACRO_ASSERT_TRUE(rate_manager_start_request("model-a", false) == 0);
+    curl_event_request_t *first = file_request("model-b");
+    curl_event_request_submitp(loop, first);
+    curl_event_request_submitp(loop, file_request("model-a"));
+    curl_event_loop_step(loop);
+    rate_manager_stats_t st;
+    MACRO_ASSERT_TRUE(rate_manager_get_stats("account", &st));
+    MACRO_ASSERT_EQ_INT((int)st.limiting, 2);
+
+    /* the first waiter is woken to retry, but is cancelled before it can */
+    MACRO_ASSERT_TRUE(curl_event_loop_cancel(loop, first));
+    rate_manager_request_done("model-a");
+    step_until(loop, fd, 1);
+
+    /* the slot held for it went to the waiter behind */
+    MACRO_ASSERT_EQ_INT(finished, 1);
+    MACRO_ASSERT_TRUE(rate_manager_get_stats("account", &st));
+    MACRO_ASSERT_EQ_INT(st.in_flight, 0);
+
+    curl_event_loop_destroy(loop);
+    rate_manager_destroy();
+}
+
+static void *finish_outside(void *arg) {
+    (void)arg;
+    usleep(100 * 1000);
+    rate_manager_request_done("solo");
+    return NULL;
+}
+
+MACRO_TEST(event_rate_run_waits_for_queued) {
+    rate_manager_init();
+    rate_manager_set_limit("solo", /*max_concurrent*/1, /*max_rps*/0);
+
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+
+    /* queued on a slot another thread holds: run() waits for it */
+    finished = 0;
+    MACRO_ASSERT_TRUE(rate_manager_start_request("solo", false) == 0);
+    curl_event_request_submitp(loop, file_request("solo"));
+    pthread_t t;
+    pthread_create(&t, NULL, finish_outside, NULL);
+    curl_event_loop_run(loop);
+    pthread_join(t, NULL);
+    MACRO_ASSERT_EQ_INT(finished, 1);
+
+    curl_event_loop_destroy(loop);
+    rate_manager_destroy();
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, event_rate_woken_chain_waiter_cancelled);
+    MACRO_ADD(tests, event_rate_run_waits_for_queued);
+    macro_run_all("a-curl-library/event_rate_wait", tests, test_count);
+    return 0;
+}
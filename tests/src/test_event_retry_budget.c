@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Loopback HTTP server that always answers 503 */
+static int served = 0;
+
+static void respond(int fd, const char *request) {
+    (void)request;
+    __atomic_add_fetch(&served, 1, __ATOMIC_SEQ_CST);
+    loopback_send(fd, "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+                      "Connection: close\r\n\r\n");
+}
+
+#define N 5
+static int num_failed = 0;
+
+static int failed(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http; (void)req;
+    num_failed++;
+    return -1;      /* let on_retry decide */
+}
+
+MACRO_TEST(retry_budget_caps_retries) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    /* two banked retries; five first attempts earn half of another */
+    curl_event_retry_budget_t budget = { .ratio = 0.1, .burst = 2 };
+    MACRO_ASSERT_TRUE(curl_event_loop_set_retry_budget(loop, &budget));
+
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", loopback_port);
+    for (int i = 0; i < N; i++) {
+        curl_event_request_t *req = curl_event_request_build_get(url, NULL, NULL);
+        curl_event_request_on_failure(req, failed);
+        curl_event_request_max_retries(req, 3);
+        curl_event_request_submitp(loop, req);
+    }
+    curl_event_loop_run(loop);
+
+    /* without the budget: N * 4 attempts */
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.retried_requests, 2);
+    MACRO_ASSERT_EQ_INT((int)m.retries_denied, N);
+    MACRO_ASSERT_EQ_INT(num_failed, N + 2);
+    MACRO_ASSERT_EQ_INT(__atomic_load_n(&served, __ATOMIC_SEQ_CST), N + 2);
+    curl_event_loop_destroy(loop);
+}
+
+static int delay_failed(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http; (void)req;
+    num_failed++;
+    return 1;       /* try again in a second */
+}
+
+MACRO_TEST(retry_budget_caps_delayed_retries) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_retry_budget_t budget = { .ratio = 0.1, .burst = 2 };
+    MACRO_ASSERT_TRUE(curl_event_loop_set_retry_budget(loop, &budget));
+
+    num_failed = 0;
+    int before = __atomic_load_n(&served, __ATOMIC_SEQ_CST);
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", loopback_port);
+    for (int i = 0; i < N; i++) {
+        curl_event_request_t *req = curl_event_request_build_get(url, NULL, NULL);
+        curl_event_request_on_failure(req, delay_failed);
+        curl_event_request_submitp(loop, req);
+    }
+    curl_event_loop_run(loop);
+
+    /* without the budget these would retry forever */
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.retries_denied, N);
+    MACRO_ASSERT_EQ_INT((int)m.failed_requests, N);
+    MACRO_ASSERT_EQ_INT(num_failed, N + 2);
+    MACRO_ASSERT_EQ_INT(__atomic_load_n(&served, __ATOMIC_SEQ_CST) - before, N + 2);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    if (!loopback_start(respond)) {
+        fprintf(stderr, "loopback server unavailable; skipping\n");
+        return 0;
+    }
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, retry_budget_caps_retries);
+    MACRO_ADD(tests, retry_budget_caps_delayed_retries);
+    macro_run_all("a-curl-library/event_retry_budget", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_runtime.h"
+#include "a-curl-library/curl_event_request.h"
+#include "a-curl-library/curl_event_group.h"
+#include "loop_fixtures.h"
+
+MACRO_TEST(runtime_routes_by_host_and_key) {
+    curl_event_runtime_t *rt = curl_event_runtime_init(8, false);
+    MACRO_ASSERT_TRUE(rt != NULL);
+    MACRO_ASSERT_EQ_INT((int)curl_event_runtime_num_loops(rt), 8);
+
+    curl_event_request_t *a = counted_request("https://Example.com/a?x=1");
+    curl_event_request_t *b = counted_request("http://user@example.com:8080/b");
+    curl_event_request_t *c = counted_request("https://other.example.org/a");
+    MACRO_ASSERT_EQ_INT((int)curl_event_runtime_shard_for(rt, a),
+                        (int)curl_event_runtime_shard_for(rt, b));
+
+    /* the rate-limit key wins over the host */
+    curl_event_request_rate_limit(a, "shared-key", false);
+    curl_event_request_rate_limit(c, "shared-key", false);
+    MACRO_ASSERT_EQ_INT((int)curl_event_runtime_shard_for(rt, a),
+                        (int)curl_event_runtime_shard_for(rt, c));
+
+    /* a group pins its members to the loop it was made for */
+    curl_event_group_t *group = curl_event_group_init(curl_event_runtime_loop(rt, 5));
+    MACRO_ASSERT_TRUE(curl_event_request_group(b, group));
+    MACRO_ASSERT_EQ_INT((int)curl_event_runtime_shard_for(rt, b), 5);
+    MACRO_ASSERT_TRUE(!curl_event_loop_submit(curl_event_runtime_loop(rt, 4), b, 0));
+    curl_event_group_release(group);
+
+    curl_event_request_destroy_unsubmitted(a);
+    curl_event_request_destroy_unsubmitted(b);
+    curl_event_request_destroy_unsubmitted(c);
+    curl_event_runtime_destroy(rt);
+}
+
+MACRO_TEST(runtime_submit_and_drain) {
+    curl_event_runtime_t *rt = curl_event_runtime_init(4, false);
+    MACRO_ASSERT_TRUE(rt != NULL);
+    MACRO_ASSERT_TRUE(curl_event_runtime_start(rt));
+
+    atomic_store(&finished, 0);
+    for (int i = 0; i < 32; i++) {
+        curl_event_request_t *req = counted_request("file:///dev/null");
+        curl_event_request_rate_limit(req, i % 2 ? "odd" : "even", false);
+        MACRO_ASSERT_TRUE(curl_event_runtime_submit(rt, req, 0) != NULL);
+    }
+
+    curl_event_runtime_stop(rt, true);
+    MACRO_ASSERT_EQ_INT(atomic_load(&finished), 32);
+
+    curl_event_metrics_t m = curl_event_runtime_get_metrics(rt);
+    MACRO_ASSERT_EQ_INT((int)m.total_requests, 32);
+
+    curl_event_runtime_destroy(rt);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, runtime_routes_by_host_and_key);
+    MACRO_ADD(tests, runtime_submit_and_drain);
+    macro_run_all("a-curl-library/event_runtime", tests, test_count);
+    return 0;
+}
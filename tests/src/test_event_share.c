@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_share.h"
+
+MACRO_TEST(share_across_loops) {
+    curl_event_share_t *share = curl_event_share_init(CURL_EVENT_SHARE_DEFAULT);
+    MACRO_ASSERT_TRUE(share != NULL);
+    MACRO_ASSERT_EQ_INT((int)curl_event_share_flags(share), (int)CURL_EVENT_SHARE_DEFAULT);
+
+    curl_event_loop_t *a = curl_event_loop_init(NULL, NULL);
+    curl_event_loop_t *b = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_share(a, share));
+    MACRO_ASSERT_TRUE(curl_event_loop_set_share(b, share));
+
+    /* loops keep their own references */
+    curl_event_share_release(share);
+    curl_event_loop_destroy(a);
+    curl_event_loop_destroy(b);
+}
+
+MACRO_TEST(share_connect_single_loop) {
+    curl_event_share_t *share =
+        curl_event_share_init(CURL_EVENT_SHARE_DNS | CURL_EVENT_SHARE_CONNECT);
+    MACRO_ASSERT_TRUE(share != NULL);
+
+    curl_event_loop_t *a = curl_event_loop_init(NULL, NULL);
+    curl_event_loop_t *b = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(curl_event_loop_set_share(a, share));
+    MACRO_ASSERT_TRUE(!curl_event_loop_set_share(b, share));
+
+    /* once a lets go, b may take it */
+    MACRO_ASSERT_TRUE(curl_event_loop_set_share_profile(a, CURL_EVENT_SHARE_DNS));
+    MACRO_ASSERT_TRUE(curl_event_loop_set_share(b, share));
+
+    curl_event_share_release(share);
+    curl_event_loop_destroy(a);
+    curl_event_loop_destroy(b);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, share_across_loops);
+    MACRO_ADD(tests, share_connect_single_loop);
+    macro_run_all("a-curl-library/event_share", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Loopback HTTP server answering "hello", or 503 for paths under /fail */
+static int served = 0;
+
+static void respond(int fd, const char *request) {
+    __atomic_add_fetch(&served, 1, __ATOMIC_SEQ_CST);
+    loopback_send(fd, strncmp(request, "GET /fail", 9) != 0
+        ? "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nConnection: close\r\n\r\nhello"
+        : "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+          "Connection: close\r\n\r\n");
+}
+
+static void *read_metrics(void *arg) {
+    static curl_event_metrics_t m;
+    m = curl_event_loop_get_metrics((curl_event_loop_t *)arg);
+    return &m;
+}
+
+static int num_hosts = 0;
+
+static void count_host(const char *key, const curl_event_key_stats_t *stats, void *arg) {
+    (void)key; (void)arg;
+    if (stats->attempts == 4) num_hosts++;
+}
+
+MACRO_TEST(key_stats_count_phases_bytes_and_status) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+
+    char url[64];
+    for (int i = 0; i < 4; i++) {
+        snprintf(url, sizeof(url), "http://127.0.0.1:%d/%s", loopback_port, i == 3 ? "fail" : "ok");
+        curl_event_request_t *req = curl_event_request_build_get(url, NULL, NULL);
+        curl_event_request_rate_limit(req, "stats-key", false);
+        curl_event_request_submitp(loop, req);
+    }
+    curl_event_loop_run(loop);
+
+    curl_event_metrics_t m = curl_event_loop_get_metrics(loop);
+    MACRO_ASSERT_EQ_INT((int)m.completed_requests, 3);
+    MACRO_ASSERT_EQ_INT((int)m.failed_requests, 1);
+
+    /* another thread sees the copy published by the last iteration */
+    pthread_t t;
+    void *seen = NULL;
+    pthread_create(&t, NULL, read_metrics, loop);
+    pthread_join(t, &seen);
+    MACRO_ASSERT_EQ_INT((int)((curl_event_metrics_t *)seen)->completed_requests, 3);
+    MACRO_ASSERT_EQ_INT((int)((curl_event_metrics_t *)seen)->failed_requests, 1);
+
+    curl_event_key_stats_t s;
+    MACRO_ASSERT_TRUE(curl_event_loop_get_key_stats(loop, CURL_EVENT_STATS_RATE_KEY,
+                                                    "stats-key", &s));
+    MACRO_ASSERT_EQ_INT((int)s.attempts, 4);
+    MACRO_ASSERT_EQ_INT((int)s.status[2], 3);
+    MACRO_ASSERT_EQ_INT((int)s.status[5], 1);
+    MACRO_ASSERT_EQ_INT((int)s.bytes_received, 15);
+    MACRO_ASSERT_EQ_INT((int)s.phases[CURL_EVENT_PHASE_TOTAL].count, 4);
+    MACRO_ASSERT_EQ_INT((int)s.phases[CURL_EVENT_PHASE_QUEUE].count, 4);
+    MACRO_ASSERT_EQ_INT((int)s.phases[CURL_EVENT_PHASE_TTFB].count, 4);
+    MACRO_ASSERT_EQ_INT((int)s.phases[CURL_EVENT_PHASE_TLS].count, 0);
+    MACRO_ASSERT_TRUE(s.phases[CURL_EVENT_PHASE_TOTAL].p50_us <=
+                      s.phases[CURL_EVENT_PHASE_TOTAL].max_us);
+
+    char host[32];
+    snprintf(host, sizeof(host), "127.0.0.1:%d", loopback_port);
+    MACRO_ASSERT_TRUE(curl_event_loop_get_key_stats(loop, CURL_EVENT_STATS_HOST, host, &s));
+    MACRO_ASSERT_EQ_INT((int)s.attempts, 4);
+    MACRO_ASSERT_TRUE(!curl_event_loop_get_key_stats(loop, CURL_EVENT_STATS_RATE_KEY,
+                                                     "unknown", &s));
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_foreach_key_stats(loop, CURL_EVENT_STATS_HOST,
+                                                               count_host, NULL), 1);
+    MACRO_ASSERT_EQ_INT(num_hosts, 1);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    if (!loopback_start(respond)) {
+        fprintf(stderr, "loopback server unavailable; skipping\n");
+        return 0;
+    }
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, key_stats_count_phases_bytes_and_status);
+    macro_run_all("a-curl-library/event_stats", tests, test_count);
+    return 0;
+}
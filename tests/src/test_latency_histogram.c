@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/impl/latency_histogram.h"
+
+MACRO_TEST(latency_hist_buckets_cover_values) {
+    /* every value lands in a bucket whose range contains it */
+    uint64_t samples[] = { 0, 1, 15, 16, 17, 31, 32, 100, 1000, 123456,
+                           (uint64_t)1 << 39, ((uint64_t)1 << 40) - 1 };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        size_t idx = latency_hist_index(samples[i]);
+        MACRO_ASSERT_TRUE(idx < LATENCY_HIST_BUCKETS);
+        MACRO_ASSERT_TRUE(latency_hist_bucket_low(idx) <= samples[i]);
+        MACRO_ASSERT_TRUE(latency_hist_bucket_high(idx) >= samples[i]);
+    }
+    MACRO_ASSERT_EQ_INT((int)latency_hist_index(UINT64_MAX), LATENCY_HIST_BUCKETS - 1);
+    /* buckets are contiguous */
+    for (size_t i = 1; i + 1 < LATENCY_HIST_BUCKETS; i++)
+        MACRO_ASSERT_TRUE(latency_hist_bucket_low(i) == latency_hist_bucket_high(i - 1) + 1);
+}
+
+MACRO_TEST(latency_hist_percentiles_within_error) {
+    static latency_hist_t h;
+    latency_hist_reset(&h);
+    for (uint64_t v = 1; v <= 10000; v++)
+        latency_hist_record(&h, v);
+    MACRO_ASSERT_EQ_INT((int)h.count, 10000);
+    MACRO_ASSERT_EQ_INT((int)h.max, 10000);
+
+    double ps[] = { 0.5, 0.9, 0.99 };
+    for (int i = 0; i < 3; i++) {
+        double exact = ps[i] * 10000.0;
+        double got = (double)latency_hist_percentile(&h, ps[i]);
+        MACRO_ASSERT_TRUE(got >= exact && got <= exact * 1.0625 + 1);
+    }
+    MACRO_ASSERT_EQ_INT((int)latency_hist_percentile(&h, 1.0), 10000);
+
+    static latency_hist_t other;
+    latency_hist_reset(&other);
+    latency_hist_record(&other, 50000);
+    latency_hist_merge(&h, &other);
+    MACRO_ASSERT_EQ_INT((int)h.count, 10001);
+    MACRO_ASSERT_EQ_INT((int)latency_hist_percentile(&h, 1.0), 50000);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, latency_hist_buckets_cover_values);
+    MACRO_ADD(tests, latency_hist_percentiles_within_error);
+    macro_run_all("a-curl-library/latency_histogram", tests, test_count);
+    return 0;
+}
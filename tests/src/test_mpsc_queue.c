@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/impl/mpsc_queue.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct item_s {
+    mpsc_node_t node;       /* first: the queue hands back &node */
+    int producer;
+    int seq;
+} item_t;
+
+MACRO_TEST(mpsc_queue_fifo_and_signal) {
+    mpsc_queue_t q;
+    item_t a = { .producer = 0, .seq = 0 }, b = { .producer = 0, .seq = 1 };
+    mpsc_queue_init(&q);
+    MACRO_ASSERT_TRUE(mpsc_queue_empty(&q));
+    MACRO_ASSERT_TRUE(mpsc_queue_pop(&q) == NULL);
+
+    /* only the first push after a drain asks for a wakeup */
+    MACRO_ASSERT_TRUE(mpsc_queue_push(&q, &a.node));
+    MACRO_ASSERT_TRUE(!mpsc_queue_push(&q, &b.node));
+    MACRO_ASSERT_TRUE(!mpsc_queue_empty(&q));
+
+    mpsc_queue_begin_drain(&q);
+    MACRO_ASSERT_TRUE(mpsc_queue_pop(&q) == &a.node);
+    MACRO_ASSERT_TRUE(mpsc_queue_pop(&q) == &b.node);
+    MACRO_ASSERT_TRUE(mpsc_queue_pop(&q) == NULL);
+    MACRO_ASSERT_TRUE(mpsc_queue_empty(&q));
+
+    /* nodes can be pushed again once popped */
+    MACRO_ASSERT_TRUE(mpsc_queue_push(&q, &a.node));
+    mpsc_queue_begin_drain(&q);
+    MACRO_ASSERT_TRUE(mpsc_queue_pop(&q) == &a.node);
+    MACRO_ASSERT_TRUE(mpsc_queue_empty(&q));
+}
+
+#define PRODUCERS 8
+#define PER_PRODUCER 20000
+
+static mpsc_queue_t shared_q;
+static item_t items[PRODUCERS][PER_PRODUCER];
+
+static void *produce(void *arg) {
+    int p = (int)(intptr_t)arg;
+    for (int i = 0; i < PER_PRODUCER; i++) {
+        items[p][i].producer = p;
+        items[p][i].seq = i;
+        mpsc_queue_push(&shared_q, &items[p][i].node);
+    }
+    return NULL;
+}
+
+MACRO_TEST(mpsc_queue_many_producers) {
+    pthread_t threads[PRODUCERS];
+    int next_seq[PRODUCERS] = {0};
+    int popped = 0;
+    bool in_order = true;
+
+    mpsc_queue_init(&shared_q);
+    for (int p = 0; p < PRODUCERS; p++)
+        pthread_create(&threads[p], NULL, produce, (void *)(intptr_t)p);
+
+    while (popped < PRODUCERS * PER_PRODUCER) {
+        mpsc_node_t *n = mpsc_queue_pop(&shared_q);
+        if (!n) continue;
+        item_t *it = (item_t *)n;
+        if (it->seq != next_seq[it->producer]) in_order = false;
+        next_seq[it->producer] = it->seq + 1;
+        popped++;
+    }
+    for (int p = 0; p < PRODUCERS; p++)
+        pthread_join(threads[p], NULL);
+
+    MACRO_ASSERT_TRUE(in_order);
+    MACRO_ASSERT_TRUE(mpsc_queue_pop(&shared_q) == NULL);
+    MACRO_ASSERT_EQ_INT(popped, PRODUCERS * PER_PRODUCER);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, mpsc_queue_fifo_and_signal);
+    MACRO_ADD(tests, mpsc_queue_many_producers);
+    macro_run_all("a-curl-library/mpsc_queue", tests, test_count);
+    return 0;
+}
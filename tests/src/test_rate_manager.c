@@ -5,6 +5,11 @@
 #include "the-macro-library/macro_test.h"
 #include "a-curl-library/rate_manager.h"
 
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>   // usleep
 
 static void sleep_ns(uint64_t ns) {
@@ -17,7 +22,7 @@ static void sleep_ns(uint64_t ns) {
 MACRO_TEST(rate_manager_basic_bucket) {
     rate_manager_init();
 
-    // 1 rps to get a predictable wait, concurrency isn't enforced in this impl
+    // 1 rps to get a predictable wait
     rate_manager_set_limit("key1", /*max_concurrent*/1, /*max_rps*/1.0);
 
     // First start should proceed immediately.
@@ -45,10 +50,281 @@ MACRO_TEST(rate_manager_basic_bucket) {
     rate_manager_destroy();
 }
 
+MACRO_TEST(rate_manager_adaptive_limit) {
+    rate_manager_init();
+    rate_manager_set_adaptive("ad", /*min*/2, /*max*/50, /*max_rps*/0);
+    const uint64_t ms = 1000000ull;
+
+    // Starts at the minimum and grows while the limit is in use and the
+    // RTT stays at its baseline
+    for (int round = 0; round < 20; round++) {
+        int started = 0;
+        while (rate_manager_start_request("ad", false) == 0)
+            started++;
+        if (round == 0)
+            MACRO_ASSERT_EQ_INT(started, 2);
+        for (int i = 0; i < started; i++) {
+            rate_manager_request_sample("ad", 10 * ms, false);
+            rate_manager_request_done("ad");
+        }
+    }
+    rate_manager_adaptive_t st;
+    MACRO_ASSERT_TRUE(rate_manager_get_adaptive("ad", &st));
+    int grown = st.limit;
+    MACRO_ASSERT_TRUE(grown > 5);
+    MACRO_ASSERT_EQ_INT((int)(st.rtt_min_ns / ms), 10);
+    MACRO_ASSERT_EQ_INT(st.in_flight, 0);
+
+    // Overload halves it
+    rate_manager_request_sample("ad", 10 * ms, true);
+    MACRO_ASSERT_TRUE(rate_manager_get_adaptive("ad", &st));
+    MACRO_ASSERT_TRUE(st.limit <= grown / 2 + 1);
+    int halved = st.limit;
+
+    // Latency inflation cuts it again, once an RTT has passed
+    usleep(50 * 1000);
+    for (int i = 0; i < 10; i++)
+        rate_manager_request_sample("ad", 100 * ms, false);
+    MACRO_ASSERT_TRUE(rate_manager_get_adaptive("ad", &st));
+    MACRO_ASSERT_TRUE(st.limit < halved);
+    MACRO_ASSERT_TRUE(st.gradient < 0.5);
+
+    // A static limit is not adaptive
+    rate_manager_set_limit("ad", 1, 1.0);
+    MACRO_ASSERT_TRUE(!rate_manager_get_adaptive("ad", &st));
+    rate_manager_destroy();
+}
+
+static int wake_order[4];
+static bool wake_granted[4];
+static int num_wakes = 0;
+
+static void on_wake(rate_manager_waiter_t *w, bool granted) {
+    wake_granted[num_wakes] = granted;
+    wake_order[num_wakes++] = w->high_priority ? 1 : 0;
+}
+
+MACRO_TEST(rate_manager_waiters_get_freed_slots) {
+    rate_manager_init();
+    rate_manager_set_limit("q", /*max_concurrent*/1, /*max_rps*/0);
+    rate_manager_waiter_t normal = { .on_wake = on_wake };
+    rate_manager_waiter_t hp = { .on_wake = on_wake };
+    rate_manager_waiter_t gone = { .on_wake = on_wake };
+
+    MACRO_ASSERT_TRUE(rate_manager_acquire("q", false, NULL) == 0);
+    MACRO_ASSERT_TRUE(rate_manager_start_request("q", false) > 0);   // at the limit
+    MACRO_ASSERT_TRUE(rate_manager_acquire("q", false, &normal) == RATE_MANAGER_QUEUED);
+    MACRO_ASSERT_TRUE(rate_manager_acquire("q", false, &gone) == RATE_MANAGER_QUEUED);
+    MACRO_ASSERT_TRUE(rate_manager_acquire("q", true, &hp) == RATE_MANAGER_QUEUED);
+    MACRO_ASSERT_TRUE(rate_manager_cancel_wait("q", &gone));
+
+    // Each finished request hands its slot on, high priority first
+    rate_manager_request_done("q");
+    MACRO_ASSERT_EQ_INT(num_wakes, 1);
+    MACRO_ASSERT_EQ_INT(wake_order[0], 1);
+    MACRO_ASSERT_TRUE(wake_granted[0]);
+    MACRO_ASSERT_TRUE(!rate_manager_cancel_wait("q", &hp));
+    rate_manager_request_done("q");
+    MACRO_ASSERT_EQ_INT(num_wakes, 2);
+    MACRO_ASSERT_EQ_INT(wake_order[1], 0);
+    MACRO_ASSERT_TRUE(wake_granted[1]);
+
+    // A 429 frees the slot but pauses the key and sends waiters away
+    MACRO_ASSERT_TRUE(rate_manager_acquire("q", false, &gone) == RATE_MANAGER_QUEUED);
+    MACRO_ASSERT_EQ_INT(rate_manager_handle_429("q"), 1);
+    MACRO_ASSERT_EQ_INT(num_wakes, 3);
+    MACRO_ASSERT_TRUE(!wake_granted[2]);
+    MACRO_ASSERT_TRUE(rate_manager_acquire("q", false, NULL) > 500000000ull);
+
+    rate_manager_destroy();
+}
+
+static bool chain_woken = false;
+static void on_chain_wake(rate_manager_waiter_t *w, bool granted) {
+    (void)w;
+    chain_woken = !granted;     /* a nested waiter is told to retry */
+}
+
+MACRO_TEST(rate_manager_nested_keys) {
+    rate_manager_init();
+    rate_manager_set_limit("account", /*max_concurrent*/0, /*max_rps*/2.0);
+    rate_manager_set_limit("model", 1, 0);
+    MACRO_ASSERT_TRUE(rate_manager_set_parent("model", "account"));
+    MACRO_ASSERT_TRUE(rate_manager_set_parent("endpoint", "model"));   // no limit of its own
+    MACRO_ASSERT_TRUE(!rate_manager_set_parent("account", "endpoint"));
+
+    rate_manager_stats_t st;
+    MACRO_ASSERT_TRUE(rate_manager_acquire("endpoint", false, NULL) == 0);
+    MACRO_ASSERT_TRUE(rate_manager_get_stats("account", &st));
+    MACRO_ASSERT_EQ_INT(st.in_flight, 1);
+
+    // The model's one slot is taken: queue there, and retry when it frees
+    rate_manager_waiter_t w = { .on_wake = on_chain_wake };
+    MACRO_ASSERT_TRUE(rate_manager_acquire("endpoint", false, &w) == RATE_MANAGER_QUEUED);
+    MACRO_ASSERT_TRUE(w.limited_by == rate_manager_key("model"));
+    rate_manager_request_done("endpoint");
+    MACRO_ASSERT_TRUE(chain_woken);
+    MACRO_ASSERT_TRUE(rate_manager_get_stats("account", &st));
+    MACRO_ASSERT_EQ_INT(st.in_flight, 0);
+    MACRO_ASSERT_TRUE(rate_manager_get_stats("model", &st));
+    MACRO_ASSERT_EQ_INT(st.in_flight, 1);      // held for w until it acquires
+    MACRO_ASSERT_TRUE(rate_manager_acquire("endpoint", false, &w) == 0);
+    MACRO_ASSERT_TRUE(w.reserved_on == NULL);
+    rate_manager_request_done("endpoint");
+
+    // The account is out of tokens: nothing is charged at any level
+    MACRO_ASSERT_TRUE(rate_manager_acquire("endpoint", false, &w) > 0);
+    MACRO_ASSERT_TRUE(w.limited_by == rate_manager_key("account"));
+    MACRO_ASSERT_TRUE(rate_manager_get_stats("model", &st));
+    MACRO_ASSERT_EQ_INT(st.in_flight, 0);
+    MACRO_ASSERT_EQ_INT((int)st.limiting, 1);
+    MACRO_ASSERT_TRUE(rate_manager_get_stats("account", &st));
+    MACRO_ASSERT_EQ_INT((int)st.limiting, 1);
+
+    // A woken waiter that gives up hands its slot to the one behind it
+    rate_manager_set_limit("pool", 1, 0);
+    MACRO_ASSERT_TRUE(rate_manager_set_parent("job", "pool"));
+    rate_manager_waiter_t behind = { .on_wake = on_chain_wake };
+    MACRO_ASSERT_TRUE(rate_manager_acquire("job", false, NULL) == 0);
+    MACRO_ASSERT_TRUE(rate_manager_acquire("job", false, &w) == RATE_MANAGER_QUEUED);
+    MACRO_ASSERT_TRUE(rate_manager_acquire("job", false, &behind) == RATE_MANAGER_QUEUED);
+    rate_manager_request_done("job");
+    MACRO_ASSERT_TRUE(w.reserved_on == rate_manager_key("pool"));
+    rate_manager_release_reservation(&w);
+    MACRO_ASSERT_TRUE(behind.reserved_on == rate_manager_key("pool"));
+    MACRO_ASSERT_TRUE(rate_manager_acquire("job", false, &behind) == 0);
+    rate_manager_request_done("job");
+
+    rate_manager_destroy();
+}
+
+MACRO_TEST(rate_manager_response_hints) {
+    rate_manager_hints_t h;
+    rate_manager_hints_init(&h);
+    MACRO_ASSERT_TRUE(!rate_manager_parse_header(&h, "Content-Type: text/plain"));
+    MACRO_ASSERT_TRUE(rate_manager_parse_header(&h, "retry-after: 3"));
+    MACRO_ASSERT_TRUE(h.retry_after_ns == 3000000000ll);
+
+    // HTTP-date and Unix-time forms are turned into delays
+    char line[128];
+    time_t at = time(NULL) + 20;
+    strftime(line, sizeof(line), "Retry-After: %a, %d %b %Y %H:%M:%S GMT", gmtime(&at));
+    MACRO_ASSERT_TRUE(rate_manager_parse_header(&h, line));
+    MACRO_ASSERT_TRUE(h.retry_after_ns > 18000000000ll && h.retry_after_ns <= 20000000000ll);
+    snprintf(line, sizeof(line), "X-RateLimit-Reset: %lld", (long long)at);
+    MACRO_ASSERT_TRUE(rate_manager_parse_header(&h, line));
+    MACRO_ASSERT_TRUE(h.reset_ns > 18000000000ll && h.reset_ns <= 20000000000ll);
+
+    MACRO_ASSERT_TRUE(rate_manager_parse_header(&h, "RateLimit-Policy: \"default\";q=100;w=60"));
+    MACRO_ASSERT_EQ_INT((int)h.quota, 100);
+    MACRO_ASSERT_TRUE(h.window_ns == 60000000000ll);
+    MACRO_ASSERT_TRUE(rate_manager_parse_header(&h, "RateLimit: \"default\";r=5;t=30"));
+    MACRO_ASSERT_EQ_INT((int)h.remaining, 5);
+    MACRO_ASSERT_TRUE(h.reset_ns == 30000000000ll);
+
+    rate_manager_init();
+    rate_manager_set_limit("ra", /*max_concurrent*/0, /*max_rps*/0);
+    rate_manager_set_limit("quota", 0, 0);
+    rate_key_t *ra = rate_manager_key("ra");
+    rate_key_t *quota = rate_manager_key("quota");
+
+    // A 429 with Retry-After pauses the key for exactly that long
+    rate_manager_hints_init(&h);
+    rate_manager_parse_header(&h, "Retry-After: 3");
+    MACRO_ASSERT_TRUE(rate_key_acquire(ra, false, NULL) == 0);
+    MACRO_ASSERT_EQ_INT(rate_key_handle_429(ra, &h), 3);
+    uint64_t wait = rate_key_can_proceed(ra, false);
+    MACRO_ASSERT_TRUE(wait > 2500000000ull && wait <= 3000000000ull);
+
+    // One request left for ten seconds: the next has to wait for the reset
+    rate_manager_hints_init(&h);
+    rate_manager_parse_header(&h, "X-RateLimit-Remaining: 1");
+    rate_manager_parse_header(&h, "X-RateLimit-Reset: 10");
+    rate_key_apply_hints(quota, &h);
+    MACRO_ASSERT_TRUE(rate_key_acquire(quota, false, NULL) == 0);
+    MACRO_ASSERT_TRUE(rate_key_acquire(quota, false, NULL) > 5000000000ull);
+    rate_key_request_done(quota);
+
+    // No quota left pauses the key until the reset
+    rate_manager_hints_init(&h);
+    rate_manager_parse_header(&h, "RateLimit: \"default\";r=0;t=20");
+    rate_key_apply_hints(quota, &h);
+    MACRO_ASSERT_TRUE(rate_key_can_proceed(quota, false) > 15000000000ull);
+
+    rate_manager_destroy();
+}
+
+MACRO_TEST(rate_manager_shared_across_processes) {
+    char name[64];
+    snprintf(name, sizeof(name), "/a-curl-library-test-%d", (int)getpid());
+
+    // The child takes two of three slots and the only token, then dies
+    // without giving the slots back
+    pid_t pid = fork();
+    MACRO_ASSERT_TRUE(pid >= 0);
+    if (pid == 0) {
+        if (!rate_manager_use_shared(name, 16)) _exit(1);
+        rate_manager_set_limit("conc", /*max_concurrent*/3, /*max_rps*/0);
+        rate_manager_set_limit("rps", 0, 1.0);
+        bool ok = rate_manager_start_request("conc", false) == 0 &&
+                  rate_manager_start_request("conc", false) == 0 &&
+                  rate_manager_start_request("rps", false) == 0;
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    MACRO_ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    rate_manager_init();
+    MACRO_ASSERT_TRUE(rate_manager_use_shared(name, 16));
+    rate_manager_set_limit("conc", 3, 0);     // same limits: state is kept
+    rate_manager_set_limit("rps", 0, 1.0);
+
+    // The child's token is gone
+    MACRO_ASSERT_TRUE(rate_manager_can_proceed("rps", false) > 0);
+
+    // One slot is free; taking another reclaims the dead child's two
+    MACRO_ASSERT_TRUE(rate_manager_start_request("conc", false) == 0);
+    MACRO_ASSERT_TRUE(rate_manager_start_request("conc", false) == 0);
+    MACRO_ASSERT_TRUE(rate_manager_start_request("conc", false) == 0);
+    MACRO_ASSERT_TRUE(rate_manager_start_request("conc", false) > 0);
+
+    rate_manager_destroy();
+    MACRO_ASSERT_TRUE(rate_manager_unlink_shared(name));
+}
+
+MACRO_TEST(rate_manager_shared_creator_died) {
+    char name[64];
+    snprintf(name, sizeof(name), "/a-curl-library-stale-%d", (int)getpid());
+
+    // A creator that died before initializing the segment
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    MACRO_ASSERT_TRUE(fd >= 0);
+    MACRO_ASSERT_TRUE(ftruncate(fd, 4096) == 0);
+    close(fd);
+
+    rate_manager_init();
+    MACRO_ASSERT_TRUE(!rate_manager_use_shared(name, 16));
+    rate_manager_destroy();
+
+    // Unlinking it lets the next process start over
+    MACRO_ASSERT_TRUE(rate_manager_unlink_shared(name));
+    rate_manager_init();
+    MACRO_ASSERT_TRUE(rate_manager_use_shared(name, 16));
+    rate_manager_destroy();
+    MACRO_ASSERT_TRUE(rate_manager_unlink_shared(name));
+}
+
 int main(void) {
     macro_test_case tests[8];
     size_t test_count = 0;
     MACRO_ADD(tests, rate_manager_basic_bucket);
+    MACRO_ADD(tests, rate_manager_adaptive_limit);
+    MACRO_ADD(tests, rate_manager_waiters_get_freed_slots);
+    MACRO_ADD(tests, rate_manager_nested_keys);
+    MACRO_ADD(tests, rate_manager_response_hints);
+    MACRO_ADD(tests, rate_manager_shared_across_processes);
+    MACRO_ADD(tests, rate_manager_shared_creator_died);
     macro_run_all("a-curl-library/rate_manager", tests, test_count);
     return 0;
 }
@@ -17,7 +17,7 @@ MACRO_TEST(rate_manager_high_priority_preempts_normal) {
     rate_manager_init();
     rate_manager_set_limit("hp", /*max_concurrent*/1, /*max_rps*/0.5); // tokens start at 0.5
 
-    // HP request waiting: increments internal hp counter, returns wait
+    // HP request waiting: reserves the next token, returns wait
     uint64_t whp = rate_manager_can_proceed("hp", true);
     MACRO_ASSERT_TRUE(whp > 0);
 
@@ -35,9 +35,11 @@ MACRO_TEST(rate_manager_high_priority_preempts_normal) {
 
     rate_manager_request_done("hp");
 
-    // After serving HP, normal can proceed (no pending HP)
+    // After serving HP, normal only waits for the bucket to refill (0.5 rps)
     uint64_t wn2 = rate_manager_can_proceed("hp", false);
-    MACRO_ASSERT_EQ_INT((int)(wn2 == 0), 1);
+    MACRO_ASSERT_TRUE(wn2 <= 2000000000ull);
+    sleep_ns(wn2 + 1000000ull);
+    MACRO_ASSERT_EQ_INT((int)(rate_manager_can_proceed("hp", false) == 0), 1);
 
     rate_manager_destroy();
 }
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "loop_fixtures.h"
+
+static int order[16];
+static int num_done = 0;
+
+/* file:// has no HTTP status, so the loop reports it through on_failure */
+static int record(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http;
+    order[num_done++] = (int)(intptr_t)req->plugin_data;
+    return 0;
+}
+
+static curl_event_request_t *make(int id, const char *url) {
+    curl_event_request_t *req = curl_event_request_init(0);
+    if (url) curl_event_request_url(req, url);
+    curl_event_request_on_failure(req, record);
+    curl_event_request_on_write(req, noop_write);
+    req->plugin_data = (void *)(intptr_t)id;
+    return req;
+}
+
+MACRO_TEST(submit_batch_keeps_fifo_order) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 1);
+    num_done = 0;
+
+    curl_event_request_t *reqs[6];
+    for (int i = 0; i < 6; i++)
+        reqs[i] = make(i, i == 3 ? NULL : "file:///dev/null");   /* #3 has no URL */
+
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_submit_batch(loop, reqs, 6), 5);
+    /* already submitted: rejected */
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_submit_batch(loop, reqs, 1), 0);
+    MACRO_ASSERT_EQ_INT((int)curl_event_loop_get_metrics(loop).total_requests, 5);
+
+    curl_event_loop_run(loop);
+
+    int expect[5] = { 0, 1, 2, 4, 5 };
+    MACRO_ASSERT_EQ_INT(num_done, 5);
+    for (int i = 0; i < 5; i++)
+        MACRO_ASSERT_EQ_INT(order[i], expect[i]);
+
+    curl_event_request_destroy_unsubmitted(reqs[3]);
+    curl_event_loop_destroy(loop);
+}
+
+MACRO_TEST(submit_batch_interleaves_with_single_submits) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+    curl_event_loop_set_max_concurrent(loop, 1);
+    num_done = 0;
+
+    curl_event_request_submitp(loop, make(0, "file:///dev/null"));
+    curl_event_request_t *reqs[2] = { make(1, "file:///dev/null"), make(2, "file:///dev/null") };
+    curl_event_loop_submit_batch(loop, reqs, 2);
+    curl_event_request_submitp(loop, make(3, "file:///dev/null"));
+    curl_event_loop_run(loop);
+
+    MACRO_ASSERT_EQ_INT(num_done, 4);
+    for (int i = 0; i < 4; i++)
+        MACRO_ASSERT_EQ_INT(order[i], i);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, submit_batch_keeps_fifo_order);
+    MACRO_ADD(tests, submit_batch_interleaves_with_single_submits);
+    macro_run_all("a-curl-library/submit_batch", tests, test_count);
+    return 0;
+}
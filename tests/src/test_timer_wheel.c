@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2025 Andy Curtis <contactandyc@gmail.com>
+// SPDX-FileCopyrightText: 2024–2025 Knode.ai — technical questions: contact Andy (above)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "the-macro-library/macro_test.h"
+#include "the-macro-library/macro_time.h"
+#include "a-curl-library/curl_event_loop.h"
+#include "a-curl-library/curl_event_request.h"
+#include "a-curl-library/impl/timer_wheel.h"
+
+static size_t collect(timer_wheel_t *w, uint64_t now_ms, timer_node_t *out, size_t max) {
+    timer_node_t expired;
+    timer_list_init(&expired);
+    size_t n = timer_wheel_advance(w, now_ms, &expired);
+    size_t i = 0;
+    while (!timer_list_empty(&expired)) {
+        timer_node_t *t = expired.next;
+        timer_list_unlink(t);
+        if (i < max) out[i] = *t;
+        i++;
+    }
+    return n;
+}
+
+MACRO_TEST(timer_wheel_fires_in_order) {
+    timer_wheel_t w;
+    timer_node_t a, b, c, fired[4];
+    timer_wheel_init(&w, 1000);
+
+    timer_wheel_insert(&w, &a, 1300);   /* crosses a level-0 boundary */
+    timer_wheel_insert(&w, &b, 1005);
+    timer_wheel_insert(&w, &c, 1000 + 70000);   /* level 2 */
+    MACRO_ASSERT_EQ_INT((int)timer_wheel_count(&w), 3);
+    MACRO_ASSERT_TRUE(timer_wheel_next_expiry(&w) == 1005);
+
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 1004, fired, 4), 0);
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 1005, fired, 4), 1);
+    MACRO_ASSERT_TRUE(fired[0].expires == 1005);
+
+    /* next_expiry is a lower bound that never overshoots */
+    MACRO_ASSERT_TRUE(timer_wheel_next_expiry(&w) <= 1300);
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 1299, fired, 4), 0);
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 1300, fired, 4), 1);
+    MACRO_ASSERT_TRUE(fired[0].expires == 1300);
+
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 1000 + 69999, fired, 4), 0);
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 1000 + 70000, fired, 4), 1);
+    MACRO_ASSERT_EQ_INT((int)timer_wheel_count(&w), 0);
+    MACRO_ASSERT_TRUE(timer_wheel_next_expiry(&w) == UINT64_MAX);
+}
+
+MACRO_TEST(timer_wheel_remove_and_overflow) {
+    timer_wheel_t w;
+    timer_node_t a, b, c, fired[4];
+    timer_wheel_init(&w, 0);
+
+    timer_wheel_insert(&w, &a, 10);
+    timer_wheel_insert(&w, &b, 10);
+    timer_wheel_insert(&w, &c, (1ull << 32) + 5);   /* beyond the top level */
+    timer_wheel_remove(&w, &a);
+    MACRO_ASSERT_TRUE(!timer_node_linked(&a));
+    timer_wheel_remove(&w, &a);                     /* no-op once unlinked */
+    MACRO_ASSERT_EQ_INT((int)timer_wheel_count(&w), 2);
+
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 10, fired, 4), 1);
+    MACRO_ASSERT_EQ_INT((int)collect(&w, 1ull << 32, fired, 4), 0);
+    MACRO_ASSERT_EQ_INT((int)collect(&w, (1ull << 32) + 5, fired, 4), 1);
+    MACRO_ASSERT_TRUE(fired[0].expires == (1ull << 32) + 5);
+
+    /* timers in the past fire on the next advance */
+    timer_wheel_insert(&w, &a, 3);
+    MACRO_ASSERT_EQ_INT((int)collect(&w, w.now, fired, 4), 1);
+
+    timer_wheel_insert(&w, &a, w.now + 100);
+    timer_wheel_insert(&w, &b, w.now + 100000);
+    timer_node_t out;
+    timer_list_init(&out);
+    MACRO_ASSERT_EQ_INT((int)timer_wheel_drain(&w, &out), 2);
+    MACRO_ASSERT_EQ_INT((int)timer_wheel_count(&w), 0);
+}
+
+/* A request that asks to be retried in one second waits on the loop's wheel */
+static int attempts = 0;
+
+static int retry_once(CURL *easy, CURLcode res, long http, struct curl_event_request_s *req) {
+    (void)easy; (void)res; (void)http; (void)req;
+    return ++attempts == 1 ? 1 : 0;
+}
+static size_t noop_write(void *p, size_t s, size_t n, struct curl_event_request_s *req) {
+    (void)p; (void)req; return s*n;
+}
+
+MACRO_TEST(timer_wheel_loop_retry_delay) {
+    curl_event_loop_t *loop = curl_event_loop_init(NULL, NULL);
+    MACRO_ASSERT_TRUE(loop != NULL);
+
+    curl_event_request_t *req = curl_event_request_init(0);
+    curl_event_request_url(req, "file:///dev/null");
+    curl_event_request_on_failure(req, retry_once);
+    curl_event_request_on_write(req, noop_write);
+    curl_event_request_submitp(loop, req);
+
+    uint64_t start = macro_now();
+    curl_event_loop_run(loop);
+    double elapsed = macro_time_diff(macro_now(), start);
+
+    MACRO_ASSERT_EQ_INT(attempts, 2);
+    MACRO_ASSERT_TRUE(elapsed >= 1.0 && elapsed < 2.0);
+    curl_event_loop_destroy(loop);
+}
+
+int main(void) {
+    macro_test_case tests[4];
+    size_t test_count = 0;
+    MACRO_ADD(tests, timer_wheel_fires_in_order);
+    MACRO_ADD(tests, timer_wheel_remove_and_overflow);
+    MACRO_ADD(tests, timer_wheel_loop_retry_delay);
+    macro_run_all("a-curl-library/timer_wheel", tests, test_count);
+    return 0;
+}